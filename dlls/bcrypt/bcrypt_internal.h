@@ -274,4 +274,7 @@ enum key_funcs
     unix_funcs_count,
 };
 
+struct ltc_hash_descriptor;
+const struct ltc_hash_descriptor *get_accelerated_hash_descriptor( enum alg_id alg_id );
+
 #endif /* __BCRYPT_INTERNAL_H */
@@ -430,6 +430,10 @@ NTSTATUS WINAPI BCryptGetFipsAlgorithmMode(BOOLEAN *enabled)
 
 static const struct ltc_hash_descriptor *get_hash_descriptor( enum alg_id alg_id )
 {
+    const struct ltc_hash_descriptor *desc;
+
+    if ((desc = get_accelerated_hash_descriptor( alg_id ))) return desc;
+
     switch (alg_id)
     {
     case ALG_ID_MD2: return &md2_desc;
@@ -0,0 +1,237 @@
+/*
+ * SHA-1 and SHA-256 using the x86 SHA extensions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winbase.h"
+#include "tomcrypt.h"
+
+#include "wine/debug.h"
+#include "bcrypt_internal.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(bcrypt);
+
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(__GNUC__) || defined(__clang__))
+
+#include <intrin.h>
+#include <immintrin.h>
+
+#define SHA_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+typedef void (*compress_func)( ulong32 *state, const unsigned char *data, unsigned long blocks );
+
+/* same semantics as the HASH_PROCESS() helper used by libtomcrypt, but hands all complete
+ * blocks to the compression function at once */
+static int process_blocks( ulong64 *length, ulong32 *curlen, unsigned char *buf, ulong32 *state,
+                           const unsigned char *in, unsigned long inlen, compress_func compress )
+{
+    unsigned long n;
+
+    if (*curlen > 64) return CRYPT_INVALID_ARG;
+    if (*length + inlen < *length) return CRYPT_HASH_OVERFLOW;
+
+    while (inlen)
+    {
+        if (!*curlen && inlen >= 64)
+        {
+            n = inlen / 64;
+            compress( state, in, n );
+            *length += (ulong64)n * 512;
+            in += n * 64;
+            inlen -= n * 64;
+        }
+        else
+        {
+            n = min( inlen, 64 - *curlen );
+            memcpy( buf + *curlen, in, n );
+            *curlen += n;
+            in += n;
+            inlen -= n;
+            if (*curlen == 64)
+            {
+                compress( state, buf, 1 );
+                *length += 512;
+                *curlen = 0;
+            }
+        }
+    }
+    return CRYPT_OK;
+}
+
+static const ulong32 sha256_k[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void SHA_TARGET sha256_compress_shani( ulong32 *state, const unsigned char *data, unsigned long blocks )
+{
+    const __m128i bswap = _mm_set_epi64x( 0x0c0d0e0f08090a0bull, 0x0405060700010203ull );
+    __m128i state0, state1, save0, save1, msg[4], tmp;
+    unsigned int i;
+
+    /* the sha256rnds2 instruction wants the state as ABEF and CDGH */
+    tmp    = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *)&state[0] ), 0xb1 );
+    state1 = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *)&state[4] ), 0x1b );
+    state0 = _mm_alignr_epi8( tmp, state1, 8 );
+    state1 = _mm_blend_epi16( state1, tmp, 0xf0 );
+
+    while (blocks--)
+    {
+        save0 = state0;
+        save1 = state1;
+
+        for (i = 0; i < 16; i++)
+        {
+            if (i < 4)
+                msg[i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *)(data + 16 * i) ), bswap );
+            else
+                msg[i & 3] = _mm_sha256msg2_epu32( _mm_add_epi32( _mm_sha256msg1_epu32( msg[i & 3], msg[(i + 1) & 3] ),
+                                                                  _mm_alignr_epi8( msg[(i + 3) & 3], msg[(i + 2) & 3], 4 ) ),
+                                                   msg[(i + 3) & 3] );
+
+            tmp = _mm_add_epi32( msg[i & 3], _mm_loadu_si128( (const __m128i *)&sha256_k[4 * i] ) );
+            state1 = _mm_sha256rnds2_epu32( state1, state0, tmp );
+            state0 = _mm_sha256rnds2_epu32( state0, state1, _mm_shuffle_epi32( tmp, 0x0e ) );
+        }
+
+        state0 = _mm_add_epi32( state0, save0 );
+        state1 = _mm_add_epi32( state1, save1 );
+        data += 64;
+    }
+
+    tmp    = _mm_shuffle_epi32( state0, 0x1b );
+    state1 = _mm_shuffle_epi32( state1, 0xb1 );
+    _mm_storeu_si128( (__m128i *)&state[0], _mm_blend_epi16( tmp, state1, 0xf0 ) );
+    _mm_storeu_si128( (__m128i *)&state[4], _mm_alignr_epi8( state1, tmp, 8 ) );
+}
+
+static void SHA_TARGET sha1_compress_shani( ulong32 *state, const unsigned char *data, unsigned long blocks )
+{
+    const __m128i bswap = _mm_set_epi64x( 0x0001020304050607ull, 0x08090a0b0c0d0e0full );
+    __m128i abcd, e0, e1, save_abcd, save_e, msg[4];
+    unsigned int i;
+
+    abcd = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *)state ), 0x1b );
+    e0   = _mm_set_epi32( state[4], 0, 0, 0 );
+
+    while (blocks--)
+    {
+        save_abcd = abcd;
+        save_e    = e0;
+
+        for (i = 0; i < 20; i++)
+        {
+            if (i < 4)
+                msg[i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *)(data + 16 * i) ), bswap );
+            else
+                msg[i & 3] = _mm_sha1msg2_epu32( _mm_xor_si128( _mm_sha1msg1_epu32( msg[i & 3], msg[(i + 1) & 3] ),
+                                                                msg[(i + 2) & 3] ),
+                                                 msg[(i + 3) & 3] );
+
+            /* e0 holds E for the first group, and the previous ABCD afterwards */
+            e1 = i ? _mm_sha1nexte_epu32( e0, msg[i & 3] ) : _mm_add_epi32( e0, msg[0] );
+            e0 = abcd;
+            if (i < 5) abcd = _mm_sha1rnds4_epu32( abcd, e1, 0 );
+            else if (i < 10) abcd = _mm_sha1rnds4_epu32( abcd, e1, 1 );
+            else if (i < 15) abcd = _mm_sha1rnds4_epu32( abcd, e1, 2 );
+            else abcd = _mm_sha1rnds4_epu32( abcd, e1, 3 );
+        }
+
+        e0   = _mm_sha1nexte_epu32( e0, save_e );
+        abcd = _mm_add_epi32( abcd, save_abcd );
+        data += 64;
+    }
+
+    _mm_storeu_si128( (__m128i *)state, _mm_shuffle_epi32( abcd, 0x1b ) );
+    state[4] = _mm_extract_epi32( e0, 3 );
+}
+
+static int sha256_process_shani( hash_state *md, const unsigned char *in, unsigned long inlen )
+{
+    return process_blocks( &md->sha256.length, &md->sha256.curlen, md->sha256.buf, md->sha256.state,
+                           in, inlen, sha256_compress_shani );
+}
+
+static int sha1_process_shani( hash_state *md, const unsigned char *in, unsigned long inlen )
+{
+    return process_blocks( &md->sha1.length, &md->sha1.curlen, md->sha1.buf, md->sha1.state,
+                           in, inlen, sha1_compress_shani );
+}
+
+static const struct ltc_hash_descriptor sha1_shani_desc =
+{
+    "sha1", 2, 20, 64, { 1, 3, 14, 3, 2, 26 }, 6,
+    sha1_init, sha1_process_shani, sha1_done, sha1_test, NULL
+};
+
+static const struct ltc_hash_descriptor sha256_shani_desc =
+{
+    "sha256", 0, 32, 64, { 2, 16, 840, 1, 101, 3, 4, 2, 1 }, 9,
+    sha256_init, sha256_process_shani, sha256_done, sha256_test, NULL
+};
+
+static BOOL have_sha_extensions(void)
+{
+    static int supported = -1;
+    int regs[4];
+
+    if (supported != -1) return supported;
+
+    __cpuid( regs, 0 );
+    if (regs[0] < 7) supported = 0;
+    else
+    {
+        __cpuidex( regs, 7, 0 );
+        supported = (regs[1] & (1 << 29)) && IsProcessorFeaturePresent( PF_SSSE3_INSTRUCTIONS_AVAILABLE )
+                    && IsProcessorFeaturePresent( PF_SSE4_1_INSTRUCTIONS_AVAILABLE );
+    }
+    TRACE( "SHA extensions %ssupported\n", supported ? "" : "not " );
+    return supported;
+}
+
+const struct ltc_hash_descriptor *get_accelerated_hash_descriptor( enum alg_id alg_id )
+{
+    if (!have_sha_extensions()) return NULL;
+
+    switch (alg_id)
+    {
+    case ALG_ID_SHA1: return &sha1_shani_desc;
+    case ALG_ID_SHA256: return &sha256_shani_desc;
+    default: return NULL;
+    }
+}
+
+#else
+
+const struct ltc_hash_descriptor *get_accelerated_hash_descriptor( enum alg_id alg_id )
+{
+    return NULL;
+}
+
+#endif
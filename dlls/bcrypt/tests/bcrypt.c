@@ -414,6 +414,68 @@ static void test_hashes(void)
         test_hash(tests+i);
 }
 
+static void test_hash_large_data(void)
+{
+    static const struct
+    {
+        const WCHAR *alg;
+        ULONG hash_size;
+        const char *hash;
+    }
+    tests[] =
+    {
+        /* one million times 'a' */
+        { L"SHA1", 20, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+        { L"SHA256", 32, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+        { L"SHA512", 64, "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+                         "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+    };
+    static const ULONG chunks[] = { 1, 63, 64, 65, 1000, 4096, 100000 };
+    BCRYPT_ALG_HANDLE alg;
+    BCRYPT_HASH_HANDLE hash;
+    UCHAR hash_buf[64];
+    char str[129];
+    ULONG i, j, pos, len;
+    NTSTATUS ret;
+    UCHAR *data;
+
+    data = malloc(1000000);
+    memset(data, 'a', 1000000);
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        ret = BCryptOpenAlgorithmProvider(&alg, tests[i].alg, MS_PRIMITIVE_PROVIDER, 0);
+        ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+
+        /* feed the data in differently sized chunks to exercise partial and multi-block updates */
+        for (j = 0; j < ARRAY_SIZE(chunks); j++)
+        {
+            ret = BCryptCreateHash(alg, &hash, NULL, 0, NULL, 0, 0);
+            ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+
+            for (pos = 0; pos < 1000000; pos += len)
+            {
+                len = min(chunks[j] + (pos & 7), 1000000 - pos);
+                ret = BCryptHashData(hash, data + pos, len, 0);
+                ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+            }
+
+            ret = BCryptFinishHash(hash, hash_buf, tests[i].hash_size, 0);
+            ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+            format_hash(hash_buf, tests[i].hash_size, str);
+            ok(!strcmp(str, tests[i].hash), "%s chunk %lu: got %s\n", wine_dbgstr_w(tests[i].alg), chunks[j], str);
+
+            ret = BCryptDestroyHash(hash);
+            ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+        }
+
+        ret = BCryptCloseAlgorithmProvider(alg, 0);
+        ok(ret == STATUS_SUCCESS, "got %#lx\n", ret);
+    }
+
+    free(data);
+}
+
 static void test_BcryptHash(void)
 {
     static const char expected[] =
@@ -4344,6 +4406,7 @@ START_TEST(bcrypt)
     test_BCryptGenRandom();
     test_BCryptGetFipsAlgorithmMode();
     test_hashes();
+    test_hash_large_data();
     test_BcryptHash();
     test_BcryptDeriveKeyPBKDF2();
     test_rng();
@@ -33,6 +33,7 @@ There is still some work to be done:
 #include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -138,6 +139,19 @@ struct data_block
     cab_UWORD   uncompressed;
 };
 
+/* data block waiting to be compressed */
+struct pending_block
+{
+    cab_UWORD     uncompressed;
+    cab_UWORD     compressed;
+    cab_ULONG     lzx_pos;        /* position of the data in the LZX history buffer */
+    unsigned int  lzx_count;      /* number of parsed LZX literals and matches */
+    unsigned char in[CAB_BLOCKMAX];
+    unsigned char out[2 * CAB_BLOCKMAX];
+};
+
+struct lzx_compressor;
+
 typedef struct FCI_Int
 {
   unsigned int       magic;
@@ -163,9 +177,15 @@ typedef struct FCI_Int
   void               *pv;
   char               szPrevCab[CB_MAX_CABINET_NAME]; /* previous cabinet name */
   char               szPrevDisk[CB_MAX_DISK_NAME];   /* disk name of previous cabinet */
-  unsigned char      data_in[CAB_BLOCKMAX];          /* uncompressed data blocks */
   unsigned char      data_out[2 * CAB_BLOCKMAX];     /* compressed data blocks */
-  cab_UWORD          cdata_in;
+  struct pending_block *pending;                     /* uncompressed data blocks */
+  unsigned int       pending_count;                  /* number of complete pending blocks */
+  unsigned int       pending_max;
+  LONG               pending_next;                   /* next block to pick by compression threads */
+  unsigned int       threads;
+  PTP_WORK           work;
+  struct lzx_compressor *lzx;
+  cab_UWORD          cdata_in;                       /* size of the current pending block */
   ULONG              cCompressedBytesInFolder;
   cab_UWORD          cFolders;
   cab_UWORD          cFiles;
@@ -184,11 +204,13 @@ typedef struct FCI_Int
   cab_ULONG          pending_data_size;   /* size of data not yet assigned to a folder */
   cab_ULONG          folders_data_size;   /* total size of data contained in the current folders */
   TCOMP              compression;
-  cab_UWORD        (*compress)(struct FCI_Int *);
+  void             (*compress)(struct FCI_Int *, struct pending_block *);
 } FCI_Int;
 
 #define FCI_INT_MAGIC 0xfcfcfc05
 
+#define FCI_MAX_PENDING 16
+
 static void set_error( FCI_Int *fci, int oper, int err )
 {
     fci->perf->erfOper = oper;
@@ -305,46 +327,663 @@ static void free_file( FCI_Int *fci, struct file *file )
     fci->free( file );
 }
 
-/* create a new data block for the data in fci->data_in */
-static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
+static void compress_NONE( FCI_Int *fci, struct pending_block *block )
 {
-    int err;
-    struct data_block *block;
+    memcpy( block->out, block->in, block->uncompressed );
+    block->compressed = block->uncompressed;
+}
 
-    if (!fci->cdata_in) return TRUE;
+/* the compression threads can't use the FCI allocation callbacks */
+static void *zalloc( void *opaque, unsigned int items, unsigned int size )
+{
+    return malloc( items * size );
+}
 
-    if (fci->data.handle == -1 && !create_temp_file( fci, &fci->data )) return FALSE;
+static void zfree( void *opaque, void *ptr )
+{
+    free( ptr );
+}
+
+static void compress_MSZIP( FCI_Int *fci, struct pending_block *block )
+{
+    z_stream stream;
+
+    block->compressed = 0;
+    stream.zalloc = zalloc;
+    stream.zfree  = zfree;
+    stream.opaque = NULL;
+    if (deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY ) != Z_OK)
+        return;
+    stream.next_in   = block->in;
+    stream.avail_in  = block->uncompressed;
+    stream.next_out  = block->out + 2;
+    stream.avail_out = sizeof(block->out) - 2;
+    /* insert the signature */
+    block->out[0] = 'C';
+    block->out[1] = 'K';
+    deflate( &stream, Z_FINISH );
+    deflateEnd( &stream );
+    block->compressed = stream.total_out + 2;
+}
+
+/* LZX compression
+ *
+ * Matches are searched for in parallel for all the pending blocks, using hash chains over a
+ * history buffer that holds the previous window of the folder data. The entropy coding has to be
+ * done in order since the Huffman tables and the repeated offsets are carried over from one block
+ * to the next. Every block is a single verbatim (or uncompressed) LZX block, and matches never
+ * cross block boundaries, so each CFDATA block ends on a 16-bit boundary as the decoder expects.
+ */
+
+#define LZX_HASH_BITS    15
+#define LZX_MAX_CHAIN    48
+#define LZX_NICE_MATCH   96
+#define LZX_MATCH_SHIFT  21  /* matches are stored as (length << LZX_MATCH_SHIFT) | offset */
 
-    if (!(block = fci->alloc( sizeof(*block) )))
+static const cab_UBYTE lzx_extra_bits[51] =
+{
+     0,  0,  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,
+     7,  7,  8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14,
+    15, 15, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    17, 17, 17
+};
+
+static const cab_ULONG lzx_position_base[51] =
+{
+          0,       1,       2,       3,       4,       6,       8,      12,
+         16,      24,      32,      48,      64,      96,     128,     192,
+        256,     384,     512,     768,    1024,    1536,    2048,    3072,
+       4096,    6144,    8192,   12288,   16384,   24576,   32768,   49152,
+      65536,   98304,  131072,  196608,  262144,  393216,  524288,  655360,
+     786432,  917504, 1048576, 1179648, 1310720, 1441792, 1572864, 1703936,
+    1835008, 1966080, 2097152
+};
+
+struct lzx_compressor
+{
+    unsigned int   window_bits;
+    cab_ULONG      window_size;
+    unsigned int   posn_slots;
+    unsigned int   main_elements;
+    BOOL           header_written;        /* the E8 translation header has been written */
+    cab_ULONG      R0, R1, R2;            /* repeated offsets */
+    cab_UBYTE      main_len[LZX_MAINTREE_MAXSYMBOLS];
+    cab_UBYTE      length_len[LZX_NUM_SECONDARY_LENGTHS];
+    unsigned char *buf;                   /* history and pending data */
+    cab_ULONG      buf_size;
+    cab_ULONG      buf_len;
+    cab_ULONG      hashed;                /* number of positions inserted in the hash chains */
+    LONG          *prev;                  /* previous position with the same hash */
+    ULONG         *items;                 /* parsed literals and matches for the pending blocks */
+    LONG           head[1 << LZX_HASH_BITS];
+};
+
+struct lzx_output
+{
+    unsigned char *data;
+    unsigned int   pos;
+    unsigned int   size;
+    cab_ULONG      bits;
+    unsigned int   count;
+};
+
+static void lzx_reset( struct lzx_compressor *lzx )
+{
+    lzx->header_written = FALSE;
+    lzx->R0 = lzx->R1 = lzx->R2 = 1;
+    memset( lzx->main_len, 0, sizeof(lzx->main_len) );
+    memset( lzx->length_len, 0, sizeof(lzx->length_len) );
+    memset( lzx->head, 0xff, sizeof(lzx->head) );
+    lzx->buf_len = 0;
+    lzx->hashed = 0;
+}
+
+static void lzx_free( FCI_Int *fci, struct lzx_compressor *lzx )
+{
+    if (!lzx) return;
+    fci->free( lzx->buf );
+    fci->free( lzx->prev );
+    fci->free( lzx->items );
+    fci->free( lzx );
+}
+
+static struct lzx_compressor *lzx_create( FCI_Int *fci, unsigned int window_bits )
+{
+    struct lzx_compressor *lzx;
+
+    if (!(lzx = fci->alloc( sizeof(*lzx) ))) return NULL;
+    lzx->window_bits = window_bits;
+    lzx->window_size = 1 << window_bits;
+    if (window_bits == 20) lzx->posn_slots = 42;
+    else if (window_bits == 21) lzx->posn_slots = 50;
+    else lzx->posn_slots = window_bits << 1;
+    lzx->main_elements = LZX_NUM_CHARS + (lzx->posn_slots << 3);
+    lzx->buf_size = lzx->window_size + fci->pending_max * CAB_BLOCKMAX;
+    lzx->buf   = fci->alloc( lzx->buf_size );
+    lzx->prev  = fci->alloc( lzx->buf_size * sizeof(*lzx->prev) );
+    lzx->items = fci->alloc( fci->pending_max * CAB_BLOCKMAX * sizeof(*lzx->items) );
+    if (!lzx->buf || !lzx->prev || !lzx->items)
     {
-        set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
-        return FALSE;
+        lzx_free( fci, lzx );
+        return NULL;
     }
-    block->uncompressed = fci->cdata_in;
-    block->compressed   = fci->compress( fci );
+    lzx_reset( lzx );
+    return lzx;
+}
 
-    if (fci->write( fci->data.handle, fci->data_out,
-                    block->compressed, &err, fci->pv ) != block->compressed)
+static inline unsigned int lzx_hash( const unsigned char *p )
+{
+    return ((p[0] | (p[1] << 8) | (p[2] << 16)) * 0x9e3779b1) >> (32 - LZX_HASH_BITS);
+}
+
+/* append the pending blocks to the history buffer and update the hash chains */
+static void lzx_add_pending_data( FCI_Int *fci )
+{
+    struct lzx_compressor *lzx = fci->lzx;
+    cab_ULONG i, keep, shift;
+    unsigned int j;
+
+    /* only keep one window of history */
+    keep = min( lzx->buf_len, lzx->window_size );
+    if ((shift = lzx->buf_len - keep))
     {
-        set_error( fci, FCIERR_TEMP_FILE, err );
-        fci->free( block );
-        return FALSE;
+        memmove( lzx->buf, lzx->buf + shift, keep );
+        memmove( lzx->prev, lzx->prev + shift, keep * sizeof(*lzx->prev) );
+        for (i = 0; i < keep; i++) lzx->prev[i] = max( lzx->prev[i] - (LONG)shift, -1 );
+        for (i = 0; i < ARRAY_SIZE(lzx->head); i++) lzx->head[i] = max( lzx->head[i] - (LONG)shift, -1 );
+        lzx->buf_len -= shift;
+        lzx->hashed -= shift;
     }
 
-    fci->cdata_in = 0;
-    fci->pending_data_size += sizeof(CFDATA) + fci->ccab.cbReserveCFData + block->compressed;
-    fci->cCompressedBytesInFolder += block->compressed;
-    fci->cDataBlocks++;
-    list_add_tail( &fci->blocks_list, &block->entry );
+    for (j = 0; j < fci->pending_count; j++)
+    {
+        struct pending_block *block = &fci->pending[j];
+
+        block->lzx_pos = lzx->buf_len;
+        memcpy( lzx->buf + lzx->buf_len, block->in, block->uncompressed );
+        lzx->buf_len += block->uncompressed;
+    }
 
-    if (status_callback( statusFile, block->compressed, block->uncompressed, fci->pv ) == -1)
+    for (i = lzx->hashed; i + 2 < lzx->buf_len; i++)
     {
-        set_error( fci, FCIERR_USER_ABORT, 0 );
-        return FALSE;
+        unsigned int hash = lzx_hash( lzx->buf + i );
+        lzx->prev[i] = lzx->head[hash];
+        lzx->head[hash] = i;
+    }
+    lzx->hashed = i;
+}
+
+/* find the longest match for the data at pos, only looking at previous positions */
+static unsigned int lzx_find_match( const struct lzx_compressor *lzx, cab_ULONG pos, cab_ULONG end,
+                                    cab_ULONG *offset )
+{
+    const unsigned char *data = lzx->buf + pos, *match;
+    unsigned int len, best = 2, max_len = min( end - pos, LZX_MAX_MATCH ), chain = LZX_MAX_CHAIN;
+    LONG limit = pos - (lzx->window_size - 3), cand;
+
+    if (max_len < 3) return 0;
+
+    for (cand = lzx->prev[pos]; cand >= 0 && cand >= limit && chain--; cand = lzx->prev[cand])
+    {
+        match = lzx->buf + cand;
+        if (match[best] != data[best] || match[0] != data[0] || match[1] != data[1]) continue;
+        for (len = 2; len < max_len && match[len] == data[len]; len++) ;
+        if (len > best)
+        {
+            best = len;
+            *offset = pos - cand;
+            if (len >= min( max_len, LZX_NICE_MATCH )) break;
+        }
+    }
+    return best > 2 ? best : 0;
+}
+
+/* split the block into literals and matches, with one step of lazy evaluation */
+static void compress_LZX( FCI_Int *fci, struct pending_block *block )
+{
+    const struct lzx_compressor *lzx = fci->lzx;
+    cab_ULONG pos = block->lzx_pos, end = pos + block->uncompressed, offset = 0, next_offset = 0;
+    ULONG *items = lzx->items + (block - fci->pending) * CAB_BLOCKMAX;
+    unsigned int len, next_len, count = 0;
+
+    len = lzx_find_match( lzx, pos, end, &offset );
+    while (pos < end)
+    {
+        if (len && len < LZX_NICE_MATCH && pos + 1 < end &&
+            (next_len = lzx_find_match( lzx, pos + 1, end, &next_offset )) > len)
+        {
+            items[count++] = lzx->buf[pos++];
+            len = next_len;
+            offset = next_offset;
+            continue;
+        }
+        if (len)
+        {
+            items[count++] = (len << LZX_MATCH_SHIFT) | offset;
+            pos += len;
+        }
+        else items[count++] = lzx->buf[pos++];
+
+        len = pos < end ? lzx_find_match( lzx, pos, end, &offset ) : 0;
+    }
+    block->lzx_count = count;
+    block->compressed = 1;
+}
+
+static void lzx_put_bits( struct lzx_output *out, cab_ULONG value, unsigned int count )
+{
+    if (count > 16)
+    {
+        lzx_put_bits( out, value >> 16, count - 16 );
+        value &= 0xffff;
+        count = 16;
+    }
+    out->bits = (out->bits << count) | value;
+    out->count += count;
+    if (out->count >= 16)
+    {
+        cab_UWORD word = out->bits >> (out->count - 16);
+
+        out->count -= 16;
+        if (out->pos + 2 <= out->size)
+        {
+            out->data[out->pos] = word;
+            out->data[out->pos + 1] = word >> 8;
+        }
+        out->pos += 2;
+    }
+}
+
+static void lzx_flush_bits( struct lzx_output *out )
+{
+    if (out->count) lzx_put_bits( out, 0, 16 - out->count );
+}
+
+static int __cdecl compare_symbol_freq( const void *a, const void *b )
+{
+    const ULONGLONG *x = a, *y = b;
+    return *x < *y ? -1 : *x > *y;
+}
+
+/* compute length-limited Huffman code lengths */
+static void lzx_make_lengths( const cab_ULONG *freq, unsigned int count, unsigned int max_bits,
+                              cab_UBYTE *lens )
+{
+    ULONGLONG sorted[LZX_MAINTREE_MAXSYMBOLS];
+    cab_ULONG weight[LZX_MAINTREE_MAXSYMBOLS];
+    unsigned int i, shift = 0;
+    int n, root, leaf, next, avail, used, depth;
+    BOOL too_long;
+
+    memset( lens, 0, count );
+    do
+    {
+        /* sort the used symbols by increasing frequency, scaling them down if codes got too long */
+        for (i = n = 0; i < count; i++)
+            if (freq[i]) sorted[n++] = ((ULONGLONG)((freq[i] >> shift) | 1) << 16) | i;
+
+        if (!n) return;
+        if (n == 1)
+        {
+            /* a complete code needs at least two symbols */
+            i = sorted[0] & 0xffff;
+            lens[i] = lens[i ? 0 : 1] = 1;
+            return;
+        }
+        qsort( sorted, n, sizeof(sorted[0]), compare_symbol_freq );
+        for (i = 0; i < n; i++) weight[i] = sorted[i] >> 16;
+
+        /* in-place minimum redundancy code computation, Moffat and Katajainen */
+        weight[0] += weight[1];
+        for (root = 0, leaf = 2, next = 1; next < n - 1; next++)
+        {
+            if (leaf >= n || weight[root] < weight[leaf])
+            {
+                weight[next] = weight[root];
+                weight[root++] = next;
+            }
+            else weight[next] = weight[leaf++];
+
+            if (leaf >= n || (root < next && weight[root] < weight[leaf]))
+            {
+                weight[next] += weight[root];
+                weight[root++] = next;
+            }
+            else weight[next] += weight[leaf++];
+        }
+        weight[n - 2] = 0;
+        for (next = n - 3; next >= 0; next--) weight[next] = weight[weight[next]] + 1;
+
+        avail = 1;
+        used = depth = 0;
+        root = n - 2;
+        next = n - 1;
+        while (avail > 0)
+        {
+            while (root >= 0 && weight[root] == depth)
+            {
+                used++;
+                root--;
+            }
+            while (avail > used)
+            {
+                weight[next--] = depth;
+                avail--;
+            }
+            avail = 2 * used;
+            depth++;
+            used = 0;
+        }
+
+        too_long = weight[0] > max_bits;
+        shift++;
+    } while (too_long);
+
+    for (i = 0; i < n; i++) lens[sorted[i] & 0xffff] = weight[i];
+}
+
+static void lzx_make_codes( const cab_UBYTE *lens, unsigned int count, cab_UWORD *codes )
+{
+    unsigned int bits, i, code = 0;
+
+    for (bits = 1; bits <= 16; bits++, code <<= 1)
+        for (i = 0; i < count; i++) if (lens[i] == bits) codes[i] = code++;
+}
+
+/* write the code lengths lens[first..last-1] as deltas from the previous ones, using a pretree */
+static void lzx_write_lengths( struct lzx_output *out, const cab_UBYTE *lens, const cab_UBYTE *prev,
+                               unsigned int first, unsigned int last )
+{
+    cab_UBYTE syms[2 * LZX_MAINTREE_MAXSYMBOLS], extra[2 * LZX_MAINTREE_MAXSYMBOLS];
+    cab_ULONG freq[LZX_PRETREE_NUM_ELEMENTS] = { 0 };
+    cab_UBYTE pretree_len[LZX_PRETREE_NUM_ELEMENTS];
+    cab_UWORD pretree_code[LZX_PRETREE_NUM_ELEMENTS];
+    unsigned int i, j, run, n, count = 0;
+
+    for (i = first; i < last; i += n)
+    {
+        for (run = 1; i + run < last && lens[i + run] == lens[i]; run++) ;
+
+        if (!lens[i] && run >= 20)
+        {
+            n = min( run, 51 );
+            syms[count] = 18;
+            extra[count++] = n - 20;
+        }
+        else if (!lens[i] && run >= 4)
+        {
+            n = run;
+            syms[count] = 17;
+            extra[count++] = n - 4;
+        }
+        else if (run >= 4)
+        {
+            n = min( run, 5 );
+            syms[count] = 19;
+            extra[count++] = n - 4;
+            syms[count++] = (prev[i] - lens[i] + 17) % 17;
+        }
+        else
+        {
+            n = 1;
+            syms[count++] = (prev[i] - lens[i] + 17) % 17;
+        }
+    }
+
+    for (i = 0; i < count; i++) freq[syms[i]]++;
+
+    lzx_make_lengths( freq, LZX_PRETREE_NUM_ELEMENTS, 15, pretree_len );
+    lzx_make_codes( pretree_len, LZX_PRETREE_NUM_ELEMENTS, pretree_code );
+
+    for (i = 0; i < LZX_PRETREE_NUM_ELEMENTS; i++) lzx_put_bits( out, pretree_len[i], 4 );
+    for (i = 0; i < count; i++)
+    {
+        j = syms[i];
+        lzx_put_bits( out, pretree_code[j], pretree_len[j] );
+        if (j == 17) lzx_put_bits( out, extra[i], 4 );
+        else if (j == 18) lzx_put_bits( out, extra[i], 5 );
+        else if (j == 19)
+        {
+            lzx_put_bits( out, extra[i], 1 );
+            j = syms[++i];
+            lzx_put_bits( out, pretree_code[j], pretree_len[j] );
+        }
+    }
+}
+
+/* convert a match offset to its position slot, updating the repeated offsets */
+static unsigned int lzx_position_slot( cab_ULONG *R, cab_ULONG offset, cab_ULONG *footer )
+{
+    unsigned int lo = 3, hi = ARRAY_SIZE(lzx_position_base) - 1, mid;
+    cab_ULONG tmp;
+
+    *footer = 0;
+    if (offset == R[0]) return 0;
+    if (offset == R[1])
+    {
+        tmp = R[0]; R[0] = R[1]; R[1] = tmp;
+        return 1;
+    }
+    if (offset == R[2])
+    {
+        tmp = R[0]; R[0] = R[2]; R[2] = tmp;
+        return 2;
+    }
+
+    R[2] = R[1];
+    R[1] = R[0];
+    R[0] = offset;
+
+    /* formatted offsets are offset + 2, find the last slot whose base is not above it */
+    offset += 2;
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if (lzx_position_base[mid] <= offset) lo = mid;
+        else hi = mid - 1;
+    }
+    *footer = offset - lzx_position_base[lo];
+    return lo;
+}
+
+static void lzx_write_block_header( struct lzx_compressor *lzx, struct lzx_output *out,
+                                    unsigned int type, cab_ULONG size )
+{
+    /* no E8 call translation */
+    if (!lzx->header_written) lzx_put_bits( out, 0, 1 );
+    lzx_put_bits( out, type, 3 );
+    lzx_put_bits( out, size >> 8, 16 );
+    lzx_put_bits( out, size & 0xff, 8 );
+}
+
+/* entropy code the parsed block into a verbatim block, or fall back to an uncompressed block */
+static void lzx_encode_block( FCI_Int *fci, struct pending_block *block )
+{
+    struct lzx_compressor *lzx = fci->lzx;
+    const ULONG *items = lzx->items + (block - fci->pending) * CAB_BLOCKMAX;
+    cab_ULONG main_freq[LZX_MAINTREE_MAXSYMBOLS] = { 0 }, length_freq[LZX_NUM_SECONDARY_LENGTHS] = { 0 };
+    cab_UBYTE main_len[LZX_MAINTREE_MAXSYMBOLS], length_len[LZX_NUM_SECONDARY_LENGTHS];
+    cab_UWORD main_code[LZX_MAINTREE_MAXSYMBOLS], length_code[LZX_NUM_SECONDARY_LENGTHS];
+    cab_ULONG R[3], footer, len;
+    struct lzx_output out = { block->out, 0, sizeof(block->out) };
+    unsigned int i, slot, sym, header, stored;
+
+    R[0] = lzx->R0; R[1] = lzx->R1; R[2] = lzx->R2;
+    for (i = 0; i < block->lzx_count; i++)
+    {
+        if (!(len = items[i] >> LZX_MATCH_SHIFT))
+        {
+            main_freq[items[i]]++;
+            continue;
+        }
+        slot = lzx_position_slot( R, items[i] & ((1 << LZX_MATCH_SHIFT) - 1), &footer );
+        header = min( len - LZX_MIN_MATCH, LZX_NUM_PRIMARY_LENGTHS );
+        main_freq[LZX_NUM_CHARS + (slot << 3) + header]++;
+        if (header == LZX_NUM_PRIMARY_LENGTHS) length_freq[len - LZX_MIN_MATCH - LZX_NUM_PRIMARY_LENGTHS]++;
+    }
+
+    lzx_make_lengths( main_freq, lzx->main_elements, 16, main_len );
+    lzx_make_lengths( length_freq, LZX_NUM_SECONDARY_LENGTHS, 16, length_len );
+    lzx_make_codes( main_len, lzx->main_elements, main_code );
+    lzx_make_codes( length_len, LZX_NUM_SECONDARY_LENGTHS, length_code );
+
+    lzx_write_block_header( lzx, &out, LZX_BLOCKTYPE_VERBATIM, block->uncompressed );
+    lzx_write_lengths( &out, main_len, lzx->main_len, 0, LZX_NUM_CHARS );
+    lzx_write_lengths( &out, main_len, lzx->main_len, LZX_NUM_CHARS, lzx->main_elements );
+    lzx_write_lengths( &out, length_len, lzx->length_len, 0, LZX_NUM_SECONDARY_LENGTHS );
+
+    R[0] = lzx->R0; R[1] = lzx->R1; R[2] = lzx->R2;
+    for (i = 0; i < block->lzx_count && out.pos <= out.size; i++)
+    {
+        if (!(len = items[i] >> LZX_MATCH_SHIFT))
+        {
+            lzx_put_bits( &out, main_code[items[i]], main_len[items[i]] );
+            continue;
+        }
+        slot = lzx_position_slot( R, items[i] & ((1 << LZX_MATCH_SHIFT) - 1), &footer );
+        header = min( len - LZX_MIN_MATCH, LZX_NUM_PRIMARY_LENGTHS );
+        sym = LZX_NUM_CHARS + (slot << 3) + header;
+        lzx_put_bits( &out, main_code[sym], main_len[sym] );
+        if (header == LZX_NUM_PRIMARY_LENGTHS)
+        {
+            sym = len - LZX_MIN_MATCH - LZX_NUM_PRIMARY_LENGTHS;
+            lzx_put_bits( &out, length_code[sym], length_len[sym] );
+        }
+        if (slot >= 3) lzx_put_bits( &out, footer, lzx_extra_bits[slot] );
+    }
+    lzx_flush_bits( &out );
+
+    /* size of an uncompressed block: header, 1 to 16 bits of alignment, repeated offsets, and the
+     * data padded to 16 bits */
+    stored = ((!lzx->header_written + 27) / 16 + 1) * 2 + 12 + block->uncompressed + (block->uncompressed & 1);
+    if (out.pos < stored)
+    {
+        memcpy( lzx->main_len, main_len, lzx->main_elements );
+        memcpy( lzx->length_len, length_len, sizeof(lzx->length_len) );
+        lzx->R0 = R[0]; lzx->R1 = R[1]; lzx->R2 = R[2];
+        lzx->header_written = TRUE;
+        block->compressed = out.pos;
+        return;
+    }
+
+    TRACE( "storing block uncompressed\n" );
+    memset( &out, 0, sizeof(out) );
+    out.data = block->out;
+    out.size = sizeof(block->out);
+    lzx_write_block_header( lzx, &out, LZX_BLOCKTYPE_UNCOMPRESSED, block->uncompressed );
+    lzx_put_bits( &out, 0, 16 - out.count );
+    for (i = 0; i < 3; i++)
+    {
+        cab_ULONG offset = i ? (i == 1 ? lzx->R1 : lzx->R2) : lzx->R0;
+        block->out[out.pos++] = offset;
+        block->out[out.pos++] = offset >> 8;
+        block->out[out.pos++] = offset >> 16;
+        block->out[out.pos++] = offset >> 24;
+    }
+    memcpy( block->out + out.pos, block->in, block->uncompressed );
+    out.pos += block->uncompressed;
+    if (block->uncompressed & 1) block->out[out.pos++] = 0;
+    lzx->header_written = TRUE;
+    block->compressed = out.pos;
+}
+
+static void compress_blocks( FCI_Int *fci )
+{
+    LONG i;
+
+    while ((i = InterlockedIncrement( &fci->pending_next ) - 1) < fci->pending_count)
+        fci->compress( fci, &fci->pending[i] );
+}
+
+static void CALLBACK compress_blocks_callback( TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work )
+{
+    compress_blocks( context );
+}
+
+/* compress all the pending blocks, using the thread pool when more than one is pending */
+static void compress_pending_blocks( FCI_Int *fci )
+{
+    BOOL lzx = (fci->compression & tcompMASK_TYPE) == tcompTYPE_LZX;
+    unsigned int i, threads = min( fci->pending_count, fci->threads );
+
+    if (fci->compress == compress_NONE) threads = 1;
+
+    if (lzx) lzx_add_pending_data( fci );
+
+    fci->pending_next = 0;
+    for (i = 1; i < threads; i++) SubmitThreadpoolWork( fci->work );
+    compress_blocks( fci );
+    if (threads > 1) WaitForThreadpoolWorkCallbacks( fci->work, FALSE );
+
+    if (lzx) for (i = 0; i < fci->pending_count; i++) lzx_encode_block( fci, &fci->pending[i] );
+}
+
+/* compress all the pending blocks and add them to the temp file */
+static BOOL flush_pending_blocks( FCI_Int *fci, PFNFCISTATUS status_callback )
+{
+    struct pending_block *pending;
+    struct data_block *block;
+    unsigned int i, count = fci->pending_count;
+    int err;
+
+    if (!count) return TRUE;
+
+    if (fci->data.handle == -1 && !create_temp_file( fci, &fci->data )) return FALSE;
+
+    compress_pending_blocks( fci );
+    fci->pending_count = 0;
+    /* the partially filled block goes back to the start of the queue */
+    if (fci->cdata_in) memcpy( fci->pending[0].in, fci->pending[count].in, fci->cdata_in );
+
+    for (i = 0; i < count; i++)
+    {
+        pending = &fci->pending[i];
+        if (!pending->compressed)
+        {
+            set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
+            return FALSE;
+        }
+        if (!(block = fci->alloc( sizeof(*block) )))
+        {
+            set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
+            return FALSE;
+        }
+        block->uncompressed = pending->uncompressed;
+        block->compressed   = pending->compressed;
+
+        if (fci->write( fci->data.handle, pending->out,
+                        block->compressed, &err, fci->pv ) != block->compressed)
+        {
+            set_error( fci, FCIERR_TEMP_FILE, err );
+            fci->free( block );
+            return FALSE;
+        }
+
+        fci->pending_data_size += sizeof(CFDATA) + fci->ccab.cbReserveCFData + block->compressed;
+        fci->cCompressedBytesInFolder += block->compressed;
+        list_add_tail( &fci->blocks_list, &block->entry );
+
+        if (status_callback( statusFile, block->compressed, block->uncompressed, fci->pv ) == -1)
+        {
+            set_error( fci, FCIERR_USER_ABORT, 0 );
+            return FALSE;
+        }
     }
     return TRUE;
 }
 
+/* queue the data in the current pending block, and compress the queue once it is full */
+static BOOL add_data_block( FCI_Int *fci, PFNFCISTATUS status_callback )
+{
+    if (!fci->cdata_in) return TRUE;
+
+    fci->pending[fci->pending_count++].uncompressed = fci->cdata_in;
+    fci->cdata_in = 0;
+    fci->cDataBlocks++;
+    if (fci->pending_count < fci->pending_max) return TRUE;
+    return flush_pending_blocks( fci, status_callback );
+}
+
 /* add compressed blocks for all the data that can be read from the file */
 static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL execute,
                            PFNFCIGETOPENINFO get_open_info, PFNFCISTATUS status_callback )
@@ -366,7 +1005,7 @@ static BOOL add_file_data( FCI_Int *fci, char *sourcefile, char *filename, BOOL
 
     for (;;)
     {
-        len = fci->read( handle, fci->data_in + fci->cdata_in,
+        len = fci->read( handle, fci->pending[fci->pending_count].in + fci->cdata_in,
                          CAB_BLOCKMAX - fci->cdata_in, &err, fci->pv );
         if (!len) break;
 
@@ -899,47 +1538,6 @@ static BOOL add_files_to_folder( FCI_Int *fci, struct folder *folder, cab_ULONG
     return TRUE;
 }
 
-static cab_UWORD compress_NONE( FCI_Int *fci )
-{
-    memcpy( fci->data_out, fci->data_in, fci->cdata_in );
-    return fci->cdata_in;
-}
-
-static void *zalloc( void *opaque, unsigned int items, unsigned int size )
-{
-    FCI_Int *fci = opaque;
-    return fci->alloc( items * size );
-}
-
-static void zfree( void *opaque, void *ptr )
-{
-    FCI_Int *fci = opaque;
-    fci->free( ptr );
-}
-
-static cab_UWORD compress_MSZIP( FCI_Int *fci )
-{
-    z_stream stream;
-
-    stream.zalloc = zalloc;
-    stream.zfree  = zfree;
-    stream.opaque = fci;
-    if (deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY ) != Z_OK)
-    {
-        set_error( fci, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
-        return 0;
-    }
-    stream.next_in   = fci->data_in;
-    stream.avail_in  = fci->cdata_in;
-    stream.next_out  = fci->data_out + 2;
-    stream.avail_out = sizeof(fci->data_out) - 2;
-    /* insert the signature */
-    fci->data_out[0] = 'C';
-    fci->data_out[1] = 'K';
-    deflate( &stream, Z_FINISH );
-    deflateEnd( &stream );
-    return stream.total_out + 2;
-}
 
 
 /***********************************************************************
@@ -1003,6 +1601,7 @@ HFCI __cdecl FCICreate(
 	void *pv)
 {
   FCI_Int *p_fci_internal;
+  SYSTEM_INFO info;
 
   if (!perf) {
     SetLastError(ERROR_BAD_ARGUMENTS);
@@ -1047,6 +1646,25 @@ HFCI __cdecl FCICreate(
   p_fci_internal->data.handle = -1;
   p_fci_internal->compress = compress_NONE;
 
+  /* queue up one data block per processor, so that they can be compressed in parallel */
+  GetSystemInfo( &info );
+  p_fci_internal->threads = min( max( info.dwNumberOfProcessors, 1 ), FCI_MAX_PENDING );
+  if (p_fci_internal->threads > 1 &&
+      !(p_fci_internal->work = CreateThreadpoolWork( compress_blocks_callback, p_fci_internal, NULL )))
+      p_fci_internal->threads = 1;
+  /* always queue at least two blocks, so that the queue handling is the same on all machines */
+  p_fci_internal->pending_max = max( p_fci_internal->threads, 2 );
+  if (!(p_fci_internal->pending = pfnalloc( p_fci_internal->pending_max * sizeof(struct pending_block) ))) {
+    if (p_fci_internal->work) CloseThreadpoolWork( p_fci_internal->work );
+    pfnfree( p_fci_internal );
+    perf->erfOper = FCIERR_ALLOC_FAIL;
+    perf->erfType = ERROR_NOT_ENOUGH_MEMORY;
+    perf->fError = TRUE;
+
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+
   list_init( &p_fci_internal->folders_list );
   list_init( &p_fci_internal->files_list );
   list_init( &p_fci_internal->blocks_list );
@@ -1103,6 +1721,10 @@ static BOOL fci_flush_folder( FCI_Int *p_fci_internal,
 
   /* START of COPY */
   if (!add_data_block( p_fci_internal, pfnfcis )) return FALSE;
+  if (!flush_pending_blocks( p_fci_internal, pfnfcis )) return FALSE;
+
+  /* the compression state starts over with each folder */
+  if (p_fci_internal->lzx) lzx_reset( p_fci_internal->lzx );
 
   /* reset to get the number of data blocks of this folder which are */
   /* actually in this cabinet ( at least partially ) */
@@ -1410,12 +2032,35 @@ BOOL __cdecl FCIAddFile(
   if (typeCompress != p_fci_internal->compression)
   {
       if (!FCIFlushFolder( hfci, pfnfcignc, pfnfcis )) return FALSE;
-      switch (typeCompress)
+      switch (CompressionTypeFromTCOMP( typeCompress ))
       {
       case tcompTYPE_MSZIP:
           p_fci_internal->compression = tcompTYPE_MSZIP;
           p_fci_internal->compress    = compress_MSZIP;
           break;
+      case tcompTYPE_LZX:
+      {
+          unsigned int window = LZXCompressionWindowFromTCOMP( typeCompress );
+
+          if (window < 15 || window > 21)
+          {
+              set_error( p_fci_internal, FCIERR_BAD_COMPR_TYPE, ERROR_BAD_ARGUMENTS );
+              return FALSE;
+          }
+          if (!p_fci_internal->lzx || p_fci_internal->lzx->window_bits != window)
+          {
+              lzx_free( p_fci_internal, p_fci_internal->lzx );
+              if (!(p_fci_internal->lzx = lzx_create( p_fci_internal, window )))
+              {
+                  set_error( p_fci_internal, FCIERR_ALLOC_FAIL, ERROR_NOT_ENOUGH_MEMORY );
+                  return FALSE;
+              }
+          }
+          else lzx_reset( p_fci_internal->lzx );
+          p_fci_internal->compression = TCOMPfromLZXWindow( window );
+          p_fci_internal->compress    = compress_LZX;
+          break;
+      }
       default:
           FIXME( "compression %x not supported, defaulting to none\n", typeCompress );
           /* fall through */
@@ -1505,6 +2150,8 @@ BOOL __cdecl FCIAddFile(
 
   if (!add_file_data( p_fci_internal, pszSourceFile, pszFileName, fExecute, pfnfcigoi, pfnfcis ))
       return FALSE;
+  /* the size checks below need the complete blocks to be accounted for */
+  if (!flush_pending_blocks( p_fci_internal, pfnfcis )) return FALSE;
 
   /* REUSE the variable read_result */
   read_result = get_header_size( p_fci_internal ) + p_fci_internal->ccab.cbReserveCFFolder;
@@ -1724,6 +2371,10 @@ BOOL __cdecl FCIDestroy(HFCI hfci)
 
     close_temp_file( p_fci_internal, &p_fci_internal->data );
 
+    if (p_fci_internal->work) CloseThreadpoolWork( p_fci_internal->work );
+    lzx_free( p_fci_internal, p_fci_internal->lzx );
+    p_fci_internal->free( p_fci_internal->pending );
+
     /* hfci can now be removed */
     p_fci_internal->free(hfci);
     return TRUE;
@@ -935,6 +935,243 @@ static void test_FDICopy(void)
 }
 
 
+static INT_PTR CDECL roundtrip_notify(FDINOTIFICATIONTYPE fdint, FDINOTIFICATION *info)
+{
+    HANDLE handle;
+
+    switch (fdint)
+    {
+    case fdintCOPY_FILE:
+        ok(!strcmp(info->psz1, "large.dat"), "got %s\n", info->psz1);
+        handle = CreateFileA("large.out", GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(handle != INVALID_HANDLE_VALUE, "failed to create large.out\n");
+        return (INT_PTR)handle;
+
+    case fdintCLOSE_FILE_INFO:
+        CloseHandle((HANDLE)info->hf);
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+static void test_compression_roundtrip(void)
+{
+    static const TCOMP types[] =
+    {
+        tcompTYPE_NONE,
+        tcompTYPE_MSZIP,
+        TCOMPfromLZXWindow(15),
+        TCOMPfromLZXWindow(21),
+    };
+    static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+    static char large_dat[] = "large.dat";
+    static char extract_cab[] = "extract.cab";
+    const DWORD size = 300000 + 12345;
+    char path[MAX_PATH], dir[MAX_PATH], *data, *out;
+    CCAB cabParams;
+    unsigned int i, j, seed = 0x1234;
+    DWORD written, read;
+    HANDLE handle;
+    HFCI hfci;
+    HFDI hfdi;
+    ERF erf;
+    BOOL ret;
+
+    /* repeated text with some noise, followed by incompressible data */
+    data = HeapAlloc(GetProcessHeap(), 0, size);
+    out = HeapAlloc(GetProcessHeap(), 0, size);
+    for (i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        if (i < size / 2) data[i] = text[i % (sizeof(text) - 1)] ^ ((seed >> 16) % 64 ? 0 : 0x20);
+        else data[i] = seed >> 16;
+    }
+
+    handle = CreateFileA(large_dat, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    ok(handle != INVALID_HANDLE_VALUE, "failed to create %s\n", large_dat);
+    WriteFile(handle, data, size, &written, NULL);
+    CloseHandle(handle);
+
+    lstrcpyA(dir, CURR_DIR);
+    lstrcatA(dir, "\\");
+    lstrcpyA(path, dir);
+    lstrcatA(path, large_dat);
+
+    for (i = 0; i < ARRAY_SIZE(types); i++)
+    {
+        winetest_push_context("type %#x", types[i]);
+
+        set_cab_parameters(&cabParams);
+        hfci = FCICreate(&erf, file_placed, mem_alloc, mem_free, fci_open,
+                         fci_read, fci_write, fci_close, fci_seek,
+                         fci_delete, get_temp_file, &cabParams, NULL);
+        ok(hfci != NULL, "Failed to create an FCI context\n");
+
+        /* two folders, to check that the compressor state is reset between them */
+        for (j = 0; j < 2; j++)
+        {
+            ret = FCIAddFile(hfci, path, large_dat, FALSE, get_next_cabinet, progress,
+                             get_open_info, types[i]);
+            ok(ret, "FCIAddFile failed\n");
+            ret = FCIFlushFolder(hfci, get_next_cabinet, progress);
+            ok(ret, "FCIFlushFolder failed\n");
+        }
+        ret = FCIFlushCabinet(hfci, FALSE, get_next_cabinet, progress);
+        ok(ret, "Failed to flush the cabinet\n");
+        FCIDestroy(hfci);
+
+        hfdi = FDICreate(fdi_alloc, fdi_free, fdi_open, fdi_read, fdi_write, fdi_close, fdi_seek,
+                         cpuUNKNOWN, &erf);
+        ok(hfdi != NULL, "FDICreate error %d\n", erf.erfOper);
+
+        ret = FDICopy(hfdi, extract_cab, dir, 0, roundtrip_notify, NULL, 0);
+        ok(ret, "FDICopy error %d\n", erf.erfOper);
+        FDIDestroy(hfdi);
+
+        handle = CreateFileA("large.out", GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+        ok(handle != INVALID_HANDLE_VALUE, "failed to open large.out\n");
+        memset(out, 0, size);
+        ReadFile(handle, out, size, &read, NULL);
+        CloseHandle(handle);
+        ok(read == size, "got size %lu\n", read);
+        ok(!memcmp(out, data, size), "data doesn't match\n");
+
+        DeleteFileA("large.out");
+        DeleteFileA(extract_cab);
+        winetest_pop_context();
+    }
+
+    DeleteFileA(large_dat);
+    HeapFree(GetProcessHeap(), 0, out);
+    HeapFree(GetProcessHeap(), 0, data);
+}
+
+
+static INT_PTR CDECL roundtrip_files_notify(FDINOTIFICATIONTYPE fdint, FDINOTIFICATION *info)
+{
+    char name[MAX_PATH];
+    HANDLE handle;
+
+    switch (fdint)
+    {
+    case fdintCOPY_FILE:
+        sprintf(name, "%s.out", info->psz1);
+        handle = CreateFileA(name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(handle != INVALID_HANDLE_VALUE, "failed to create %s\n", name);
+        return (INT_PTR)handle;
+
+    case fdintCLOSE_FILE_INFO:
+        CloseHandle((HANDLE)info->hf);
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+static void test_compression_roundtrip_files(void)
+{
+    static const TCOMP types[] =
+    {
+        tcompTYPE_NONE,
+        tcompTYPE_MSZIP,
+        TCOMPfromLZXWindow(15),
+        TCOMPfromLZXWindow(21),
+    };
+    /* sizes not multiple of the block size, so that the data blocks span files */
+    static const DWORD sizes[] = { 49152, 100, 104857, 0, 1, 70000, 300000 + 12345 };
+    static char extract_cab[] = "extract.cab";
+    char path[MAX_PATH], dir[MAX_PATH], name[MAX_PATH], *data[ARRAY_SIZE(sizes)], *out;
+    unsigned int i, j, seed = 0x4321;
+    DWORD written, read;
+    CCAB cabParams;
+    HANDLE handle;
+    HFCI hfci;
+    HFDI hfdi;
+    ERF erf;
+    BOOL ret;
+
+    lstrcpyA(dir, CURR_DIR);
+    lstrcatA(dir, "\\");
+
+    out = HeapAlloc(GetProcessHeap(), 0, sizes[ARRAY_SIZE(sizes) - 1]);
+    for (i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        data[i] = HeapAlloc(GetProcessHeap(), 0, sizes[i] + 1);
+        for (j = 0; j < sizes[i]; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            data[i][j] = j % 3000 < 1500 ? 'a' + j % 13 + i : seed >> 16;
+        }
+
+        sprintf(name, "file%u.dat", i);
+        handle = CreateFileA(name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(handle != INVALID_HANDLE_VALUE, "failed to create %s\n", name);
+        WriteFile(handle, data[i], sizes[i], &written, NULL);
+        CloseHandle(handle);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(types); i++)
+    {
+        winetest_push_context("type %#x", types[i]);
+
+        set_cab_parameters(&cabParams);
+        hfci = FCICreate(&erf, file_placed, mem_alloc, mem_free, fci_open,
+                         fci_read, fci_write, fci_close, fci_seek,
+                         fci_delete, get_temp_file, &cabParams, NULL);
+        ok(hfci != NULL, "Failed to create an FCI context\n");
+
+        /* all the files go to the same folder */
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            sprintf(name, "file%u.dat", j);
+            lstrcpyA(path, dir);
+            lstrcatA(path, name);
+            ret = FCIAddFile(hfci, path, name, FALSE, get_next_cabinet, progress,
+                             get_open_info, types[i]);
+            ok(ret, "FCIAddFile failed\n");
+        }
+        ret = FCIFlushCabinet(hfci, FALSE, get_next_cabinet, progress);
+        ok(ret, "Failed to flush the cabinet\n");
+        FCIDestroy(hfci);
+
+        hfdi = FDICreate(fdi_alloc, fdi_free, fdi_open, fdi_read, fdi_write, fdi_close, fdi_seek,
+                         cpuUNKNOWN, &erf);
+        ok(hfdi != NULL, "FDICreate error %d\n", erf.erfOper);
+
+        ret = FDICopy(hfdi, extract_cab, dir, 0, roundtrip_files_notify, NULL, 0);
+        ok(ret, "FDICopy error %d\n", erf.erfOper);
+        FDIDestroy(hfdi);
+
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            sprintf(name, "file%u.dat.out", j);
+            handle = CreateFileA(name, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+            ok(handle != INVALID_HANDLE_VALUE, "failed to open %s\n", name);
+            read = 0;
+            ReadFile(handle, out, sizes[j], &read, NULL);
+            CloseHandle(handle);
+            ok(read == sizes[j], "%u: got size %lu\n", j, read);
+            ok(!memcmp(out, data[j], sizes[j]), "%u: data doesn't match\n", j);
+            DeleteFileA(name);
+        }
+
+        DeleteFileA(extract_cab);
+        winetest_pop_context();
+    }
+
+    for (i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        sprintf(name, "file%u.dat", i);
+        DeleteFileA(name);
+        HeapFree(GetProcessHeap(), 0, data[i]);
+    }
+    HeapFree(GetProcessHeap(), 0, out);
+}
+
+
 START_TEST(fdi)
 {
     int len;
@@ -947,4 +1184,6 @@ START_TEST(fdi)
     test_FDIDestroy();
     test_FDIIsCabinet();
     test_FDICopy();
+    test_compression_roundtrip();
+    test_compression_roundtrip_files();
 }
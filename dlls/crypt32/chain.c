@@ -35,6 +35,21 @@ WINE_DECLARE_DEBUG_CHANNEL(chain);
 
 #define DEFAULT_CYCLE_MODULUS 7
 
+/* Results of signature checks done while building chains.  An entry is keyed
+ * by the full encoded subject and issuer certificates, so a matching entry
+ * is always valid and never needs to be invalidated.
+ */
+#define SIGNATURE_CACHE_SIZE 64
+
+struct signature_cache_entry
+{
+    BYTE *subject;
+    DWORD subject_len;
+    BYTE *issuer;
+    DWORD issuer_len;
+    BOOL  valid;
+};
+
 /* This represents a subset of a certificate chain engine:  it doesn't include
  * the "hOther" store described by MSDN, because I'm not sure how that's used.
  * It also doesn't include the "hTrust" store, because I don't yet implement
@@ -49,6 +64,9 @@ typedef struct _CertificateChainEngine
     DWORD      dwUrlRetrievalTimeout;
     DWORD      MaximumCachedCertificates;
     DWORD      CycleDetectionModulus;
+    CRITICAL_SECTION cs;
+    struct signature_cache_entry signatures[SIGNATURE_CACHE_SIZE];
+    DWORD      next_signature;
 } CertificateChainEngine;
 
 static inline void CRYPT_AddStoresToCollection(HCERTSTORE collection,
@@ -134,6 +152,7 @@ HCERTCHAINENGINE CRYPT_CreateChainEngine(HCERTSTORE root, DWORD system_store, co
         return NULL;
     }
 
+    memset(engine, 0, sizeof(*engine));
     engine->ref = 1;
     engine->hRoot = root;
     engine->hWorld = CertOpenStore(CERT_STORE_PROV_COLLECTION, 0, 0, CERT_STORE_CREATE_NEW_FLAG, NULL);
@@ -154,6 +173,9 @@ HCERTCHAINENGINE CRYPT_CreateChainEngine(HCERTSTORE root, DWORD system_store, co
     else
         engine->CycleDetectionModulus = DEFAULT_CYCLE_MODULUS;
 
+    InitializeCriticalSectionEx(&engine->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+    engine->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": CertificateChainEngine.cs");
+
     return engine;
 }
 
@@ -196,9 +218,17 @@ static CertificateChainEngine *get_chain_engine(HCERTCHAINENGINE handle, BOOL al
 
 static void free_chain_engine(CertificateChainEngine *engine)
 {
+    DWORD i;
+
     if(!engine || InterlockedDecrement(&engine->ref))
         return;
 
+    for(i = 0; i < SIGNATURE_CACHE_SIZE; i++) {
+        CryptMemFree(engine->signatures[i].subject);
+        CryptMemFree(engine->signatures[i].issuer);
+    }
+    engine->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&engine->cs);
     CertCloseStore(engine->hWorld, 0);
     CertCloseStore(engine->hRoot, 0);
     CryptMemFree(engine);
@@ -1869,6 +1899,83 @@ static BOOL CRYPT_IsCertVersionValid(PCCERT_CONTEXT cert)
     return ret;
 }
 
+static BOOL signature_cache_lookup(CertificateChainEngine *engine,
+ PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer, BOOL *valid)
+{
+    BOOL found = FALSE;
+    DWORD i;
+
+    EnterCriticalSection(&engine->cs);
+    for (i = 0; i < SIGNATURE_CACHE_SIZE; i++)
+    {
+        const struct signature_cache_entry *entry = &engine->signatures[i];
+
+        if (entry->subject_len == subject->cbCertEncoded &&
+         entry->issuer_len == issuer->cbCertEncoded &&
+         !memcmp(entry->subject, subject->pbCertEncoded, entry->subject_len) &&
+         !memcmp(entry->issuer, issuer->pbCertEncoded, entry->issuer_len))
+        {
+            *valid = entry->valid;
+            found = TRUE;
+            break;
+        }
+    }
+    LeaveCriticalSection(&engine->cs);
+    return found;
+}
+
+static void signature_cache_add(CertificateChainEngine *engine,
+ PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer, BOOL valid)
+{
+    struct signature_cache_entry *entry;
+    BYTE *subject_copy, *issuer_copy;
+
+    subject_copy = CryptMemAlloc(subject->cbCertEncoded);
+    issuer_copy = CryptMemAlloc(issuer->cbCertEncoded);
+    if (!subject_copy || !issuer_copy)
+    {
+        CryptMemFree(subject_copy);
+        CryptMemFree(issuer_copy);
+        return;
+    }
+    memcpy(subject_copy, subject->pbCertEncoded, subject->cbCertEncoded);
+    memcpy(issuer_copy, issuer->pbCertEncoded, issuer->cbCertEncoded);
+
+    EnterCriticalSection(&engine->cs);
+    entry = &engine->signatures[engine->next_signature++ % SIGNATURE_CACHE_SIZE];
+    CryptMemFree(entry->subject);
+    CryptMemFree(entry->issuer);
+    entry->subject = subject_copy;
+    entry->subject_len = subject->cbCertEncoded;
+    entry->issuer = issuer_copy;
+    entry->issuer_len = issuer->cbCertEncoded;
+    entry->valid = valid;
+    LeaveCriticalSection(&engine->cs);
+}
+
+/* Verifies the signature of subject using issuer's public key, remembering
+ * the result so rebuilding the same chain doesn't verify it again.  Failures
+ * other than a bad signature (e.g. out of memory or a provider error) may
+ * not happen next time, so they aren't remembered.
+ */
+static BOOL CRYPT_VerifyIssuerSignature(CertificateChainEngine *engine,
+ PCCERT_CONTEXT subject, PCCERT_CONTEXT issuer)
+{
+    BOOL valid;
+
+    if (signature_cache_lookup(engine, subject, issuer, &valid))
+    {
+        TRACE_(chain)("using cached signature result %d\n", valid);
+        return valid;
+    }
+    valid = CryptVerifyCertificateSignatureEx(0, X509_ASN_ENCODING,
+     CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT, (void *)subject,
+     CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT, (void *)issuer, 0, NULL);
+    if (valid || GetLastError() == NTE_BAD_SIGNATURE)
+        signature_cache_add(engine, subject, issuer, valid);
+    return valid;
+}
+
 static void CRYPT_CheckSimpleChain(CertificateChainEngine *engine,
  PCERT_SIMPLE_CHAIN chain, LPFILETIME time)
 {
@@ -1906,11 +2013,9 @@ static void CRYPT_CheckSimpleChain(CertificateChainEngine *engine,
         if (i != 0)
         {
             /* Check the signature of the cert this issued */
-            if (!CryptVerifyCertificateSignatureEx(0, X509_ASN_ENCODING,
-             CRYPT_VERIFY_CERT_SIGN_SUBJECT_CERT,
-             (void *)chain->rgpElement[i - 1]->pCertContext,
-             CRYPT_VERIFY_CERT_SIGN_ISSUER_CERT,
-             (void *)chain->rgpElement[i]->pCertContext, 0, NULL))
+            if (!CRYPT_VerifyIssuerSignature(engine,
+             chain->rgpElement[i - 1]->pCertContext,
+             chain->rgpElement[i]->pCertContext))
                 chain->rgpElement[i - 1]->TrustStatus.dwErrorStatus |=
                  CERT_TRUST_IS_NOT_SIGNATURE_VALID;
             /* Once a path length constraint has been violated, every remaining
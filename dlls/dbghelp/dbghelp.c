@@ -701,7 +701,7 @@ BOOL WINAPI SymSetScopeFromAddr(HANDLE hProcess, ULONG64 addr)
 
     TRACE("(%p %#I64x)\n", hProcess, addr);
 
-    if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
     pair.pcs->localscope_pc = addr;
     if ((sym = symt_find_symbol_at(pair.effective, addr)) != NULL && sym->symt.tag == SymTagFunction)
         pair.pcs->localscope_symt = &sym->symt;
@@ -721,7 +721,7 @@ BOOL WINAPI SymSetScopeFromIndex(HANDLE hProcess, ULONG64 addr, DWORD index)
 
     TRACE("(%p %#I64x %lu)\n", hProcess, addr, index);
 
-    if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
     sym = symt_index2ptr(pair.effective, index);
     if (!symt_check_tag(sym, SymTagFunction)) return FALSE;
 
@@ -744,7 +744,7 @@ BOOL WINAPI SymSetScopeFromInlineContext(HANDLE hProcess, ULONG64 addr, DWORD in
     switch (IFC_MODE(inlinectx))
     {
     case IFC_MODE_INLINE:
-        if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+        if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
         inlined = symt_find_inlined_site(pair.effective, addr, inlinectx);
         if (inlined)
         {
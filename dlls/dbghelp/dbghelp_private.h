@@ -176,6 +176,13 @@ struct symt_ht
     struct hash_table_elt       hash_elt;        /* if global symbol or type */
 };
 
+/* entry of a module's address sorted symbol table */
+struct symt_addr_entry
+{
+    ULONG64                     addr;            /* cached address, valid once sorted */
+    struct symt_ht*             symt;
+};
+
 static inline BOOL symt_check_tag(const struct symt* s, enum SymTagEnum tag)
 {
     return s && s->tag == tag;
@@ -421,6 +428,9 @@ struct module_format
                                                const struct module_format* modfmt,
                                                const struct symt_function* func,
                                                struct location* loc);
+    /* loads the debug information left out when the module was loaded: only
+     * what covers addr, or all of it when all is set */
+    void                        (*load_deferred)(struct module_format* modfmt, DWORD64 addr, BOOL all);
     union
     {
         struct elf_module_info*         elf_info;
@@ -463,7 +473,7 @@ struct module
     unsigned                    num_sorttab;    /* number of symbols with addresses */
     unsigned                    num_symbols;
     unsigned                    sorttab_size;
-    struct symt_ht**            addr_sorttab;
+    struct symt_addr_entry*     addr_sorttab;
     struct hash_table           ht_symbols;
     struct symt_module*         top;
 
@@ -717,6 +727,8 @@ extern const struct loader_ops empty_loader_ops;
 
 extern BOOL         module_init_pair(struct module_pair* pair, HANDLE hProcess,
                                      DWORD64 addr);
+extern BOOL         module_init_pair_at(struct module_pair* pair, HANDLE hProcess,
+                                        DWORD64 addr);
 extern struct module*
                     module_find_by_addr(const struct process* pcs, DWORD64 addr);
 extern struct module*
@@ -729,6 +741,7 @@ extern struct module*
                     module_is_already_loaded(const struct process* pcs,
                                              const WCHAR* imgname);
 extern BOOL         module_get_debug(struct module_pair*);
+extern BOOL         module_get_debug_at(struct module_pair*, DWORD64 addr);
 extern struct module*
                     module_new(struct process* pcs, const WCHAR* name,
                                enum dhext_module_type type, BOOL builtin, BOOL virtual,
@@ -214,11 +214,31 @@ typedef struct dwarf2_parse_context_s
     unsigned                    language;
 } dwarf2_parse_context_t;
 
+/* address range from .debug_aranges, and the unit covering it */
+struct dwarf2_arange
+{
+    ULONG_PTR                   low;
+    ULONG_PTR                   high;
+    ULONG_PTR                   max_high;  /* highest 'high' of this and all previous ranges */
+    unsigned                    unit;      /* index in unit_contexts */
+};
+
+/* the compilation units of a module, and the sections they're parsed from */
+typedef struct dwarf2_units_s
+{
+    dwarf2_section_t            sections[section_max];
+    struct image_section_map    sectmap[section_max];
+    dwarf2_parse_module_context_t module_ctx;
+    struct dwarf2_arange*       aranges;   /* sorted by low address */
+    unsigned                    num_aranges;
+} dwarf2_units_t;
+
 /* stored in the dbghelp's module internal structure for later reuse */
 struct dwarf2_module_info_s
 {
     dwarf2_cuhead_t**           cuheads;
     unsigned                    num_cuheads;
+    dwarf2_units_t*             units;     /* when some units haven't been loaded yet */
     dwarf2_section_t            debug_loc;
     dwarf2_section_t            debug_frame;
     dwarf2_section_t            eh_frame;
@@ -2885,6 +2905,7 @@ static BOOL dwarf2_parse_compilation_unit_head(dwarf2_parse_context_t* ctx,
     ctx->head.version = dwarf2_parse_u2(&ctx->traverse_DIE);
     cu_abbrev_offset = dwarf2_parse_offset(&ctx->traverse_DIE, ctx->head.offset_size);
     ctx->head.word_size = dwarf2_parse_byte(&ctx->traverse_DIE);
+    ctx->ref_offset = comp_unit_start - ctx->module_ctx->sections[section_debug].address;
     ctx->status = UNIT_ERROR;
 
     TRACE("Compilation Unit Header found at 0x%x:\n",
@@ -2913,7 +2934,6 @@ static BOOL dwarf2_parse_compilation_unit_head(dwarf2_parse_context_t* ctx,
 
     pool_init(&ctx->pool, 65536);
     ctx->section = section_debug;
-    ctx->ref_offset = comp_unit_start - ctx->module_ctx->sections[section_debug].address;
     ctx->cpp_name = NULL;
     ctx->status = UNIT_NOTLOADED;
 
@@ -3859,7 +3879,7 @@ BOOL dwarf2_virtual_unwind(struct cpu_stack_walk *csw, ULONG_PTR ip,
     struct module_pair pair;
     struct frame_info info;
 
-    if (!module_init_pair(&pair, csw->hProcess, ip)) return FALSE;
+    if (!module_init_pair_at(&pair, csw->hProcess, ip)) return FALSE;
     if (csw->cpu != pair.effective->cpu) FIXME("mismatch in cpu\n");
     if (!dwarf2_fetch_frame_info(pair.effective, csw->cpu, ip, &info)) return FALSE;
 
@@ -4095,8 +4115,12 @@ static inline void dwarf2_fini_section(dwarf2_section_t* section)
         HeapFree(GetProcessHeap(), 0, (void*)section->address);
 }
 
+static void dwarf2_free_units(dwarf2_units_t* units, BOOL unmap);
+
 static void dwarf2_module_remove(struct process* pcs, struct module_format* modfmt)
 {
+    /* the image file has already been unmapped */
+    if (modfmt->u.dwarf2_info->units) dwarf2_free_units(modfmt->u.dwarf2_info->units, FALSE);
     dwarf2_fini_section(&modfmt->u.dwarf2_info->debug_loc);
     dwarf2_fini_section(&modfmt->u.dwarf2_info->debug_frame);
     free(modfmt->u.dwarf2_info->cuheads);
@@ -4105,7 +4129,7 @@ static void dwarf2_module_remove(struct process* pcs, struct module_format* modf
 
 static BOOL dwarf2_load_CU_module(dwarf2_parse_module_context_t* module_ctx, struct module* module,
                                   dwarf2_section_t* sections, ULONG_PTR load_offset,
-                                  const struct elf_thunk_area* thunks, BOOL is_dwz)
+                                  const struct elf_thunk_area* thunks, BOOL defer)
 {
     dwarf2_traverse_context_t   mod_ctx;
     unsigned i;
@@ -4131,9 +4155,11 @@ static BOOL dwarf2_load_CU_module(dwarf2_parse_module_context_t* module_ctx, str
     /* phase2: load content of all CU
      * If this is a DWZ alternate module, don't load all debug_info at once
      * wait for main module to ask for them (it's likely it won't need them all)
+     * The main module can also defer loading the CU until an address they cover
+     * is looked up (see dwarf2_parse).
      * Doing this can lead to a huge performance improvement.
      */
-    if (!is_dwz)
+    if (!defer)
         for (i = 0; i < module_ctx->unit_contexts.num_elts; ++i)
             dwarf2_parse_compilation_unit((dwarf2_parse_context_t*)vector_at(&module_ctx->unit_contexts, i));
 
@@ -4197,25 +4223,169 @@ static BOOL dwarf2_unload_CU_module(dwarf2_parse_module_context_t* module_ctx)
     return TRUE;
 }
 
+static void dwarf2_free_units(dwarf2_units_t* units, BOOL unmap)
+{
+    unsigned i;
+
+    dwarf2_unload_CU_module(&units->module_ctx);
+    for (i = 0; i < section_max; i++)
+    {
+        dwarf2_fini_section(&units->sections[i]);
+        if (unmap) image_unmap_section(&units->sectmap[i]);
+    }
+    free(units->aranges);
+    HeapFree(GetProcessHeap(), 0, units);
+}
+
+static int __cdecl dwarf2_arange_cmp(const void* p1, const void* p2)
+{
+    const struct dwarf2_arange* a1 = p1;
+    const struct dwarf2_arange* a2 = p2;
+
+    if (a1->low == a2->low) return 0;
+    return a1->low < a2->low ? -1 : 1;
+}
+
+/* units are stored in .debug_info order, look for the one starting at offset */
+static BOOL dwarf2_find_unit(const dwarf2_parse_module_context_t* module_ctx, ULONG_PTR offset, unsigned* idx)
+{
+    unsigned low = 0, high = module_ctx->unit_contexts.num_elts, mid;
+    dwarf2_parse_context_t* ctx;
+
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        ctx = vector_at(&module_ctx->unit_contexts, mid);
+        if (ctx->ref_offset == offset)
+        {
+            *idx = mid;
+            return ctx->status != UNIT_ERROR;
+        }
+        if (ctx->ref_offset < offset) low = mid + 1;
+        else high = mid;
+    }
+    return FALSE;
+}
+
+static BOOL dwarf2_parse_aranges(dwarf2_units_t* units, const dwarf2_section_t* section)
+{
+    dwarf2_traverse_context_t   ctx, set_ctx;
+    const unsigned char*        set_start;
+    struct dwarf2_arange*       new;
+    unsigned char               offset_size, word_size;
+    ULONG_PTR                   length, low, size, max_high = 0;
+    unsigned                    unit, alloc = 0, i;
+    BOOL                        has_unit;
+
+    ctx.data = section->address;
+    ctx.end_data = ctx.data + section->size;
+    while (ctx.data < ctx.end_data)
+    {
+        set_start = ctx.data;
+        length = dwarf2_parse_3264(&ctx, &offset_size);
+        set_ctx.data = ctx.data;
+        set_ctx.end_data = ctx.data + length;
+        ctx.data = set_ctx.end_data;
+        if (set_ctx.end_data > ctx.end_data || dwarf2_parse_u2(&set_ctx) != 2) return FALSE;
+        has_unit = dwarf2_find_unit(&units->module_ctx, dwarf2_parse_offset(&set_ctx, offset_size), &unit);
+        word_size = dwarf2_parse_byte(&set_ctx);
+        /* no segment selector */
+        if ((word_size != 4 && word_size != 8) || dwarf2_parse_byte(&set_ctx)) return FALSE;
+
+        /* tuples are aligned on their size from the start of the set */
+        set_ctx.data = set_start + ((set_ctx.data - set_start + 2 * word_size - 1) & ~(2 * word_size - 1));
+        while (set_ctx.data + 2 * word_size <= set_ctx.end_data)
+        {
+            low = dwarf2_parse_addr(&set_ctx, word_size);
+            size = dwarf2_parse_addr(&set_ctx, word_size);
+            if (!low && !size) break;
+            if (!has_unit || !size) continue;
+            if (units->num_aranges == alloc)
+            {
+                alloc = max(alloc * 2, 64);
+                if (!(new = realloc(units->aranges, alloc * sizeof(*new)))) return FALSE;
+                units->aranges = new;
+            }
+            units->aranges[units->num_aranges].low = low;
+            units->aranges[units->num_aranges].high = low + size;
+            units->aranges[units->num_aranges++].unit = unit;
+        }
+    }
+    qsort(units->aranges, units->num_aranges, sizeof(*units->aranges), dwarf2_arange_cmp);
+    for (i = 0; i < units->num_aranges; i++)
+    {
+        max_high = max(max_high, units->aranges[i].high);
+        units->aranges[i].max_high = max_high;
+    }
+    TRACE("%u ranges for %u units\n", units->num_aranges, units->module_ctx.unit_contexts.num_elts);
+    return units->num_aranges != 0;
+}
+
+/* load the units covering addr (relative to the module's load offset) */
+static void dwarf2_load_units_at(dwarf2_units_t* units, ULONG_PTR addr)
+{
+    unsigned low = 0, high = units->num_aranges, mid;
+
+    /* find the first range starting after addr, and look at the previous ones */
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (units->aranges[mid].low <= addr) low = mid + 1;
+        else high = mid;
+    }
+    while (low-- > 0 && units->aranges[low].max_high > addr)
+    {
+        if (addr < units->aranges[low].high)
+            dwarf2_parse_compilation_unit(vector_at(&units->module_ctx.unit_contexts, units->aranges[low].unit));
+    }
+}
+
+static void dwarf2_load_deferred(struct module_format* modfmt, DWORD64 addr, BOOL all)
+{
+    dwarf2_units_t* units = modfmt->u.dwarf2_info->units;
+    unsigned i;
+
+    if (!units) return;
+    if (all)
+    {
+        TRACE("loading all remaining units for %s\n", debugstr_w(modfmt->module->modulename));
+        for (i = 0; i < units->module_ctx.unit_contexts.num_elts; ++i)
+            dwarf2_parse_compilation_unit(vector_at(&units->module_ctx.unit_contexts, i));
+        modfmt->u.dwarf2_info->units = NULL;
+        dwarf2_free_units(units, TRUE);
+    }
+    else dwarf2_load_units_at(units, addr - units->module_ctx.load_offset);
+}
+
 BOOL dwarf2_parse(struct module* module, ULONG_PTR load_offset,
                   const struct elf_thunk_area* thunks,
                   struct image_file_map* fmap)
 {
-    dwarf2_section_t    eh_frame, section[section_max];
-    struct image_section_map    debug_sect, debug_str_sect, debug_abbrev_sect,
-                                debug_line_sect, debug_ranges_sect, eh_frame_sect;
-    BOOL                ret = TRUE;
+    dwarf2_section_t    eh_frame, aranges;
+    struct image_section_map    eh_frame_sect, aranges_sect;
+    BOOL                ret = TRUE, deferred = FALSE;
     struct module_format* dwarf2_modfmt;
-    dwarf2_parse_module_context_t module_ctx;
+    dwarf2_units_t*     units;
+    dwarf2_section_t*   section;
+    dwarf2_parse_context_t* unit_ctx;
+    BYTE*               covered;
+    unsigned            i;
+
+    if (!(units = HeapAlloc(GetProcessHeap(), 0, sizeof(*units)))) return FALSE;
+    section = units->sections;
+    vector_init(&units->module_ctx.unit_contexts, sizeof(dwarf2_parse_context_t), 16);
+    units->module_ctx.dwz = NULL;
+    units->aranges = NULL;
+    units->num_aranges = 0;
 
     if (!dwarf2_init_section(&eh_frame,                fmap, ".eh_frame",     NULL,             &eh_frame_sect))
         /* lld produces .eh_fram to avoid generating a long name */
         dwarf2_init_section(&eh_frame,                fmap, ".eh_fram",      NULL,             &eh_frame_sect);
-    dwarf2_init_section(&section[section_debug],  fmap, ".debug_info",   ".zdebug_info",   &debug_sect);
-    dwarf2_init_section(&section[section_abbrev], fmap, ".debug_abbrev", ".zdebug_abbrev", &debug_abbrev_sect);
-    dwarf2_init_section(&section[section_string], fmap, ".debug_str",    ".zdebug_str",    &debug_str_sect);
-    dwarf2_init_section(&section[section_line],   fmap, ".debug_line",   ".zdebug_line",   &debug_line_sect);
-    dwarf2_init_section(&section[section_ranges], fmap, ".debug_ranges", ".zdebug_ranges", &debug_ranges_sect);
+    dwarf2_init_section(&section[section_debug],  fmap, ".debug_info",   ".zdebug_info",   &units->sectmap[section_debug]);
+    dwarf2_init_section(&section[section_abbrev], fmap, ".debug_abbrev", ".zdebug_abbrev", &units->sectmap[section_abbrev]);
+    dwarf2_init_section(&section[section_string], fmap, ".debug_str",    ".zdebug_str",    &units->sectmap[section_string]);
+    dwarf2_init_section(&section[section_line],   fmap, ".debug_line",   ".zdebug_line",   &units->sectmap[section_line]);
+    dwarf2_init_section(&section[section_ranges], fmap, ".debug_ranges", ".zdebug_ranges", &units->sectmap[section_ranges]);
 
     /* to do anything useful we need either .eh_frame or .debug_info */
     if ((!eh_frame.address || eh_frame.address == IMAGE_NO_MAP) &&
@@ -4225,13 +4395,13 @@ BOOL dwarf2_parse(struct module* module, ULONG_PTR load_offset,
         goto leave;
     }
 
-    if (fmap->modtype == DMT_ELF && debug_sect.fmap)
+    if (fmap->modtype == DMT_ELF && units->sectmap[section_debug].fmap)
     {
         /* debug info might have a different base address than .so file
          * when elf file is prelinked after splitting off debug info
          * adjust symbol base addresses accordingly
          */
-        load_offset += fmap->u.elf.elf_start - debug_sect.fmap->u.elf.elf_start;
+        load_offset += fmap->u.elf.elf_start - units->sectmap[section_debug].fmap->u.elf.elf_start;
     }
 
     TRACE("Loading Dwarf2 information for %s\n", debugstr_w(module->modulename));
@@ -4246,6 +4416,7 @@ BOOL dwarf2_parse(struct module* module, ULONG_PTR load_offset,
     dwarf2_modfmt->module = module;
     dwarf2_modfmt->remove = dwarf2_module_remove;
     dwarf2_modfmt->loc_compute = dwarf2_location_compute;
+    dwarf2_modfmt->load_deferred = dwarf2_load_deferred;
     dwarf2_modfmt->u.dwarf2_info = (struct dwarf2_module_info_s*)(dwarf2_modfmt + 1);
     dwarf2_modfmt->u.dwarf2_info->word_size = fmap->addr_size / 8; /* set the word_size for eh_frame parsing */
     dwarf2_modfmt->module->format_info[DFI_DWARF] = dwarf2_modfmt;
@@ -4258,14 +4429,45 @@ BOOL dwarf2_parse(struct module* module, ULONG_PTR load_offset,
     dwarf2_modfmt->u.dwarf2_info->eh_frame = eh_frame;
     dwarf2_modfmt->u.dwarf2_info->cuheads = NULL;
     dwarf2_modfmt->u.dwarf2_info->num_cuheads = 0;
+    dwarf2_modfmt->u.dwarf2_info->units = NULL;
 
-    module_ctx.dwz = dwarf2_load_dwz(fmap, module);
-    dwarf2_load_CU_module(&module_ctx, module, section, load_offset, thunks, FALSE);
+    units->module_ctx.dwz = dwarf2_load_dwz(fmap, module);
+    dwarf2_load_CU_module(&units->module_ctx, module, section, load_offset, thunks, TRUE);
+
+    /* Only load now the units which can't be found from an address. The others
+     * are loaded when an address they cover is looked up, or when anything else
+     * is requested from the module (see module_get_debug).
+     * This requires the sections to stay mapped, which is only the case for PE
+     * modules.
+     */
+    if (fmap->modtype == DMT_PE &&
+        dwarf2_init_section(&aranges, fmap, ".debug_aranges", ".zdebug_aranges", &aranges_sect))
+    {
+        if (dwarf2_parse_aranges(units, &aranges) &&
+            (covered = calloc(units->module_ctx.unit_contexts.num_elts, 1)))
+        {
+            for (i = 0; i < units->num_aranges; i++) covered[units->aranges[i].unit] = 1;
+            for (i = 0; i < units->module_ctx.unit_contexts.num_elts; i++)
+            {
+                unit_ctx = vector_at(&units->module_ctx.unit_contexts, i);
+                if (!covered[i]) dwarf2_parse_compilation_unit(unit_ctx);
+                else if (unit_ctx->status == UNIT_NOTLOADED) deferred = TRUE;
+            }
+            free(covered);
+        }
+        dwarf2_fini_section(&aranges);
+        image_unmap_section(&aranges_sect);
+    }
+    if (!deferred)
+    {
+        for (i = 0; i < units->module_ctx.unit_contexts.num_elts; i++)
+            dwarf2_parse_compilation_unit(vector_at(&units->module_ctx.unit_contexts, i));
+    }
 
-    if (module_ctx.cu_versions)
+    if (units->module_ctx.cu_versions)
     {
         dwarf2_modfmt->module->module.SymType = SymDia;
-        module->debug_format_bitmask |= module_ctx.cu_versions;
+        module->debug_format_bitmask |= units->module_ctx.cu_versions;
         /* FIXME: we could have a finer grain here */
         dwarf2_modfmt->module->module.GlobalSymbols = TRUE;
         dwarf2_modfmt->module->module.TypeInfo = TRUE;
@@ -4273,20 +4475,14 @@ BOOL dwarf2_parse(struct module* module, ULONG_PTR load_offset,
         dwarf2_modfmt->module->module.Publics = TRUE;
     }
 
-    dwarf2_unload_CU_module(&module_ctx);
+    if (deferred)
+    {
+        TRACE("deferring loading of units for %s\n", debugstr_w(module->modulename));
+        dwarf2_modfmt->u.dwarf2_info->units = units;
+        units = NULL;
+    }
 leave:
-
-    dwarf2_fini_section(&section[section_debug]);
-    dwarf2_fini_section(&section[section_abbrev]);
-    dwarf2_fini_section(&section[section_string]);
-    dwarf2_fini_section(&section[section_line]);
-    dwarf2_fini_section(&section[section_ranges]);
-
-    image_unmap_section(&debug_sect);
-    image_unmap_section(&debug_abbrev_sect);
-    image_unmap_section(&debug_str_sect);
-    image_unmap_section(&debug_line_sect);
-    image_unmap_section(&debug_ranges_sect);
+    if (units) dwarf2_free_units(units, TRUE);
     if (!ret) image_unmap_section(&eh_frame_sect);
 
     return ret;
@@ -1255,6 +1255,7 @@ static BOOL elf_load_file_from_fmap(struct process* pcs, const WCHAR* filename,
         modfmt->module      = elf_info->module;
         modfmt->remove      = elf_module_remove;
         modfmt->loc_compute = NULL;
+        modfmt->load_deferred = NULL;
         modfmt->u.elf_info  = elf_module_info;
 
         elf_module_info->elf_addr = load_offset;
@@ -1540,6 +1540,7 @@ static BOOL macho_load_file(struct process* pcs, const WCHAR* filename,
         modfmt->module       = macho_info->module;
         modfmt->remove       = macho_module_remove;
         modfmt->loc_compute  = NULL;
+        modfmt->load_deferred = NULL;
         modfmt->u.macho_info = macho_module_info;
 
         macho_module_info->load_addr = load_addr;
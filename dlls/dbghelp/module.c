@@ -224,6 +224,14 @@ BOOL module_init_pair(struct module_pair* pair, HANDLE hProcess, DWORD64 addr)
     return module_get_debug(pair);
 }
 
+/* same as module_init_pair, but only the debug information covering addr is needed */
+BOOL module_init_pair_at(struct module_pair* pair, HANDLE hProcess, DWORD64 addr)
+{
+    if (!(pair->pcs = process_find_by_handle(hProcess))) return FALSE;
+    pair->requested = module_find_by_addr(pair->pcs, addr);
+    return module_get_debug_at(pair, addr);
+}
+
 /***********************************************************************
  *	module_find_by_nameW
  *
@@ -364,13 +372,44 @@ BOOL module_load_debug(struct module* module)
  * - if the module has no debug info and has an ELF container, then return the ELF
  *   container (and also force the ELF container's debug info loading if deferred)
  */
+static void module_load_deferred(struct module* module, DWORD64 addr, BOOL all)
+{
+    struct module_format* modfmt;
+    int i;
+
+    for (i = 0; i < DFI_LAST; i++)
+    {
+        if ((modfmt = module->format_info[i]) && modfmt->load_deferred)
+            modfmt->load_deferred(modfmt, addr, all);
+    }
+}
+
 BOOL module_get_debug(struct module_pair* pair)
 {
     if (!pair->requested) return FALSE;
     /* for a PE builtin, always get info from container */
     if (!(pair->effective = module_get_container(pair->pcs, pair->requested)))
         pair->effective = pair->requested;
-    return module_load_debug(pair->effective);
+    if (!module_load_debug(pair->effective)) return FALSE;
+    module_load_deferred(pair->effective, 0, TRUE);
+    return TRUE;
+}
+
+/******************************************************************
+ *		module_get_debug_at
+ *
+ * same as module_get_debug, but debug information which loading has been
+ * deferred by the debug format is only loaded for the parts covering addr
+ * (this is enough for all the lookups by address)
+ */
+BOOL module_get_debug_at(struct module_pair* pair, DWORD64 addr)
+{
+    if (!pair->requested) return FALSE;
+    if (!(pair->effective = module_get_container(pair->pcs, pair->requested)))
+        pair->effective = pair->requested;
+    if (!module_load_debug(pair->effective)) return FALSE;
+    module_load_deferred(pair->effective, addr, FALSE);
+    return TRUE;
 }
 
 /***********************************************************************
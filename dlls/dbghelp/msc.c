@@ -3924,6 +3924,7 @@ static BOOL pdb_process_file(const struct process *pcs,
         modfmt->module      = msc_dbg->module;
         modfmt->remove      = pdb_module_remove;
         modfmt->loc_compute = pdb_location_compute;
+        modfmt->load_deferred = NULL;
         modfmt->u.pdb_info  = pdb_module_info;
 
         memset(cv_zmodules, 0, sizeof(cv_zmodules));
@@ -4276,7 +4277,7 @@ BOOL pdb_virtual_unwind(struct cpu_stack_walk *csw, DWORD_PTR ip,
     PDB_STRING_TABLE*           strbase;
     BOOL                        ret = TRUE;
 
-    if (!module_init_pair(&pair, csw->hProcess, ip)) return FALSE;
+    if (!module_init_pair_at(&pair, csw->hProcess, ip)) return FALSE;
     if (!pair.effective->format_info[DFI_PDB]) return FALSE;
     pdb_info = pair.effective->format_info[DFI_PDB]->u.pdb_info;
     TRACE("searching %Ix => %Ix\n", ip, ip - (DWORD_PTR)pair.effective->module.BaseOfImage);
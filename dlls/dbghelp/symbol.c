@@ -44,9 +44,15 @@ static inline int cmp_addr(ULONG64 a1, ULONG64 a2)
 
 static inline int cmp_sorttab_addr(struct module* module, int idx, ULONG64 addr)
 {
-    ULONG64     ref;
-    symt_get_address(&module->addr_sorttab[idx]->symt, &ref);
-    return cmp_addr(ref, addr);
+    return cmp_addr(module->addr_sorttab[idx].addr, addr);
+}
+
+static int __cdecl cmp_sorttab_entry(const void* p1, const void* p2)
+{
+    const struct symt_addr_entry* e1 = p1;
+    const struct symt_addr_entry* e2 = p2;
+
+    return cmp_addr(e1->addr, e2->addr);
 }
 
 int __cdecl symt_cmp_addr(const void* p1, const void* p2)
@@ -127,7 +133,7 @@ struct symt*      symt_index2ptr(struct module* module, DWORD id)
 
 static BOOL symt_grow_sorttab(struct module* module, unsigned sz)
 {
-    struct symt_ht**    new;
+    struct symt_addr_entry* new;
     unsigned int size;
 
     if (sz <= module->sorttab_size) return TRUE;
@@ -135,12 +141,12 @@ static BOOL symt_grow_sorttab(struct module* module, unsigned sz)
     {
         size = module->sorttab_size * 2;
         new = HeapReAlloc(GetProcessHeap(), 0, module->addr_sorttab,
-                          size * sizeof(struct symt_ht*));
+                          size * sizeof(*new));
     }
     else
     {
         size = 64;
-        new = HeapAlloc(GetProcessHeap(), 0, size * sizeof(struct symt_ht*));
+        new = HeapAlloc(GetProcessHeap(), 0, size * sizeof(*new));
     }
     if (!new) return FALSE;
     module->sorttab_size = size;
@@ -158,7 +164,8 @@ static void symt_add_module_addr(struct module* module, struct symt_ht* ht)
     if (symt_get_address(&ht->symt, &addr) &&
         symt_grow_sorttab(module, module->num_symbols + 1))
     {
-        module->addr_sorttab[module->num_symbols++] = ht;
+        module->addr_sorttab[module->num_symbols].addr = addr;
+        module->addr_sorttab[module->num_symbols++].symt = ht;
         module->sortlist_valid = FALSE;
     }
 }
@@ -910,76 +917,61 @@ static BOOL symt_enum_module(struct module_pair* pair, const WCHAR* match,
     return FALSE;
 }
 
-static inline unsigned where_to_insert(struct module* module, unsigned high, const struct symt_ht* elt)
-{
-    unsigned    low = 0, mid = high / 2;
-    ULONG64     addr;
-
-    if (!high) return 0;
-    symt_get_address(&elt->symt, &addr);
-    do
-    {
-        switch (cmp_sorttab_addr(module, mid, addr))
-        {
-        case 0: return mid;
-        case -1: low = mid + 1; break;
-        case 1: high = mid; break;
-        }
-        mid = low + (high - low) / 2;
-    } while (low < high);
-    return mid;
-}
-
 /***********************************************************************
  *              resort_symbols
  *
  * Rebuild sorted list of symbols for a module.
+ * Symbols added since the last sort (for example by compilation units loaded
+ * on demand) are sorted on their own and merged into the sorted set.
  */
 static BOOL resort_symbols(struct module* module)
 {
-    int delta;
+    struct symt_addr_entry* tab = module->addr_sorttab;
+    struct symt_addr_entry* tmp;
+    int sorted = module->num_sorttab, delta, i, j, k;
 
     if (!(module->module.NumSyms = module->num_symbols))
         return FALSE;
 
-    /* we know that set from 0 up to num_sorttab is already sorted
-     * so sort the remaining (new) symbols, and merge the two sets
-     * (unless the first set is empty)
+    /* symbol addresses may have been adjusted since the last sort, so refresh
+     * the cached ones, and check that the previously sorted set still is
      */
-    delta = module->num_symbols - module->num_sorttab;
-    qsort(&module->addr_sorttab[module->num_sorttab], delta, sizeof(struct symt_ht*), symt_cmp_addr);
-    if (module->num_sorttab)
+    for (i = 0; i < module->num_symbols; i++)
+        symt_get_address(&tab[i].symt->symt, &tab[i].addr);
+    for (i = 1; i < sorted; i++)
     {
-        int     i, ins_idx = module->num_sorttab, prev_ins_idx;
-        static struct symt_ht** tmp;
-        static unsigned num_tmp;
+        if (tab[i - 1].addr > tab[i].addr)
+        {
+            sorted = 0;
+            break;
+        }
+    }
 
-        if (num_tmp < delta)
+    /* sort the remaining (new) symbols, and merge the two sets
+     * (unless the first set is empty)
+     */
+    delta = module->num_symbols - sorted;
+    if (!sorted)
+        qsort(tab, delta, sizeof(*tab), cmp_sorttab_entry);
+    else if (delta)
+    {
+        qsort(&tab[sorted], delta, sizeof(*tab), cmp_sorttab_entry);
+        if (tab[sorted - 1].addr > tab[sorted].addr)
         {
-            static struct symt_ht** new;
-            if (tmp)
-                new = HeapReAlloc(GetProcessHeap(), 0, tmp, delta * sizeof(struct symt_ht*));
+            if (!(tmp = HeapAlloc(GetProcessHeap(), 0, delta * sizeof(*tmp))))
+                qsort(tab, module->num_symbols, sizeof(*tab), cmp_sorttab_entry);
             else
-                new = HeapAlloc(GetProcessHeap(), 0, delta * sizeof(struct symt_ht*));
-            if (!new)
             {
-                module->num_sorttab = 0;
-                return resort_symbols(module);
+                memcpy(tmp, &tab[sorted], delta * sizeof(*tmp));
+                for (i = sorted - 1, j = delta - 1, k = module->num_symbols - 1; j >= 0; k--)
+                {
+                    if (i >= 0 && tab[i].addr > tmp[j].addr)
+                        tab[k] = tab[i--];
+                    else
+                        tab[k] = tmp[j--];
+                }
+                HeapFree(GetProcessHeap(), 0, tmp);
             }
-            tmp = new;
-            num_tmp = delta;
-        }
-        memcpy(tmp, &module->addr_sorttab[module->num_sorttab], delta * sizeof(struct symt_ht*));
-        qsort(tmp, delta, sizeof(struct symt_ht*), symt_cmp_addr);
-
-        for (i = delta - 1; i >= 0; i--)
-        {
-            prev_ins_idx = ins_idx;
-            ins_idx = where_to_insert(module, ins_idx, tmp[i]);
-            memmove(&module->addr_sorttab[ins_idx + i + 1],
-                    &module->addr_sorttab[ins_idx],
-                    (prev_ins_idx - ins_idx) * sizeof(struct symt_ht*));
-            module->addr_sorttab[ins_idx + i] = tmp[i];
         }
     }
     module->num_sorttab = module->num_symbols;
@@ -1003,23 +995,23 @@ static int symt_get_best_at(struct module* module, int idx_sorttab)
 {
     ULONG64 ref_addr;
     int idx_sorttab_orig = idx_sorttab;
-    if (module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol)
+    if (module->addr_sorttab[idx_sorttab].symt->symt.tag == SymTagPublicSymbol)
     {
-        symt_get_address(&module->addr_sorttab[idx_sorttab]->symt, &ref_addr);
+        ref_addr = module->addr_sorttab[idx_sorttab].addr;
         while (idx_sorttab > 0 &&
-               module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol &&
+               module->addr_sorttab[idx_sorttab].symt->symt.tag == SymTagPublicSymbol &&
                !cmp_sorttab_addr(module, idx_sorttab - 1, ref_addr))
             idx_sorttab--;
-        if (module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol)
+        if (module->addr_sorttab[idx_sorttab].symt->symt.tag == SymTagPublicSymbol)
         {
             idx_sorttab = idx_sorttab_orig;
             while (idx_sorttab < module->num_sorttab - 1 &&
-                   module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol &&
+                   module->addr_sorttab[idx_sorttab].symt->symt.tag == SymTagPublicSymbol &&
                    !cmp_sorttab_addr(module, idx_sorttab + 1, ref_addr))
                 idx_sorttab++;
         }
         /* if no better symbol was found restore the original */
-        if (module->addr_sorttab[idx_sorttab]->symt.tag == SymTagPublicSymbol)
+        if (module->addr_sorttab[idx_sorttab].symt->symt.tag == SymTagPublicSymbol)
             idx_sorttab = idx_sorttab_orig;
     }
     return idx_sorttab;
@@ -1042,13 +1034,12 @@ struct symt_ht* symt_find_nearest(struct module* module, DWORD_PTR addr)
     low = 0;
     high = module->num_sorttab;
 
-    symt_get_address(&module->addr_sorttab[0]->symt, &ref_addr);
-    if (addr < ref_addr) return NULL;
+    if (addr < module->addr_sorttab[0].addr) return NULL;
 
     if (high)
     {
-        symt_get_address(&module->addr_sorttab[high - 1]->symt, &ref_addr);
-        symt_get_length(module, &module->addr_sorttab[high - 1]->symt, &ref_size);
+        ref_addr = module->addr_sorttab[high - 1].addr;
+        symt_get_length(module, &module->addr_sorttab[high - 1].symt->symt, &ref_size);
         if (addr >= ref_addr + ref_size) return NULL;
     }
     
@@ -1069,7 +1060,7 @@ struct symt_ht* symt_find_nearest(struct module* module, DWORD_PTR addr)
      */
     low = symt_get_best_at(module, low);
 
-    return module->addr_sorttab[low];
+    return module->addr_sorttab[low].symt;
 }
 
 struct symt_ht* symt_find_symbol_at(struct module* module, DWORD_PTR addr)
@@ -1481,7 +1472,7 @@ BOOL WINAPI SymFromAddr(HANDLE hProcess, DWORD64 Address,
     struct module_pair  pair;
     struct symt_ht*     sym;
 
-    if (!module_init_pair(&pair, hProcess, Address)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, Address)) return FALSE;
     if ((sym = symt_find_symbol_at(pair.effective, Address)) == NULL) return FALSE;
 
     symt_fill_sym_info(&pair, NULL, &sym->symt, Symbol);
@@ -1909,7 +1900,7 @@ static BOOL get_line_from_addr(HANDLE hProcess, DWORD64 addr,
     struct module_pair          pair;
     struct symt_ht*             symt;
 
-    if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
     if ((symt = symt_find_symbol_at(pair.effective, addr)) == NULL) return FALSE;
 
     if (symt->symt.tag != SymTagFunction && symt->symt.tag != SymTagInlineSite) return FALSE;
@@ -2019,7 +2010,7 @@ static BOOL symt_get_func_line_prev(HANDLE hProcess, struct internal_line_t* int
     struct line_info*   li;
     struct line_info*   srcli;
 
-    if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
 
     if (key == NULL) return FALSE;
 
@@ -2098,7 +2089,7 @@ static BOOL symt_get_func_line_next(HANDLE hProcess, struct internal_line_t* int
     struct line_info*   srcli;
 
     if (key == NULL) return FALSE;
-    if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
 
     /* search current source file */
     for (srcli = key; !srcli->is_source_file; srcli--);
@@ -2685,7 +2676,7 @@ BOOL WINAPI SymFromInlineContext(HANDLE hProcess, DWORD64 addr, ULONG inline_ctx
     switch (IFC_MODE(inline_ctx))
     {
     case IFC_MODE_INLINE:
-        if (!module_init_pair(&pair, hProcess, addr)) return FALSE;
+        if (!module_init_pair_at(&pair, hProcess, addr)) return FALSE;
         inlined = symt_find_inlined_site(pair.effective, addr, inline_ctx);
         if (inlined)
         {
@@ -2735,7 +2726,8 @@ static BOOL get_line_from_inline_context(HANDLE hProcess, DWORD64 addr, ULONG in
     struct module_pair pair;
     struct symt_function* inlined;
 
-    if (!module_init_pair(&pair, hProcess, mod_addr ? mod_addr : addr)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, mod_addr ? mod_addr : addr)) return FALSE;
+    if (mod_addr) module_get_debug_at(&pair, addr);
     switch (IFC_MODE(inline_ctx))
     {
     case IFC_MODE_INLINE:
@@ -2802,7 +2794,7 @@ DWORD WINAPI SymAddrIncludeInlineTrace(HANDLE hProcess, DWORD64 addr)
 
     TRACE("(%p, %#I64x)\n", hProcess, addr);
 
-    if (module_init_pair(&pair, hProcess, addr))
+    if (module_init_pair_at(&pair, hProcess, addr))
     {
         struct symt_ht* symt = symt_find_symbol_at(pair.effective, addr);
         if (symt_check_tag(&symt->symt, SymTagFunction))
@@ -2835,7 +2827,9 @@ BOOL WINAPI SymQueryInlineTrace(HANDLE hProcess, DWORD64 StartAddress, DWORD Sta
     TRACE("(%p, %#I64x, 0x%lx, %#I64x, %I64x, %p, %p)\n",
           hProcess, StartAddress, StartContext, StartRetAddress, CurAddress, CurContext, CurFrameIndex);
 
-    if (!module_init_pair(&pair, hProcess, CurAddress)) return FALSE;
+    if (!module_init_pair_at(&pair, hProcess, CurAddress)) return FALSE;
+    module_get_debug_at(&pair, StartAddress);
+    module_get_debug_at(&pair, StartRetAddress);
     if (!(sym_curr = symt_find_symbol_at(pair.effective, CurAddress))) return FALSE;
     if (!symt_check_tag(&sym_curr->symt, SymTagFunction)) return FALSE;
 
@@ -1650,6 +1650,108 @@ static void test_refresh_modules(void)
     ok(ret, "SymCleanup failed: %lu\n", GetLastError());
 }
 
+static void check_symbol_at(HANDLE proc, DWORD64 base, unsigned idx, int lineno)
+{
+    char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    SYMBOL_INFO *si = (SYMBOL_INFO*)buffer;
+    DWORD64 disp;
+    char name[32];
+    BOOL ret;
+
+    sprintf(name, "winetest_symbol_%u", idx);
+    memset(buffer, 0, sizeof(buffer));
+    si->SizeOfStruct = sizeof(*si);
+    si->MaxNameLen = MAX_SYM_NAME;
+    ret = SymFromAddr(proc, base + 0x100 * (idx + 1) + 4, &disp, si);
+    ok_(__FILE__, lineno)(ret, "SymFromAddr failed: %lu\n", GetLastError());
+    if (ret)
+    {
+        ok_(__FILE__, lineno)(!strcmp(si->Name, name), "Unexpected symbol %s, expecting %s\n", si->Name, name);
+        ok_(__FILE__, lineno)(disp == 4, "Unexpected displacement %I64x\n", disp);
+    }
+}
+
+static void test_symbol_lookups(void)
+{
+    static const unsigned order[] = {17, 3, 25, 0, 9, 30, 12, 1, 21, 6};
+    HANDLE dummy = (HANDLE)(ULONG_PTR)0xcafef00d;
+    const DWORD64 base = 0x00010000;
+    char buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+    SYMBOL_INFO *si = (SYMBOL_INFO*)buffer;
+    DWORD64 addr, disp;
+    char name[32];
+    unsigned i, j;
+    BOOL ret;
+
+    ret = SymInitialize(dummy, NULL, FALSE);
+    ok(ret, "SymInitialize failed: %lu\n", GetLastError());
+    addr = SymLoadModuleEx(dummy, NULL, "winetest_virtual", NULL, base, 0x10000, NULL, SLMFLAG_VIRTUAL);
+    ok(addr == base, "SymLoadModuleEx failed: %lu\n", GetLastError());
+
+    /* add symbols one at a time, looking them all up after each addition,
+     * so that new symbols end up both after and before the already sorted ones
+     */
+    for (i = 0; i < ARRAY_SIZE(order); i++)
+    {
+        sprintf(name, "winetest_symbol_%u", order[i]);
+        ret = SymAddSymbol(dummy, base, name, base + 0x100 * (order[i] + 1), 0x10, 0);
+        ok(ret, "SymAddSymbol failed: %lu\n", GetLastError());
+        for (j = 0; j <= i; j++)
+            check_symbol_at(dummy, base, order[j], __LINE__);
+    }
+
+    /* no symbol covers the gaps between them */
+    memset(buffer, 0, sizeof(buffer));
+    si->SizeOfStruct = sizeof(*si);
+    si->MaxNameLen = MAX_SYM_NAME;
+    ret = SymFromAddr(dummy, base + 0x100 * 4 + 0x80, &disp, si);
+    ok(!ret, "SymFromAddr should have failed\n");
+
+    ret = SymCleanup(dummy);
+    ok(ret, "SymCleanup failed: %lu\n", GetLastError());
+
+    /* add all symbols in a single batch, in descending order, so that the
+     * first lookup sorts the whole table at once
+     */
+    ret = SymInitialize(dummy, NULL, FALSE);
+    ok(ret, "SymInitialize failed: %lu\n", GetLastError());
+    addr = SymLoadModuleEx(dummy, NULL, "winetest_virtual", NULL, base, 0x10000, NULL, SLMFLAG_VIRTUAL);
+    ok(addr == base, "SymLoadModuleEx failed: %lu\n", GetLastError());
+
+    for (i = 32; i > 0; i--)
+    {
+        sprintf(name, "winetest_symbol_%u", i - 1);
+        ret = SymAddSymbol(dummy, base, name, base + 0x100 * i, 0x10, 0);
+        ok(ret, "SymAddSymbol failed: %lu\n", GetLastError());
+    }
+    for (i = 0; i < 32; i++)
+        check_symbol_at(dummy, base, i, __LINE__);
+
+    /* then interleave a second batch with the sorted symbols */
+    for (i = 0; i < 32; i++)
+    {
+        sprintf(name, "winetest_symbol_%u", 32 + i);
+        ret = SymAddSymbol(dummy, base, name, base + 0x100 * (33 + i), 0x10, 0);
+        ok(ret, "SymAddSymbol failed: %lu\n", GetLastError());
+        sprintf(name, "winetest_extra_%u", i);
+        ret = SymAddSymbol(dummy, base, name, base + 0x100 * (i + 1) + 0x80, 0x10, 0);
+        ok(ret, "SymAddSymbol failed: %lu\n", GetLastError());
+    }
+    for (i = 0; i < 64; i++)
+        check_symbol_at(dummy, base, i, __LINE__);
+
+    memset(buffer, 0, sizeof(buffer));
+    si->SizeOfStruct = sizeof(*si);
+    si->MaxNameLen = MAX_SYM_NAME;
+    ret = SymFromAddr(dummy, base + 0x100 * 5 + 0x84, &disp, si);
+    ok(ret, "SymFromAddr failed: %lu\n", GetLastError());
+    ok(!strcmp(si->Name, "winetest_extra_4"), "Unexpected symbol %s\n", si->Name);
+    ok(disp == 4, "Unexpected displacement %I64x\n", disp);
+
+    ret = SymCleanup(dummy);
+    ok(ret, "SymCleanup failed: %lu\n", GetLastError());
+}
+
 START_TEST(dbghelp)
 {
     BOOL ret;
@@ -1683,4 +1785,5 @@ START_TEST(dbghelp)
         test_refresh_modules();
     }
     test_function_tables();
+    test_symbol_lookups();
 }
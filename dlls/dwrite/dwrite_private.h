@@ -353,6 +353,7 @@ extern BOOL lb_is_newline_char(WCHAR);
 extern HRESULT create_system_fontfallback(IDWriteFactory7 *factory, IDWriteFontFallback1 **fallback);
 extern void release_system_fontfallback(IDWriteFontFallback1 *fallback);
 extern void release_system_fallback_data(void);
+extern void release_shaping_cache(void);
 extern HRESULT create_fontfallback_builder(IDWriteFactory7 *factory, IDWriteFontFallbackBuilder **builder);
 extern HRESULT create_matching_font(IDWriteFontCollection *collection, const WCHAR *family, DWRITE_FONT_WEIGHT weight,
         DWRITE_FONT_STYLE style, DWRITE_FONT_STRETCH stretch, REFIID riid, void **obj);
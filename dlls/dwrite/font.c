@@ -346,6 +346,15 @@ struct dwrite_fontcollection
     struct dwrite_fontfamily_data **family_data;
     size_t size;
     size_t count;
+    struct wine_rb_tree family_names;
+};
+
+/* maps every name of a collection family to its index */
+struct family_name_entry
+{
+    struct wine_rb_entry entry;
+    UINT32 index;
+    WCHAR name[1];
 };
 
 struct dwrite_fontfamily
@@ -3263,6 +3272,16 @@ static ULONG WINAPI dwritefontcollection_AddRef(IDWriteFontCollection3 *iface)
     return refcount;
 }
 
+static int family_name_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    return wcsicmp(key, WINE_RB_ENTRY_VALUE(entry, const struct family_name_entry, entry)->name);
+}
+
+static void release_family_name_entry(struct wine_rb_entry *entry, void *context)
+{
+    free(WINE_RB_ENTRY_VALUE(entry, struct family_name_entry, entry));
+}
+
 static ULONG WINAPI dwritefontcollection_Release(IDWriteFontCollection3 *iface)
 {
     struct dwrite_fontcollection *collection = impl_from_IDWriteFontCollection3(iface);
@@ -3276,6 +3295,7 @@ static ULONG WINAPI dwritefontcollection_Release(IDWriteFontCollection3 *iface)
         factory_detach_fontcollection(collection->factory, iface);
         for (i = 0; i < collection->count; ++i)
             release_fontfamily_data(collection->family_data[i]);
+        wine_rb_destroy(&collection->family_names, release_family_name_entry, NULL);
         free(collection->family_data);
         free(collection);
     }
@@ -3314,24 +3334,11 @@ static HRESULT WINAPI dwritefontcollection_GetFontFamily(IDWriteFontCollection3
 
 static UINT32 collection_find_family(struct dwrite_fontcollection *collection, const WCHAR *name)
 {
-    size_t i;
-
-    for (i = 0; i < collection->count; ++i)
-    {
-        IDWriteLocalizedStrings *family_name = collection->family_data[i]->familyname;
-        UINT32 j, count = IDWriteLocalizedStrings_GetCount(family_name);
-        HRESULT hr;
+    struct wine_rb_entry *entry;
 
-        for (j = 0; j < count; j++)
-        {
-            WCHAR buffer[255];
-            hr = IDWriteLocalizedStrings_GetString(family_name, j, buffer, ARRAY_SIZE(buffer));
-            if (SUCCEEDED(hr) && !wcsicmp(buffer, name))
-                return i;
-        }
-    }
-
-    return ~0u;
+    if (!(entry = wine_rb_get(&collection->family_names, name)))
+        return ~0u;
+    return WINE_RB_ENTRY_VALUE(entry, struct family_name_entry, entry)->index;
 }
 
 static HRESULT WINAPI dwritefontcollection_FindFamilyName(IDWriteFontCollection3 *iface, const WCHAR *name,
@@ -3538,12 +3545,31 @@ static HRESULT fontfamily_add_font(struct dwrite_fontfamily_data *family_data, s
 static HRESULT fontcollection_add_family(struct dwrite_fontcollection *collection,
         struct dwrite_fontfamily_data *family)
 {
+    UINT32 i, count = IDWriteLocalizedStrings_GetCount(family->familyname);
+
     if (!dwrite_array_reserve((void **)&collection->family_data, &collection->size, collection->count + 1,
             sizeof(*collection->family_data)))
     {
         return E_OUTOFMEMORY;
     }
 
+    /* Names already used by another family keep resolving to the first one. */
+    for (i = 0; i < count; ++i)
+    {
+        struct family_name_entry *entry;
+        WCHAR buffer[255];
+
+        if (FAILED(IDWriteLocalizedStrings_GetString(family->familyname, i, buffer, ARRAY_SIZE(buffer))))
+            continue;
+        if (wine_rb_get(&collection->family_names, buffer))
+            continue;
+        if (!(entry = malloc(offsetof(struct family_name_entry, name[wcslen(buffer) + 1]))))
+            break;
+        entry->index = collection->count;
+        wcscpy(entry->name, buffer);
+        wine_rb_put(&collection->family_names, entry->name, &entry->entry);
+    }
+
     collection->family_data[collection->count++] = family;
     return S_OK;
 }
@@ -3556,6 +3582,7 @@ static HRESULT init_font_collection(struct dwrite_fontcollection *collection, ID
     collection->factory = factory;
     IDWriteFactory7_AddRef(collection->factory);
     collection->family_model = family_model;
+    wine_rb_init(&collection->family_names, family_name_compare);
 
     return S_OK;
 }
@@ -4646,15 +4673,29 @@ static void fontcollection_add_replacements(struct dwrite_fontcollection *collec
     RegCloseKey(hkey);
 }
 
+struct scanned_fontfile
+{
+    struct list entry;
+    struct wine_rb_entry key_entry;
+    IDWriteFontFile *file;
+    const void *key;
+    UINT32 key_size;
+};
+
+static int scanned_fontfile_compare(const void *k, const struct wine_rb_entry *e)
+{
+    const struct scanned_fontfile *key = k, *entry = WINE_RB_ENTRY_VALUE(e, const struct scanned_fontfile, key_entry);
+
+    if (key->key_size != entry->key_size) return key->key_size < entry->key_size ? -1 : 1;
+    return memcmp(key->key, entry->key, key->key_size);
+}
+
 HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
     IDWriteFontCollection3 **ret)
 {
-    struct fontfile_enum {
-        struct list entry;
-        IDWriteFontFile *file;
-    };
-    struct fontfile_enum *fileenum, *fileenum2;
+    struct scanned_fontfile *fileenum, *fileenum2;
     struct dwrite_fontcollection *collection;
+    struct wine_rb_tree scannedkeys;
     struct list scannedfiles;
     BOOL current = FALSE;
     HRESULT hr = S_OK;
@@ -4677,13 +4718,15 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
     TRACE("building font collection:\n");
 
     list_init(&scannedfiles);
+    wine_rb_init(&scannedkeys, scanned_fontfile_compare);
     while (hr == S_OK) {
         DWRITE_FONT_FACE_TYPE face_type;
         DWRITE_FONT_FILE_TYPE file_type;
-        BOOL supported, same = FALSE;
+        struct scanned_fontfile key;
         IDWriteFontFileStream *stream;
         IDWriteFontFile *file;
         UINT32 face_count;
+        BOOL supported;
 
         current = FALSE;
         hr = IDWriteFontFileEnumerator_MoveNext(enumerator, &current);
@@ -4695,12 +4738,9 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             break;
 
         /* check if we've scanned this file already */
-        LIST_FOR_EACH_ENTRY(fileenum, &scannedfiles, struct fontfile_enum, entry) {
-            if ((same = is_same_fontfile(fileenum->file, file)))
-                break;
-        }
-
-        if (same) {
+        if (FAILED(IDWriteFontFile_GetReferenceKey(file, &key.key, &key.key_size)))
+            key.key = NULL;
+        else if (wine_rb_get(&scannedkeys, &key)) {
             IDWriteFontFile_Release(file);
             continue;
         }
@@ -4723,7 +4763,11 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         /* add to scanned list */
         fileenum = malloc(sizeof(*fileenum));
         fileenum->file = file;
+        fileenum->key = key.key;
+        fileenum->key_size = key.key_size;
         list_add_tail(&scannedfiles, &fileenum->entry);
+        if (key.key)
+            wine_rb_put(&scannedkeys, fileenum, &fileenum->key_entry);
 
         for (i = 0; i < face_count; ++i)
         {
@@ -4788,7 +4832,7 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         IDWriteFontFileStream_Release(stream);
     }
 
-    LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct fontfile_enum, entry)
+    LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct scanned_fontfile, entry)
     {
         IDWriteFontFile_Release(fileenum->file);
         list_remove(&fileenum->entry);
@@ -821,6 +821,105 @@ static HRESULT layout_resolve_fonts(struct dwrite_textlayout *layout)
     return hr;
 }
 
+/* Shaping results are cached process wide, applications often create layouts
+   for the same strings over and over again. Only plain runs are cached, i.e. runs
+   without user features in natural measuring mode, using fonts from the local file
+   loader. Local reference keys contain file path and write time, so they identify
+   font data without holding a reference to the file. */
+#define SHAPING_CACHE_SIZE 512
+#define SHAPING_CACHE_MAX_LENGTH 256
+
+struct shaping_cache_key
+{
+    const WCHAR *string;
+    UINT32 length;
+    const void *file_key;
+    UINT32 file_key_size;
+    UINT32 face_index;
+    DWRITE_FONT_SIMULATIONS simulations;
+    float size;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    BOOL is_sideways;
+    BOOL is_rtl;
+    const WCHAR *locale;
+};
+
+struct shaping_cache_entry
+{
+    struct wine_rb_entry entry;
+    struct list mru;
+    struct shaping_cache_key key;
+    UINT32 glyph_count;
+    UINT16 *glyphs;
+    UINT16 *clustermap;
+    DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
+    float *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+};
+
+static int shaping_cache_compare(const void *k, const struct wine_rb_entry *entry)
+{
+    const struct shaping_cache_entry *cached = WINE_RB_ENTRY_VALUE(entry, const struct shaping_cache_entry, entry);
+    const struct shaping_cache_key *key = k, *other = &cached->key;
+    int ret;
+
+    if (key->length != other->length) return key->length < other->length ? -1 : 1;
+    if (key->file_key_size != other->file_key_size) return key->file_key_size < other->file_key_size ? -1 : 1;
+    if (key->face_index != other->face_index) return key->face_index < other->face_index ? -1 : 1;
+    if (key->simulations != other->simulations) return key->simulations < other->simulations ? -1 : 1;
+    if (key->size != other->size) return key->size < other->size ? -1 : 1;
+    if (key->sa.script != other->sa.script) return key->sa.script < other->sa.script ? -1 : 1;
+    if (key->sa.shapes != other->sa.shapes) return key->sa.shapes < other->sa.shapes ? -1 : 1;
+    if (key->is_sideways != other->is_sideways) return key->is_sideways < other->is_sideways ? -1 : 1;
+    if (key->is_rtl != other->is_rtl) return key->is_rtl < other->is_rtl ? -1 : 1;
+    if ((ret = memcmp(key->string, other->string, key->length * sizeof(WCHAR)))) return ret;
+    if ((ret = memcmp(key->file_key, other->file_key, key->file_key_size))) return ret;
+    return wcscmp(key->locale, other->locale);
+}
+
+static struct
+{
+    struct wine_rb_tree tree;
+    struct list mru;
+    unsigned int count;
+    unsigned int hits;
+    unsigned int misses;
+} shaping_cache = { { shaping_cache_compare }, LIST_INIT(shaping_cache.mru) };
+
+static CRITICAL_SECTION shaping_cache_cs;
+static CRITICAL_SECTION_DEBUG shaping_cache_cs_debug =
+{
+    0, 0, &shaping_cache_cs,
+    { &shaping_cache_cs_debug.ProcessLocksList, &shaping_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": shaping_cache_cs") }
+};
+static CRITICAL_SECTION shaping_cache_cs = { &shaping_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static void shaping_cache_remove_entry(struct shaping_cache_entry *entry)
+{
+    wine_rb_remove(&shaping_cache.tree, &entry->entry);
+    list_remove(&entry->mru);
+    shaping_cache.count--;
+    free(entry->glyphs);
+    free(entry->clustermap);
+    free(entry->glyph_props);
+    free(entry->advances);
+    free(entry->offsets);
+    free(entry);
+}
+
+void release_shaping_cache(void)
+{
+    struct shaping_cache_entry *entry, *next;
+
+    TRACE("Shaping cache hits %u, misses %u.\n", shaping_cache.hits, shaping_cache.misses);
+
+    EnterCriticalSection(&shaping_cache_cs);
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &shaping_cache.mru, struct shaping_cache_entry, mru)
+        shaping_cache_remove_entry(entry);
+    LeaveCriticalSection(&shaping_cache_cs);
+}
+
 struct shaping_context
 {
     IDWriteTextAnalyzer2 *analyzer;
@@ -834,6 +933,13 @@ struct shaping_context
         unsigned int *range_lengths;
         unsigned int range_count;
     } user_features;
+
+    struct
+    {
+        struct shaping_cache_key key;
+        IDWriteFontFile *file;
+        BOOL hit;
+    } cache;
 };
 
 static void layout_shape_clear_user_features_context(struct shaping_context *context)
@@ -852,6 +958,8 @@ static void layout_shape_clear_user_features_context(struct shaping_context *con
 static void layout_shape_clear_context(struct shaping_context *context)
 {
     layout_shape_clear_user_features_context(context);
+    if (context->cache.file)
+        IDWriteFontFile_Release(context->cache.file);
     free(context->glyph_props);
     free(context->text_props);
 }
@@ -944,6 +1052,177 @@ failed:
     return hr;
 }
 
+static BOOL layout_shape_init_cache_key(const struct dwrite_textlayout *layout, struct shaping_context *context)
+{
+    struct shaping_cache_key *key = &context->cache.key;
+    struct regular_layout_run *run = context->run;
+    IDWriteFontFileLoader *loader;
+    IDWriteFontFace5 *fontface5;
+    IDWriteFontFile *file;
+    UINT32 count = 0;
+    BOOL variations;
+
+    if (is_layout_gdi_compatible(layout) || context->user_features.range_count
+            || run->descr.stringLength > SHAPING_CACHE_MAX_LENGTH)
+        return FALSE;
+
+    /* Instances of variable fonts are not identified by their file alone. */
+    if (SUCCEEDED(IDWriteFontFace_QueryInterface(run->run.fontFace, &IID_IDWriteFontFace5, (void **)&fontface5)))
+    {
+        variations = IDWriteFontFace5_HasVariations(fontface5);
+        IDWriteFontFace5_Release(fontface5);
+        if (variations) return FALSE;
+    }
+
+    if (FAILED(IDWriteFontFace_GetFiles(run->run.fontFace, &count, NULL)) || count != 1)
+        return FALSE;
+    if (FAILED(IDWriteFontFace_GetFiles(run->run.fontFace, &count, &file)))
+        return FALSE;
+
+    if (FAILED(IDWriteFontFile_GetLoader(file, &loader)))
+    {
+        IDWriteFontFile_Release(file);
+        return FALSE;
+    }
+    IDWriteFontFileLoader_Release(loader);
+
+    if (loader != get_local_fontfile_loader()
+            || FAILED(IDWriteFontFile_GetReferenceKey(file, &key->file_key, &key->file_key_size)))
+    {
+        IDWriteFontFile_Release(file);
+        return FALSE;
+    }
+
+    context->cache.file = file;
+    key->string = run->descr.string;
+    key->length = run->descr.stringLength;
+    key->face_index = IDWriteFontFace_GetIndex(run->run.fontFace);
+    key->simulations = IDWriteFontFace_GetSimulations(run->run.fontFace);
+    key->size = run->run.fontEmSize;
+    key->sa = run->sa;
+    key->is_sideways = run->run.isSideways;
+    key->is_rtl = run->run.bidiLevel & 1;
+    key->locale = run->descr.localeName ? run->descr.localeName : L"";
+
+    return TRUE;
+}
+
+static HRESULT layout_shape_get_cached_glyphs(struct shaping_context *context)
+{
+    struct regular_layout_run *run = context->run;
+    struct shaping_cache_entry *cached;
+    struct wine_rb_entry *entry;
+    HRESULT hr = S_FALSE;
+
+    EnterCriticalSection(&shaping_cache_cs);
+
+    if ((entry = wine_rb_get(&shaping_cache.tree, &context->cache.key)))
+    {
+        cached = WINE_RB_ENTRY_VALUE(entry, struct shaping_cache_entry, entry);
+
+        free(run->glyphs);
+        free(context->glyph_props);
+        run->glyphs = malloc(max(cached->glyph_count, 1) * sizeof(*run->glyphs));
+        context->glyph_props = malloc(max(cached->glyph_count, 1) * sizeof(*context->glyph_props));
+        run->advances = malloc(max(cached->glyph_count, 1) * sizeof(*run->advances));
+        run->offsets = malloc(max(cached->glyph_count, 1) * sizeof(*run->offsets));
+
+        if (!run->glyphs || !context->glyph_props || !run->advances || !run->offsets)
+            hr = E_OUTOFMEMORY;
+        else
+        {
+            run->glyphcount = cached->glyph_count;
+            memcpy(run->glyphs, cached->glyphs, cached->glyph_count * sizeof(*cached->glyphs));
+            memcpy(context->glyph_props, cached->glyph_props, cached->glyph_count * sizeof(*cached->glyph_props));
+            memcpy(run->advances, cached->advances, cached->glyph_count * sizeof(*cached->advances));
+            memcpy(run->offsets, cached->offsets, cached->glyph_count * sizeof(*cached->offsets));
+            memcpy(run->clustermap, cached->clustermap, run->descr.stringLength * sizeof(*cached->clustermap));
+
+            list_remove(&cached->mru);
+            list_add_head(&shaping_cache.mru, &cached->mru);
+            context->cache.hit = TRUE;
+            shaping_cache.hits++;
+            hr = S_OK;
+        }
+    }
+    else
+        shaping_cache.misses++;
+
+    TRACE("%s, %s, hits %u, misses %u.\n", debugstr_wn(run->descr.string, run->descr.stringLength),
+            context->cache.hit ? "hit" : "miss", shaping_cache.hits, shaping_cache.misses);
+
+    LeaveCriticalSection(&shaping_cache_cs);
+
+    return hr;
+}
+
+static void layout_shape_cache_run(struct shaping_context *context)
+{
+    const struct shaping_cache_key *key = &context->cache.key;
+    struct regular_layout_run *run = context->run;
+    struct shaping_cache_entry *entry;
+    UINT32 count = run->glyphcount;
+    size_t locale_size;
+    WCHAR *string;
+
+    locale_size = (wcslen(key->locale) + 1) * sizeof(WCHAR);
+    if (!(entry = calloc(1, sizeof(*entry) + key->length * sizeof(WCHAR) + locale_size + key->file_key_size)))
+        return;
+
+    entry->key = *key;
+    string = (WCHAR *)(entry + 1);
+    memcpy(string, key->string, key->length * sizeof(WCHAR));
+    entry->key.string = string;
+    entry->key.locale = string + key->length;
+    memcpy(string + key->length, key->locale, locale_size);
+    entry->key.file_key = (BYTE *)(string + key->length) + locale_size;
+    memcpy((BYTE *)entry->key.file_key, key->file_key, key->file_key_size);
+
+    entry->glyph_count = count;
+    entry->glyphs = malloc(max(count, 1) * sizeof(*entry->glyphs));
+    entry->clustermap = malloc(key->length * sizeof(*entry->clustermap));
+    entry->glyph_props = malloc(max(count, 1) * sizeof(*entry->glyph_props));
+    entry->advances = malloc(max(count, 1) * sizeof(*entry->advances));
+    entry->offsets = malloc(max(count, 1) * sizeof(*entry->offsets));
+    if (!entry->glyphs || !entry->clustermap || !entry->glyph_props || !entry->advances || !entry->offsets)
+    {
+        free(entry->glyphs);
+        free(entry->clustermap);
+        free(entry->glyph_props);
+        free(entry->advances);
+        free(entry->offsets);
+        free(entry);
+        return;
+    }
+
+    memcpy(entry->glyphs, run->glyphs, count * sizeof(*run->glyphs));
+    memcpy(entry->clustermap, run->clustermap, key->length * sizeof(*run->clustermap));
+    memcpy(entry->glyph_props, context->glyph_props, count * sizeof(*context->glyph_props));
+    memcpy(entry->advances, run->advances, count * sizeof(*run->advances));
+    memcpy(entry->offsets, run->offsets, count * sizeof(*run->offsets));
+
+    EnterCriticalSection(&shaping_cache_cs);
+
+    if (wine_rb_put(&shaping_cache.tree, &entry->key, &entry->entry))
+    {
+        /* Another thread got there first. */
+        LeaveCriticalSection(&shaping_cache_cs);
+        free(entry->glyphs);
+        free(entry->clustermap);
+        free(entry->glyph_props);
+        free(entry->advances);
+        free(entry->offsets);
+        free(entry);
+        return;
+    }
+
+    list_add_head(&shaping_cache.mru, &entry->mru);
+    if (++shaping_cache.count > SHAPING_CACHE_SIZE)
+        shaping_cache_remove_entry(LIST_ENTRY(list_tail(&shaping_cache.mru), struct shaping_cache_entry, mru));
+
+    LeaveCriticalSection(&shaping_cache_cs);
+}
+
 static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct shaping_context *context)
 {
     struct regular_layout_run *run = context->run;
@@ -968,6 +1247,14 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     if (FAILED(hr = layout_shape_get_user_features(layout, context)))
         return hr;
 
+    if (layout_shape_init_cache_key(layout, context)
+            && (hr = layout_shape_get_cached_glyphs(context)) != S_FALSE)
+    {
+        run->run.glyphIndices = run->glyphs;
+        run->descr.clusterMap = run->clustermap;
+        return hr;
+    }
+
     for (;;)
     {
         hr = IDWriteTextAnalyzer2_GetGlyphs(context->analyzer, run->descr.string, run->descr.stringLength, run->run.fontFace,
@@ -1087,6 +1374,15 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
     struct regular_layout_run *run = context->run;
     HRESULT hr;
 
+    /* Cached runs come with unmodified placements, only spacing has to be applied. */
+    if (context->cache.hit)
+    {
+        hr = layout_shape_apply_character_spacing(layout, context);
+        run->run.glyphAdvances = run->advances;
+        run->run.glyphOffsets = run->offsets;
+        return hr;
+    }
+
     run->advances = calloc(run->glyphcount, sizeof(*run->advances));
     run->offsets = calloc(run->glyphcount, sizeof(*run->offsets));
     if (!run->advances || !run->offsets)
@@ -1114,6 +1410,9 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
         WARN("%s: failed to get glyph placement info, hr %#lx.\n", debugstr_rundescr(&run->descr), hr);
     }
 
+    if (SUCCEEDED(hr) && context->cache.file)
+        layout_shape_cache_run(context);
+
     if (SUCCEEDED(hr))
         hr = layout_shape_apply_character_spacing(layout, context);
 
@@ -54,6 +54,7 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD reason, LPVOID reserved)
         if (reserved) break;
         release_shared_factory(shared_factory);
         release_system_fallback_data();
+        release_shaping_cache();
         UNIX_CALL(process_detach, NULL);
     }
     return TRUE;
@@ -7089,6 +7089,322 @@ if (SUCCEEDED(hr))
     IDWriteFactory_Release(factory);
 }
 
+struct glyph_run_data
+{
+    IDWriteFontFace *fontface;
+    float size;
+    UINT32 run_count;
+    UINT32 length;
+    UINT32 glyph_count;
+    UINT16 glyphs[64];
+    float advances[64];
+    DWRITE_GLYPH_OFFSET offsets[64];
+    UINT16 clustermap[64];
+    DWRITE_CLUSTER_METRICS clusters[64];
+    UINT32 cluster_count;
+};
+
+static HRESULT WINAPI glyphrunrenderer_IsPixelSnappingDisabled(IDWriteTextRenderer *iface,
+    void *context, BOOL *disabled)
+{
+    *disabled = TRUE;
+    return S_OK;
+}
+
+static HRESULT WINAPI glyphrunrenderer_GetCurrentTransform(IDWriteTextRenderer *iface,
+    void *context, DWRITE_MATRIX *m)
+{
+    static const DWRITE_MATRIX identity = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    *m = identity;
+    return S_OK;
+}
+
+static HRESULT WINAPI glyphrunrenderer_GetPixelsPerDip(IDWriteTextRenderer *iface,
+    void *context, FLOAT *pixels_per_dip)
+{
+    *pixels_per_dip = 1.0f;
+    return S_OK;
+}
+
+static HRESULT WINAPI glyphrunrenderer_DrawGlyphRun(IDWriteTextRenderer *iface, void *context,
+    FLOAT originX, FLOAT originY, DWRITE_MEASURING_MODE mode, DWRITE_GLYPH_RUN const *run,
+    DWRITE_GLYPH_RUN_DESCRIPTION const *descr, IUnknown *effect)
+{
+    struct glyph_run_data *data = context;
+
+    if (data->run_count++) return S_OK;
+
+    ok(run->glyphCount <= ARRAY_SIZE(data->glyphs), "Unexpected glyph count %u.\n", run->glyphCount);
+    ok(descr->stringLength <= ARRAY_SIZE(data->clustermap), "Unexpected length %u.\n", descr->stringLength);
+    data->glyph_count = min(run->glyphCount, ARRAY_SIZE(data->glyphs));
+    data->length = min(descr->stringLength, ARRAY_SIZE(data->clustermap));
+    memcpy(data->glyphs, run->glyphIndices, data->glyph_count * sizeof(*data->glyphs));
+    memcpy(data->advances, run->glyphAdvances, data->glyph_count * sizeof(*data->advances));
+    memcpy(data->offsets, run->glyphOffsets, data->glyph_count * sizeof(*data->offsets));
+    memcpy(data->clustermap, descr->clusterMap, data->length * sizeof(*data->clustermap));
+    IDWriteFontFace_AddRef(data->fontface = run->fontFace);
+    data->size = run->fontEmSize;
+    return S_OK;
+}
+
+static HRESULT WINAPI glyphrunrenderer_DrawUnderline(IDWriteTextRenderer *iface, void *context,
+    FLOAT originX, FLOAT originY, DWRITE_UNDERLINE const *underline, IUnknown *effect)
+{
+    ok(0, "Unexpected call.\n");
+    return E_NOTIMPL;
+}
+
+static HRESULT WINAPI glyphrunrenderer_DrawStrikethrough(IDWriteTextRenderer *iface, void *context,
+    FLOAT originX, FLOAT originY, DWRITE_STRIKETHROUGH const *strikethrough, IUnknown *effect)
+{
+    ok(0, "Unexpected call.\n");
+    return E_NOTIMPL;
+}
+
+static HRESULT WINAPI glyphrunrenderer_DrawInlineObject(IDWriteTextRenderer *iface, void *context,
+    FLOAT originX, FLOAT originY, IDWriteInlineObject *object, BOOL is_sideways, BOOL is_rtl, IUnknown *effect)
+{
+    ok(0, "Unexpected call.\n");
+    return E_NOTIMPL;
+}
+
+static const IDWriteTextRendererVtbl glyphrunrenderervtbl =
+{
+    testrenderer_QI,
+    testrenderer_AddRef,
+    testrenderer_Release,
+    glyphrunrenderer_IsPixelSnappingDisabled,
+    glyphrunrenderer_GetCurrentTransform,
+    glyphrunrenderer_GetPixelsPerDip,
+    glyphrunrenderer_DrawGlyphRun,
+    glyphrunrenderer_DrawUnderline,
+    glyphrunrenderer_DrawStrikethrough,
+    glyphrunrenderer_DrawInlineObject,
+};
+
+static IDWriteTextRenderer glyphrunrenderer = { &glyphrunrenderervtbl };
+
+static void get_layout_glyph_run(IDWriteFactory *factory, IDWriteTextFormat *format, const WCHAR *text,
+        IDWriteTypography *typography, BOOL gdicompat, struct glyph_run_data *data)
+{
+    DWRITE_TEXT_RANGE range = { 0, wcslen(text) };
+    IDWriteTextLayout *layout;
+    HRESULT hr;
+
+    memset(data, 0, sizeof(*data));
+
+    if (gdicompat)
+        hr = IDWriteFactory_CreateGdiCompatibleTextLayout(factory, text, range.length, format, 1000.0f, 100.0f,
+                1.0f, NULL, FALSE, &layout);
+    else
+        hr = IDWriteFactory_CreateTextLayout(factory, text, range.length, format, 1000.0f, 100.0f, &layout);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    if (typography)
+    {
+        hr = IDWriteTextLayout_SetTypography(layout, typography, range);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    }
+
+    hr = IDWriteTextLayout_Draw(layout, data, &glyphrunrenderer, 0.0f, 0.0f);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(data->run_count == 1, "Unexpected run count %u.\n", data->run_count);
+
+    hr = IDWriteTextLayout_GetClusterMetrics(layout, data->clusters, ARRAY_SIZE(data->clusters), &data->cluster_count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    IDWriteTextLayout_Release(layout);
+}
+
+static void release_glyph_run_data(struct glyph_run_data *data)
+{
+    if (data->fontface)
+        IDWriteFontFace_Release(data->fontface);
+}
+
+#define check_glyph_run_data(a, b) check_glyph_run_data_(a, b, __LINE__)
+static void check_glyph_run_data_(const struct glyph_run_data *data, const struct glyph_run_data *expected,
+        unsigned int line)
+{
+    unsigned int i;
+
+    ok_(__FILE__, line)(data->length == expected->length, "Unexpected length %u.\n", data->length);
+    ok_(__FILE__, line)(data->glyph_count == expected->glyph_count, "Unexpected glyph count %u, expected %u.\n",
+            data->glyph_count, expected->glyph_count);
+    if (data->glyph_count != expected->glyph_count || data->length != expected->length) return;
+
+    for (i = 0; i < data->glyph_count; ++i)
+    {
+        winetest_push_context("Glyph %u", i);
+        ok_(__FILE__, line)(data->glyphs[i] == expected->glyphs[i], "Unexpected glyph %u, expected %u.\n",
+                data->glyphs[i], expected->glyphs[i]);
+        ok_(__FILE__, line)(data->advances[i] == expected->advances[i], "Unexpected advance %.8e, expected %.8e.\n",
+                data->advances[i], expected->advances[i]);
+        ok_(__FILE__, line)(data->offsets[i].advanceOffset == expected->offsets[i].advanceOffset
+                && data->offsets[i].ascenderOffset == expected->offsets[i].ascenderOffset,
+                "Unexpected offset {%.8e,%.8e}.\n", data->offsets[i].advanceOffset, data->offsets[i].ascenderOffset);
+        winetest_pop_context();
+    }
+
+    ok_(__FILE__, line)(!memcmp(data->clustermap, expected->clustermap, data->length * sizeof(*data->clustermap)),
+            "Unexpected cluster map.\n");
+}
+
+/* Shapes the first run of a layout directly with the analyzer, using the same parameters. */
+static void get_analyzer_glyph_run(IDWriteFactory *factory, const WCHAR *text, const struct glyph_run_data *layout_data,
+        const DWRITE_TYPOGRAPHIC_FEATURES *features, BOOL gdicompat, struct glyph_run_data *data)
+{
+    DWRITE_SHAPING_GLYPH_PROPERTIES glyph_props[64];
+    DWRITE_SHAPING_TEXT_PROPERTIES text_props[64];
+    UINT32 length = layout_data->length;
+    IDWriteTextAnalyzer *analyzer;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    HRESULT hr;
+
+    memset(data, 0, sizeof(*data));
+    data->length = length;
+
+    hr = IDWriteFactory_CreateTextAnalyzer(factory, &analyzer);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    get_script_analysis(text, length, &sa);
+    hr = IDWriteTextAnalyzer_GetGlyphs(analyzer, text, length, layout_data->fontface, FALSE, FALSE, &sa, L"en-us",
+            NULL, &features, &length, features ? 1 : 0, ARRAY_SIZE(data->glyphs), data->clustermap, text_props,
+            data->glyphs, glyph_props, &data->glyph_count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    if (gdicompat)
+        hr = IDWriteTextAnalyzer_GetGdiCompatibleGlyphPlacements(analyzer, text, data->clustermap, text_props, length,
+                data->glyphs, glyph_props, data->glyph_count, layout_data->fontface, layout_data->size, 1.0f, NULL,
+                FALSE, FALSE, FALSE, &sa, L"en-us", &features, &length, features ? 1 : 0, data->advances,
+                data->offsets);
+    else
+        hr = IDWriteTextAnalyzer_GetGlyphPlacements(analyzer, text, data->clustermap, text_props, length, data->glyphs,
+                glyph_props, data->glyph_count, layout_data->fontface, layout_data->size, FALSE, FALSE, &sa, L"en-us",
+                &features, &length, features ? 1 : 0, data->advances, data->offsets);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    IDWriteTextAnalyzer_Release(analyzer);
+}
+
+static void test_shaping_cache(void)
+{
+    static const WCHAR text[] = L"AVATAR Wave To Yo";
+    static const WCHAR text2[] = L"ABDA!";
+    DWRITE_FONT_FEATURE feature = { DWRITE_FONT_FEATURE_TAG_KERNING, 0 };
+    DWRITE_TYPOGRAPHIC_FEATURES features = { &feature, 1 };
+    IDWriteFontCollectionLoader *collection_loader;
+    struct glyph_run_data data, data2, expected;
+    IDWriteFontCollection *collection;
+    IDWriteTypography *typography;
+    IDWriteFontFileLoader *loader;
+    IDWriteTextFormat *format;
+    IDWriteFactory *factory;
+    unsigned int i;
+    HRSRC hrsrc;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 13.0f, L"en-us", &format);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    /* Same text laid out twice. */
+    get_layout_glyph_run(factory, format, text, NULL, FALSE, &data);
+    get_layout_glyph_run(factory, format, text, NULL, FALSE, &data2);
+    check_glyph_run_data(&data2, &data);
+    ok(data2.cluster_count == data.cluster_count, "Unexpected cluster count %u.\n", data2.cluster_count);
+    for (i = 0; i < data.cluster_count; ++i)
+    {
+        winetest_push_context("Cluster %u", i);
+        ok(data2.clusters[i].width == data.clusters[i].width, "Unexpected width %.8e.\n", data2.clusters[i].width);
+        ok(data2.clusters[i].length == data.clusters[i].length, "Unexpected length %u.\n", data2.clusters[i].length);
+        ok(data2.clusters[i].canWrapLineAfter == data.clusters[i].canWrapLineAfter
+                && data2.clusters[i].isWhitespace == data.clusters[i].isWhitespace
+                && data2.clusters[i].isNewline == data.clusters[i].isNewline
+                && data2.clusters[i].isSoftHyphen == data.clusters[i].isSoftHyphen
+                && data2.clusters[i].isRightToLeft == data.clusters[i].isRightToLeft, "Unexpected cluster flags.\n");
+        winetest_pop_context();
+    }
+    get_analyzer_glyph_run(factory, text, &data, NULL, FALSE, &expected);
+    check_glyph_run_data(&data2, &expected);
+    release_glyph_run_data(&data2);
+
+    /* User features are applied on top of previously laid out plain text. */
+    hr = IDWriteFactory_CreateTypography(factory, &typography);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTypography_AddFontFeature(typography, feature);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    for (i = 0; i < 2; ++i)
+    {
+        get_layout_glyph_run(factory, format, text, typography, FALSE, &data2);
+        get_analyzer_glyph_run(factory, text, &data2, &features, FALSE, &expected);
+        check_glyph_run_data(&data2, &expected);
+        release_glyph_run_data(&data2);
+    }
+
+    IDWriteTypography_Release(typography);
+
+    /* GDI-compatible layouts use their own placements. */
+    for (i = 0; i < 2; ++i)
+    {
+        get_layout_glyph_run(factory, format, text, NULL, TRUE, &data2);
+        get_analyzer_glyph_run(factory, text, &data2, NULL, TRUE, &expected);
+        check_glyph_run_data(&data2, &expected);
+        release_glyph_run_data(&data2);
+    }
+
+    /* Plain text again, after the other layouts. */
+    get_layout_glyph_run(factory, format, text, NULL, FALSE, &data2);
+    check_glyph_run_data(&data2, &data);
+    release_glyph_run_data(&data2);
+    release_glyph_run_data(&data);
+
+    IDWriteTextFormat_Release(format);
+
+    /* Fonts from a custom loader. */
+    loader = create_resource_file_loader();
+    collection_loader = create_resource_collection_loader(loader);
+
+    hr = IDWriteFactory_RegisterFontFileLoader(factory, loader);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteFactory_RegisterFontCollectionLoader(factory, collection_loader);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    hrsrc = FindResourceA(GetModuleHandleA(NULL), (LPCSTR)MAKEINTRESOURCE(1), (LPCSTR)RT_RCDATA);
+    ok(!!hrsrc, "Failed to find font resource.\n");
+
+    hr = IDWriteFactory_CreateCustomFontCollection(factory, collection_loader, &hrsrc, sizeof(hrsrc), &collection);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"wine_test", collection, DWRITE_FONT_WEIGHT_NORMAL,
+            DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, 13.0f, L"en-us", &format);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    get_layout_glyph_run(factory, format, text2, NULL, FALSE, &data);
+    get_layout_glyph_run(factory, format, text2, NULL, FALSE, &data2);
+    check_glyph_run_data(&data2, &data);
+    get_analyzer_glyph_run(factory, text2, &data2, NULL, FALSE, &expected);
+    check_glyph_run_data(&data2, &expected);
+    release_glyph_run_data(&data2);
+    release_glyph_run_data(&data);
+
+    IDWriteTextFormat_Release(format);
+    IDWriteFontCollection_Release(collection);
+
+    hr = IDWriteFactory_UnregisterFontCollectionLoader(factory, collection_loader);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteFactory_UnregisterFontFileLoader(factory, loader);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    IDWriteFontCollectionLoader_Release(collection_loader);
+    IDWriteFontFileLoader_Release(loader);
+
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -7145,6 +7461,7 @@ START_TEST(layout)
     test_text_format_axes();
     test_layout_range_length();
     test_HitTestTextRange();
+    test_shaping_cache();
 
     IDWriteFactory_Release(factory);
 }
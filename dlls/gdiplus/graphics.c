@@ -657,6 +657,15 @@ static ARGB blend_colors(ARGB start, ARGB end, REAL position)
 
     pos = gdip_round(position * 0xff);
 
+    /* Common case of opaque colors, gives the same result as the generic path. */
+    if ((start >> 24) == 0xff && (end >> 24) == 0xff && pos >= 0 && pos <= 0xff)
+    {
+        return 0xff000000 |
+            ((((start >> 16) & 0xff) * (pos ^ 0xff) + ((end >> 16) & 0xff) * pos) / 0xff) << 16 |
+            ((((start >> 8) & 0xff) * (pos ^ 0xff) + ((end >> 8) & 0xff) * pos) / 0xff) << 8 |
+            (((start & 0xff) * (pos ^ 0xff) + (end & 0xff) * pos) / 0xff);
+    }
+
     start_a = ((start >> 24) & 0xff) * (pos ^ 0xff);
     end_a = ((end >> 24) & 0xff) * pos;
 
@@ -1061,16 +1070,16 @@ static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT wi
     return ((DWORD*)(bits))[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
 }
 
+static int interpolation_fixme;
+
 static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
     UINT height, GpPointF *point, GDIPCONST GpImageAttributes *attributes,
     InterpolationMode interpolation, PixelOffsetMode offset_mode)
 {
-    static int fixme;
-
     switch (interpolation)
     {
     default:
-        if (!fixme++)
+        if (!interpolation_fixme++)
             FIXME("Unimplemented interpolation %i\n", interpolation);
         /* fall-through */
     case InterpolationModeBilinear:
@@ -1130,6 +1139,71 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     }
 }
 
+/* Resamples a row of destination pixels, with source point advancing by (dx, dy) per pixel.
+ * Points outside of bounds are left untouched. Samples that don't need wrapping are
+ * read directly from the source buffer, the rest goes through resample_bitmap_pixel(). */
+static void resample_bitmap_row(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
+    UINT height, GpPointF point, REAL dx, REAL dy, GDIPCONST GpRectF *bounds, ARGB *dst, INT count,
+    GDIPCONST GpImageAttributes *attributes, InterpolationMode interpolation, PixelOffsetMode offset_mode)
+{
+    INT min_x = max(src_rect->X, 0), max_x = min(src_rect->X + src_rect->Width, (INT)width);
+    INT min_y = max(src_rect->Y, 0), max_y = min(src_rect->Y + src_rect->Height, (INT)height);
+    const ARGB *src = (const ARGB *)bits;
+    INT i, x, y, rightx, bottomy;
+    REAL pixel_offset = 0.5f, leftxf, topyf;
+    const ARGB *top, *bottom;
+
+    if (offset_mode == PixelOffsetModeHalf || offset_mode == PixelOffsetModeHighQuality)
+        pixel_offset = 0.0f;
+
+    if (interpolation != InterpolationModeNearestNeighbor && interpolation != InterpolationModeBilinear
+            && !interpolation_fixme++)
+        FIXME("Unimplemented interpolation %i\n", interpolation);
+
+    for (i = 0; i < count; i++, point.X += dx, point.Y += dy, dst++)
+    {
+        if (!(point.X >= bounds->X && point.X < bounds->X + bounds->Width &&
+              point.Y >= bounds->Y && point.Y < bounds->Y + bounds->Height))
+            continue;
+
+        if (interpolation == InterpolationModeNearestNeighbor)
+        {
+            x = floorf(point.X + pixel_offset);
+            y = floorf(point.Y + pixel_offset);
+            if (x >= min_x && x < max_x && y >= min_y && y < max_y)
+            {
+                *dst = src[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
+                continue;
+            }
+        }
+        else
+        {
+            leftxf = floorf(point.X);
+            topyf = floorf(point.Y);
+            x = leftxf;
+            y = topyf;
+            rightx = ceilf(point.X);
+            bottomy = ceilf(point.Y);
+            if (x >= min_x && rightx < max_x && y >= min_y && bottomy < max_y)
+            {
+                top = src + (x - src_rect->X) + (y - src_rect->Y) * src_rect->Width;
+                bottom = top + (bottomy - y) * src_rect->Width;
+
+                if (x == rightx && y == bottomy)
+                    *dst = top[0];
+                else
+                    *dst = blend_colors(blend_colors(top[0], top[rightx - x], point.X - leftxf),
+                                        blend_colors(bottom[0], bottom[rightx - x], point.X - leftxf),
+                                        point.Y - topyf);
+                continue;
+            }
+        }
+
+        *dst = resample_bitmap_pixel(src_rect, bits, width, height, &point, attributes,
+                                     interpolation, offset_mode);
+    }
+}
+
 static REAL intersect_line_scanline(const GpPointF *p1, const GpPointF *p2, REAL y)
 {
     return (p1->X - p2->X) * (p2->Y - y) / (p2->Y - p1->Y) + p2->X;
@@ -3263,7 +3337,7 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             RECT dst_area;
             GpRectF graphics_bounds;
             GpRect src_area;
-            int i, x, y, src_stride, dst_stride;
+            int i, y, src_stride, dst_stride;
             LPBYTE src_data, dst_data, dst_dyn_data=NULL;
             BitmapData lockeddata;
             InterpolationMode interpolation = graphics->interpolation;
@@ -3348,7 +3422,8 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 REAL m11, m12, m21, m22, mdx, mdy;
                 REAL x_dx, x_dy, y_dx, y_dy;
                 ARGB *dst_color;
-                GpPointF src_pointf_row, src_pointf;
+                GpPointF src_pointf_row;
+                GpRectF src_bounds;
 
                 m11 = (ptf[1].X - ptf[0].X) / srcwidth;
                 m12 = (ptf[1].Y - ptf[0].Y) / srcwidth;
@@ -3384,18 +3459,18 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
                 src_pointf_row.Y = dst_to_src.matrix[5] +
                                    dst_area.left * x_dy + dst_area.top * y_dy;
 
+                src_bounds.X = srcx;
+                src_bounds.Y = srcy;
+                src_bounds.Width = srcwidth;
+                src_bounds.Height = srcheight;
+
                 for (y = dst_area.top; y < dst_area.bottom;
                      y++, src_pointf_row.X += y_dx, src_pointf_row.Y += y_dy)
                 {
-                    for (x = dst_area.left, src_pointf = src_pointf_row; x < dst_area.right;
-                         x++, src_pointf.X += x_dx, src_pointf.Y += x_dy)
-                    {
-                        if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth &&
-                            src_pointf.Y >= srcy && src_pointf.Y < srcy + srcheight)
-                            *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                               imageAttributes, interpolation, offset_mode);
-                        dst_color++;
-                    }
+                    resample_bitmap_row(&src_area, src_data, bitmap->width, bitmap->height, src_pointf_row,
+                                        x_dx, x_dy, &src_bounds, dst_color, dst_area.right - dst_area.left,
+                                        imageAttributes, interpolation, offset_mode);
+                    dst_color += dst_area.right - dst_area.left;
                 }
             }
             else
@@ -223,6 +223,26 @@ static const char manifest4[] =
 "</dependency>"
 "</assembly>";
 
+static const char manifest_sxscache[] =
+"<assembly xmlns=\"urn:schemas-microsoft-com:asm.v1\" manifestVersion=\"1.0\">"
+"<assemblyIdentity version=\"1.2.3.4\" name=\"Wine.Test\" type=\"win32\">"
+"</assemblyIdentity>"
+"<dependency>"
+"<dependentAssembly>"
+"<assemblyIdentity type=\"win32\" name=\"Wine.Test.SxsCache\" "
+    "version=\"1.0.0.0\" processorArchitecture=\"" ARCH "\" publicKeyToken=\"0123456789abcdef\">"
+"</assemblyIdentity>"
+"</dependentAssembly>"
+"</dependency>"
+"</assembly>";
+
+static const char sxscache_manifest[] =
+"<assembly xmlns=\"urn:schemas-microsoft-com:asm.v1\" manifestVersion=\"1.0\">"
+"<assemblyIdentity type=\"win32\" name=\"Wine.Test.SxsCache\" "
+    "version=\"1.0.0.0\" processorArchitecture=\"" ARCH "\" publicKeyToken=\"0123456789abcdef\">"
+"</assemblyIdentity>"
+"</assembly>";
+
 static const char manifest5[] =
 "<assembly xmlns=\"urn:schemas-microsoft-com:asm.v1\" manifestVersion=\"1.0\">"
 "<assemblyIdentity version=\"1.2.3.4\" name=\"Wine.Test\" type=\"win32\">"
@@ -2560,6 +2580,95 @@ static void test_actctx(void)
     test_allowDelayedBinding();
 }
 
+static void get_manifest_path(HANDLE handle, DWORD id, WCHAR *path, DWORD len)
+{
+    ACTIVATION_CONTEXT_ASSEMBLY_DETAILED_INFORMATION *info;
+    SIZE_T size = 0;
+    BOOL b;
+
+    path[0] = 0;
+    b = QueryActCtxW(0, handle, &id, AssemblyDetailedInformationInActivationContext, NULL, 0, &size);
+    ok(!b && GetLastError() == ERROR_INSUFFICIENT_BUFFER, "got %d, error %lu\n", b, GetLastError());
+    info = HeapAlloc(GetProcessHeap(), 0, size);
+    b = QueryActCtxW(0, handle, &id, AssemblyDetailedInformationInActivationContext, info, size, &size);
+    ok(b, "QueryActCtx failed: %lu\n", GetLastError());
+    if (b && info->lpAssemblyManifestPath) lstrcpynW(path, info->lpAssemblyManifestPath, len);
+    HeapFree(GetProcessHeap(), 0, info);
+}
+
+static void test_winsxs_lookup(void)
+{
+    WCHAR path[MAX_PATH], path2[MAX_PATH];
+    char sxs_path[MAX_PATH];
+    HANDLE handle, handle2, file;
+    DWORD size;
+
+    /* resolving the same dependency again finds the same manifest */
+    if (!create_manifest_file("test4.manifest", manifest4, -1, NULL, NULL))
+    {
+        skip("Could not create manifest file\n");
+        return;
+    }
+    handle = test_create("test4.manifest");
+    ok(handle != INVALID_HANDLE_VALUE, "CreateActCtx failed: %lu\n", GetLastError());
+    handle2 = test_create("test4.manifest");
+    ok(handle2 != INVALID_HANDLE_VALUE, "CreateActCtx failed: %lu\n", GetLastError());
+    DeleteFileA("test4.manifest");
+    if (handle != INVALID_HANDLE_VALUE && handle2 != INVALID_HANDLE_VALUE)
+    {
+        get_manifest_path(handle, 2, path, ARRAY_SIZE(path));
+        get_manifest_path(handle2, 2, path2, ARRAY_SIZE(path2));
+        ok(path[0], "got empty manifest path\n");
+        ok(!lstrcmpW(path, path2), "got %s and %s\n", wine_dbgstr_w(path), wine_dbgstr_w(path2));
+    }
+    if (handle != INVALID_HANDLE_VALUE) ReleaseActCtx(handle);
+    if (handle2 != INVALID_HANDLE_VALUE) ReleaseActCtx(handle2);
+
+    /* and a missing dependency stays missing */
+    create_manifest_file("sxscache.manifest", manifest_sxscache, -1, NULL, NULL);
+    handle = test_create("sxscache.manifest");
+    ok(handle == INVALID_HANDLE_VALUE, "CreateActCtx succeeded\n");
+    ok(GetLastError() == ERROR_SXS_CANT_GEN_ACTCTX, "got error %lu\n", GetLastError());
+    handle = test_create("sxscache.manifest");
+    ok(handle == INVALID_HANDLE_VALUE, "CreateActCtx succeeded\n");
+    ok(GetLastError() == ERROR_SXS_CANT_GEN_ACTCTX, "got error %lu\n", GetLastError());
+
+    /* manifests added to or removed from winsxs are noticed */
+    if (!winetest_platform_is_wine)
+    {
+        skip("winsxs manifests are only looked up by file name on Wine\n");
+        DeleteFileA("sxscache.manifest");
+        return;
+    }
+    GetWindowsDirectoryA(sxs_path, MAX_PATH);
+    strcat(sxs_path, "\\winsxs\\manifests\\" ARCH "_wine.test.sxscache_0123456789abcdef_1.0.0.0_none_deadbeef.manifest");
+    file = CreateFileA(sxs_path, GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        skip("Could not create %s: %lu\n", debugstr_a(sxs_path), GetLastError());
+        DeleteFileA("sxscache.manifest");
+        return;
+    }
+    WriteFile(file, sxscache_manifest, strlen(sxscache_manifest), &size, NULL);
+    CloseHandle(file);
+
+    handle = test_create("sxscache.manifest");
+    ok(handle != INVALID_HANDLE_VALUE, "CreateActCtx failed: %lu\n", GetLastError());
+    if (handle != INVALID_HANDLE_VALUE)
+    {
+        get_manifest_path(handle, 2, path, ARRAY_SIZE(path));
+        ok(!!wcsstr(path, L"wine.test.sxscache"), "got %s\n", wine_dbgstr_w(path));
+        ReleaseActCtx(handle);
+    }
+
+    DeleteFileA(sxs_path);
+    handle = test_create("sxscache.manifest");
+    ok(handle == INVALID_HANDLE_VALUE, "CreateActCtx succeeded\n");
+    ok(GetLastError() == ERROR_SXS_CANT_GEN_ACTCTX, "got error %lu\n", GetLastError());
+    if (handle != INVALID_HANDLE_VALUE) ReleaseActCtx(handle);
+    DeleteFileA("sxscache.manifest");
+}
+
 static void test_app_manifest(void)
 {
     HANDLE handle;
@@ -4525,6 +4634,7 @@ START_TEST(actctx)
     test_create_fail();
     test_CreateActCtx();
     test_CreateActCtx_share_mode();
+    test_winsxs_lookup();
     test_findsectionstring();
     test_ZombifyActCtx();
     run_child_process();
@@ -3772,6 +3772,155 @@ static int append_weights( const struct sortguid *sortid, DWORD flags,
     return ret;
 }
 
+/* get the weights of a character that produces exactly one weight at each of the primary,
+ * diacritic and case levels, which is the case for most ASCII characters */
+static BOOL get_simple_weights( WCHAR c, UINT except, DWORD flags, BYTE case_mask, union char_weights *weights )
+{
+    if (c >= 0x80) return FALSE;
+    *weights = get_char_weights( c, except );
+    if (weights->_case & CASE_COMPR_6) return FALSE;
+    if (weights->script == SCRIPT_PUNCTUATION)
+    {
+        if (!(flags & SORT_STRINGSORT)) return FALSE;
+    }
+    else if (weights->script < SCRIPT_SYMBOL_1 || weights->script >= SCRIPT_PUA_FIRST) return FALSE;
+    weights->_case &= case_mask;
+    return TRUE;
+}
+
+static BOOL is_simple_string( const struct sortguid *sortid, DWORD flags, BYTE case_mask, UINT except,
+                              const WCHAR *src, int srclen )
+{
+    union char_weights weights;
+    int i;
+
+    if (flags & (NORM_IGNORESYMBOLS | LINGUISTIC_IGNORECASE | LINGUISTIC_IGNOREDIACRITIC | SORT_DIGITSASNUMBERS))
+        return FALSE;
+    if (sortid->flags & FLAG_REVERSEDIACRITICS) return FALSE;
+    for (i = 0; i < srclen; i++) if (!get_simple_weights( src[i], except, flags, case_mask, &weights )) return FALSE;
+    return TRUE;
+}
+
+static BYTE get_simple_level_weight( WCHAR c, UINT except, DWORD flags, BYTE case_mask, BOOL is_case )
+{
+    union char_weights weights;
+
+    get_simple_weights( c, except, flags, case_mask, &weights );
+    return is_case ? weights._case : weights.diacritic;
+}
+
+/* length of the diacritic or case key once trailing default weights are removed */
+static int get_simple_level_len( const WCHAR *src, int srclen, UINT except, DWORD flags, BYTE case_mask,
+                                 BOOL is_case )
+{
+    while (srclen && get_simple_level_weight( src[srclen - 1], except, flags, case_mask, is_case ) <= 2) srclen--;
+    return srclen;
+}
+
+static int put_simple_level( BYTE *dst, int dstlen, int pos, const WCHAR *src, int srclen, UINT except,
+                             DWORD flags, BYTE case_mask, BOOL is_case )
+{
+    int i, len = get_simple_level_len( src, srclen, except, flags, case_mask, is_case );
+
+    if (dstlen > pos + len)
+    {
+        for (i = 0; i < len; i++) dst[pos + i] = get_simple_level_weight( src[i], except, flags, case_mask, is_case );
+        dst[pos + len] = 0x01;
+    }
+    return pos + len + 1;
+}
+
+/* LCMAP_SORTKEY for strings where is_simple_string() is true */
+static int get_simple_sortkey( DWORD flags, BYTE case_mask, UINT except, const WCHAR *src, int srclen,
+                               BYTE *dst, int dstlen )
+{
+    union char_weights weights;
+    int i, ret = 0;
+
+    if (dstlen > 2 * srclen)
+    {
+        for (i = 0; i < srclen; i++)
+        {
+            get_simple_weights( src[i], except, flags, case_mask, &weights );
+            dst[2 * i] = weights.script;
+            dst[2 * i + 1] = weights.primary;
+        }
+        dst[2 * srclen] = 0x01;
+    }
+    ret = 2 * srclen + 1;
+
+    if (flags & NORM_IGNORENONSPACE)
+    {
+        if (dstlen > ret) dst[ret] = 0x01;
+        ret++;
+    }
+    else ret = put_simple_level( dst, dstlen, ret, src, srclen, except, flags, case_mask, FALSE );
+    ret = put_simple_level( dst, dstlen, ret, src, srclen, except, flags, case_mask, TRUE );
+
+    /* no extra weights, and an empty special key */
+    if (dstlen > ret) dst[ret] = 0x01;
+    ret++;
+    if (dstlen > ret) dst[ret] = 0;
+    return ret + 1;
+}
+
+/* compare the diacritic or case level of two strings of the same length */
+static int compare_simple_level( const WCHAR *src1, const WCHAR *src2, int srclen, UINT except, DWORD flags,
+                                 BYTE case_mask, BOOL is_case )
+{
+    int i, len1 = get_simple_level_len( src1, srclen, except, flags, case_mask, is_case );
+    int len2 = get_simple_level_len( src2, srclen, except, flags, case_mask, is_case );
+
+    for (i = 0; i < min( len1, len2 ); i++)
+    {
+        BYTE w1 = get_simple_level_weight( src1[i], except, flags, case_mask, is_case );
+        BYTE w2 = get_simple_level_weight( src2[i], except, flags, case_mask, is_case );
+        if (w1 != w2) return w1 - w2;
+    }
+    return len1 - len2;
+}
+
+/* compare strings made of characters with simple weights without building the sort keys,
+ * return FALSE if the full comparison is needed */
+static BOOL compare_simple_string( const struct sortguid *sortid, DWORD flags, BYTE case_mask, UINT except,
+                                   const WCHAR *src1, int srclen1, const WCHAR *src2, int srclen2, int *ret )
+{
+    union char_weights w1, w2;
+    int i, len = min( srclen1, srclen2 );
+
+    if (flags & (NORM_IGNORESYMBOLS | LINGUISTIC_IGNORECASE | LINGUISTIC_IGNOREDIACRITIC | SORT_DIGITSASNUMBERS))
+        return FALSE;
+    if (sortid->flags & FLAG_REVERSEDIACRITICS) return FALSE;
+
+    /* characters following the first primary difference can't change the result */
+    for (i = 0; i < len; i++)
+    {
+        if (!get_simple_weights( src1[i], except, flags, case_mask, &w1 )) return FALSE;
+        if (!get_simple_weights( src2[i], except, flags, case_mask, &w2 )) return FALSE;
+        if (w1.script != w2.script)
+        {
+            *ret = w1.script - w2.script;
+            return TRUE;
+        }
+        if (w1.primary != w2.primary)
+        {
+            *ret = w1.primary - w2.primary;
+            return TRUE;
+        }
+    }
+
+    /* the remaining characters of the longer string must all have a primary weight */
+    for (i = len; i < srclen1; i++) if (!get_simple_weights( src1[i], except, flags, case_mask, &w1 )) return FALSE;
+    for (i = len; i < srclen2; i++) if (!get_simple_weights( src2[i], except, flags, case_mask, &w2 )) return FALSE;
+    if ((*ret = srclen1 - srclen2)) return TRUE;
+
+    if (!(flags & NORM_IGNORENONSPACE) &&
+        (*ret = compare_simple_level( src1, src2, len, except, flags, case_mask, FALSE )))
+        return TRUE;
+    *ret = compare_simple_level( src1, src2, len, except, flags, case_mask, TRUE );
+    return TRUE;
+}
+
 /* implementation of LCMAP_SORTKEY */
 static int get_sortkey( const struct sortguid *sortid, DWORD flags,
                         const WCHAR *src, int srclen, BYTE *dst, int dstlen )
@@ -3790,6 +3939,12 @@ static int get_sortkey( const struct sortguid *sortid, DWORD flags,
     if (flags & NORM_IGNOREKANATYPE) case_mask &= ~CASE_KATAKANA;
     if ((flags & NORM_LINGUISTIC_CASING) && except && sortid->ling_except) except = sortid->ling_except;
 
+    if (is_simple_string( sortid, flags, case_mask, except, src, srclen ))
+    {
+        ret = get_simple_sortkey( flags, case_mask, except, src, srclen, dst, dstlen );
+        goto done;
+    }
+
     init_sortkey_state( &s, flags, srclen, primary_buf, sizeof(primary_buf) );
 
     while (pos < srclen)
@@ -3815,6 +3970,7 @@ static int get_sortkey( const struct sortguid *sortid, DWORD flags,
 
     free_sortkey_state( &s );
 
+done:
     if (dstlen && dstlen < ret)
     {
         SetLastError( ERROR_INSUFFICIENT_BUFFER );
@@ -3846,6 +4002,8 @@ static int compare_string( const struct sortguid *sortid, DWORD flags,
     if (flags & NORM_IGNOREKANATYPE) case_mask &= ~CASE_KATAKANA;
     if ((flags & NORM_LINGUISTIC_CASING) && except && sortid->ling_except) except = sortid->ling_except;
 
+    if (compare_simple_string( sortid, flags, case_mask, except, src1, srclen1, src2, srclen2, &ret )) return ret;
+
     init_sortkey_state( &s1, flags, srclen1, primary1, sizeof(primary1) );
     init_sortkey_state( &s2, flags, srclen2, primary2, sizeof(primary2) );
 
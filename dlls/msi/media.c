@@ -104,6 +104,232 @@ static void CDECL cabinet_free(void *pv)
     free(pv);
 }
 
+/* Files extracted from a cabinet are buffered in memory and written out on the thread
+ * pool, so that decompressing the next file overlaps with writing the previous ones. */
+#define MAX_BUFFERED_FILE_SIZE  (4 * 1024 * 1024)
+#define MAX_PENDING_WRITE_SIZE  (64 * 1024 * 1024)
+
+struct file_write
+{
+    struct list entry;
+    MSICABDATA *owner;
+    HANDLE      handle;
+    WCHAR      *path;
+    FILETIME    time;
+    BYTE       *data;
+    SIZE_T      size;
+    SIZE_T      capacity;
+    BOOL        direct;  /* too large to buffer, written as it is extracted */
+};
+
+/* FDI write callbacks only get a file handle, this list is used to find the
+ * extraction a handle belongs to */
+static struct list extractions = LIST_INIT( extractions );
+
+static CRITICAL_SECTION extractions_cs;
+static CRITICAL_SECTION_DEBUG extractions_cs_debug =
+{
+    0, 0, &extractions_cs,
+    { &extractions_cs_debug.ProcessLocksList,
+      &extractions_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": extractions_cs") }
+};
+static CRITICAL_SECTION extractions_cs = { &extractions_cs_debug, -1, 0, 0, 0, 0 };
+
+static void free_file_write( struct file_write *write )
+{
+    free( write->path );
+    free( write->data );
+    free( write );
+}
+
+static BOOL write_data( HANDLE handle, const BYTE *data, SIZE_T size )
+{
+    DWORD written;
+
+    while (size)
+    {
+        if (!WriteFile( handle, data, min( size, 0x10000000 ), &written, NULL )) return FALSE;
+        data += written;
+        size -= written;
+    }
+    return TRUE;
+}
+
+static void set_current_write( MSICABDATA *data, struct file_write *write )
+{
+    EnterCriticalSection( &extractions_cs );
+    data->current_write = write;
+    LeaveCriticalSection( &extractions_cs );
+}
+
+/* the returned write is only ever freed by the thread extracting to the handle */
+static struct file_write *find_current_write( HANDLE handle )
+{
+    struct file_write *ret = NULL;
+    MSICABDATA *data;
+
+    EnterCriticalSection( &extractions_cs );
+    LIST_FOR_EACH_ENTRY( data, &extractions, MSICABDATA, entry )
+    {
+        if (data->current_write && data->current_write->handle == handle)
+        {
+            ret = data->current_write;
+            break;
+        }
+    }
+    LeaveCriticalSection( &extractions_cs );
+    return ret;
+}
+
+static void CALLBACK write_file_callback( TP_CALLBACK_INSTANCE *instance, void *context )
+{
+    struct file_write *write = context;
+    MSICABDATA *data = write->owner;
+    DWORD err = ERROR_SUCCESS;
+
+    if (!write_data( write->handle, write->data, write->size ) ||
+        !SetFileTime( write->handle, &write->time, NULL, &write->time ))
+    {
+        err = GetLastError();
+        ERR( "failed to write %s (error %lu)\n", debugstr_w(write->path), err );
+    }
+    CloseHandle( write->handle );
+
+    EnterCriticalSection( &data->write_cs );
+    if (err && !data->write_error) data->write_error = err;
+    list_remove( &write->entry );
+    data->pending_write_size -= write->size;
+    WakeAllConditionVariable( &data->write_cv );
+    LeaveCriticalSection( &data->write_cs );
+
+    free_file_write( write );
+}
+
+static void begin_file_write( MSICABDATA *data, HANDLE handle, WCHAR *path )
+{
+    struct file_write *write;
+
+    if (!(write = calloc( 1, sizeof(*write) )))
+    {
+        free( path );
+        return;
+    }
+    write->owner = data;
+    write->handle = handle;
+    write->path = path;
+    set_current_write( data, write );
+}
+
+static UINT buffer_file_data( struct file_write *write, const void *data, UINT size )
+{
+    if (!write->direct && write->size + size > write->capacity)
+    {
+        SIZE_T capacity = max( write->capacity * 2, 0x10000 );
+        BYTE *new_data;
+
+        while (capacity < write->size + size) capacity *= 2;
+        if (capacity > MAX_BUFFERED_FILE_SIZE || !(new_data = realloc( write->data, capacity )))
+        {
+            /* write what has been buffered so far, and the rest of the file directly */
+            TRACE( "writing %s directly\n", debugstr_w(write->path) );
+            if (!write_data( write->handle, write->data, write->size )) return 0;
+            free( write->data );
+            write->data = NULL;
+            write->size = write->capacity = 0;
+            write->direct = TRUE;
+        }
+        else
+        {
+            write->data = new_data;
+            write->capacity = capacity;
+        }
+    }
+
+    if (write->direct) return write_data( write->handle, data, size ) ? size : 0;
+
+    memcpy( write->data + write->size, data, size );
+    write->size += size;
+    return size;
+}
+
+static void queue_file_write( struct file_write *write, const FILETIME *time )
+{
+    MSICABDATA *data = write->owner;
+
+    write->time = *time;
+
+    EnterCriticalSection( &data->write_cs );
+    while (data->pending_write_size && data->pending_write_size + write->size > MAX_PENDING_WRITE_SIZE)
+        SleepConditionVariableCS( &data->write_cv, &data->write_cs, INFINITE );
+    list_add_tail( &data->pending_writes, &write->entry );
+    data->pending_write_size += write->size;
+    LeaveCriticalSection( &data->write_cs );
+
+    if (!TrySubmitThreadpoolCallback( write_file_callback, write, NULL ))
+        write_file_callback( NULL, write );
+}
+
+/* a file may be extracted more than once, make sure it's not still being written to */
+static void wait_for_file_write( MSICABDATA *data, const WCHAR *path )
+{
+    struct file_write *write;
+
+    EnterCriticalSection( &data->write_cs );
+    for (;;)
+    {
+        LIST_FOR_EACH_ENTRY( write, &data->pending_writes, struct file_write, entry )
+            if (!wcsicmp( write->path, path )) break;
+        if (&write->entry == &data->pending_writes) break;
+        SleepConditionVariableCS( &data->write_cv, &data->write_cs, INFINITE );
+    }
+    LeaveCriticalSection( &data->write_cs );
+}
+
+static void init_file_writes( MSICABDATA *data )
+{
+    InitializeCriticalSectionEx( &data->write_cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
+    data->write_cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": MSICABDATA.write_cs");
+    InitializeConditionVariable( &data->write_cv );
+    list_init( &data->pending_writes );
+    data->pending_write_size = 0;
+    data->write_error = ERROR_SUCCESS;
+    data->current_write = NULL;
+
+    EnterCriticalSection( &extractions_cs );
+    list_add_tail( &extractions, &data->entry );
+    LeaveCriticalSection( &extractions_cs );
+}
+
+/* waits for all pending writes, returns FALSE if any of them failed */
+static BOOL finish_file_writes( MSICABDATA *data )
+{
+    DWORD err;
+
+    EnterCriticalSection( &extractions_cs );
+    list_remove( &data->entry );
+    LeaveCriticalSection( &extractions_cs );
+
+    /* left over if extraction was aborted, the handle has been closed by FDI */
+    if (data->current_write)
+    {
+        free_file_write( data->current_write );
+        data->current_write = NULL;
+    }
+
+    EnterCriticalSection( &data->write_cs );
+    while (!list_empty( &data->pending_writes ))
+        SleepConditionVariableCS( &data->write_cv, &data->write_cs, INFINITE );
+    err = data->write_error;
+    LeaveCriticalSection( &data->write_cs );
+
+    data->write_cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection( &data->write_cs );
+
+    if (err) SetLastError( err );
+    return !err;
+}
+
 static INT_PTR CDECL cabinet_open(char *pszFile, int oflag, int pmode)
 {
     DWORD dwAccess = 0;
@@ -153,8 +379,12 @@ static UINT CDECL cabinet_read(INT_PTR hf, void *pv, UINT cb)
 static UINT CDECL cabinet_write(INT_PTR hf, void *pv, UINT cb)
 {
     HANDLE handle = (HANDLE)hf;
+    struct file_write *write;
     DWORD written;
 
+    if ((write = find_current_write( handle )))
+        return buffer_file_data( write, pv, cb );
+
     if (WriteFile(handle, pv, cb, &written, NULL))
         return written;
 
@@ -418,6 +648,8 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
 
     TRACE("extracting %s -> %s\n", debugstr_w(data->curfile), debugstr_w(path));
 
+    wait_for_file_write( data, path );
+
     attrs = attrs & (FILE_ATTRIBUTE_READONLY|FILE_ATTRIBUTE_HIDDEN|FILE_ATTRIBUTE_SYSTEM);
     if (!attrs) attrs = FILE_ATTRIBUTE_NORMAL;
 
@@ -478,7 +710,10 @@ static INT_PTR cabinet_copy_file(FDINOTIFICATIONTYPE fdint,
     }
 
 done:
-    free(path);
+    if (handle && handle != INVALID_HANDLE_VALUE)
+        begin_file_write( data, handle, path );
+    else
+        free(path);
 
     return (INT_PTR)handle;
 }
@@ -487,29 +722,35 @@ static INT_PTR cabinet_close_file_info(FDINOTIFICATIONTYPE fdint,
                                        PFDINOTIFICATION pfdin)
 {
     MSICABDATA *data = pfdin->pv;
+    struct file_write *write = data->current_write;
     FILETIME ft;
     FILETIME ftLocal;
     HANDLE handle = (HANDLE)pfdin->hf;
 
     data->mi->is_continuous = FALSE;
 
-    if (!DosDateTimeToFileTime(pfdin->date, pfdin->time, &ft))
-    {
-        CloseHandle(handle);
-        return -1;
-    }
-    if (!LocalFileTimeToFileTime(&ft, &ftLocal))
+    if (write && write->handle != handle) write = NULL;
+    set_current_write( data, NULL );
+
+    if (!DosDateTimeToFileTime(pfdin->date, pfdin->time, &ft) ||
+        !LocalFileTimeToFileTime(&ft, &ftLocal))
     {
+        if (write && !write->direct && !write_data( handle, write->data, write->size ))
+            ERR( "failed to write %s (error %lu)\n", debugstr_w(write->path), GetLastError() );
+        if (write) free_file_write( write );
         CloseHandle(handle);
         return -1;
     }
-    if (!SetFileTime(handle, &ftLocal, 0, &ftLocal))
+
+    if (write)
+        queue_file_write( write, &ftLocal );
+    else
     {
+        BOOL ret = SetFileTime(handle, &ftLocal, 0, &ftLocal);
         CloseHandle(handle);
-        return -1;
+        if (!ret) return -1;
     }
 
-    CloseHandle(handle);
     data->cb(data->package, data->curfile, MSICABEXTRACT_FILEEXTRACTED, NULL, NULL, data->user);
 
     free(data->curfile);
@@ -639,11 +880,22 @@ static BOOL extract_cabinet_stream( MSIPACKAGE *package, MSIMEDIAINFO *mi, LPVOI
  */
 BOOL msi_cabextract(MSIPACKAGE* package, MSIMEDIAINFO *mi, LPVOID data)
 {
+    BOOL ret;
+
+    init_file_writes( data );
+
     if (mi->cabinet[0] == '#')
+        ret = extract_cabinet_stream( package, mi, data );
+    else
+        ret = extract_cabinet( package, mi, data );
+
+    if (!finish_file_writes( data ) && ret)
     {
-        return extract_cabinet_stream( package, mi, data );
+        ERR("failed to write extracted files\n");
+        mi->is_extracted = FALSE;
+        ret = FALSE;
     }
-    return extract_cabinet( package, mi, data );
+    return ret;
 }
 
 void msi_free_media_info(MSIMEDIAINFO *mi)
@@ -226,7 +226,7 @@ typedef struct _column_info
     struct _column_info *next;
 } column_info;
 
-typedef const struct tagMSICOLUMNHASHENTRY *MSIITERHANDLE;
+typedef UINT MSIITERHANDLE;
 
 typedef struct tagMSIVIEWOPS
 {
@@ -323,6 +323,17 @@ typedef struct tagMSIVIEWOPS
      */
     UINT (*delete)( struct tagMSIVIEW * );
 
+    /*
+     * find_matching_rows - iterates through rows that match a value
+     *
+     *  The value is compared to the data returned by fetch_int, so a string
+     *   ID has to be passed in for string columns.
+     *  The handle keeps track of the current position in the iteration. It
+     *   must be initialised to zero before the first call and passed in to
+     *   subsequent calls.
+     */
+    UINT (*find_matching_rows)( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row, MSIITERHANDLE *handle );
+
     /*
      * add_ref - increases the reference count of the table
      */
@@ -1129,6 +1140,8 @@ typedef BOOL (*PMSICABEXTRACTCB)(MSIPACKAGE *, LPCWSTR, DWORD, LPWSTR *, DWORD *
 #define MSICABEXTRACT_BEGINEXTRACT  0x01
 #define MSICABEXTRACT_FILEEXTRACTED 0x02
 
+struct file_write;
+
 typedef struct
 {
     MSIPACKAGE* package;
@@ -1136,6 +1149,15 @@ typedef struct
     PMSICABEXTRACTCB cb;
     LPWSTR curfile;
     PVOID user;
+
+    /* write-behind state, set up by msi_cabextract */
+    struct list entry;
+    CRITICAL_SECTION write_cs;
+    CONDITION_VARIABLE write_cv;
+    struct list pending_writes;
+    SIZE_T pending_write_size;
+    DWORD write_error;
+    struct file_write *current_write;
 } MSICABDATA;
 
 extern UINT ready_media(MSIPACKAGE *package, BOOL compressed, MSIMEDIAINFO *mi);
@@ -38,13 +38,17 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msidb);
 
-#define MSITABLE_HASH_TABLE_SIZE 37
-
-struct column_hash_entry
-{
-    struct column_hash_entry *next;
-    UINT value;
-    UINT row;
+/* hash index over the values of a column, built on first lookup and kept
+ * up to date when rows are inserted or modified */
+struct column_index
+{
+    UINT  bits;       /* log2 of the number of buckets */
+    UINT  row_count;  /* number of indexed rows */
+    UINT  capacity;   /* number of rows the index has room for */
+    UINT *tails;      /* last row + 1 for each bucket, 0 if empty */
+    UINT *next;       /* for each row, next row + 1 with a value in the same bucket */
+    UINT *prev;       /* for each row, previous row + 1 with a value in the same bucket */
+    UINT  buckets[1]; /* first row + 1 for each bucket, 0 if empty */
 };
 
 struct column_info
@@ -54,7 +58,7 @@ struct column_info
     LPCWSTR colname;
     UINT    type;
     UINT    offset;
-    struct column_hash_entry **hash_table;
+    struct column_index *index;
 };
 
 struct tagMSITABLE
@@ -358,7 +362,18 @@ end:
 static void free_colinfo( struct column_info *colinfo, UINT count )
 {
     UINT i;
-    for (i = 0; i < count; i++) free( colinfo[i].hash_table );
+    for (i = 0; i < count; i++) free( colinfo[i].index );
+}
+
+static void free_column_indexes( MSITABLE *table )
+{
+    UINT i;
+
+    for (i = 0; i < table->col_count; i++)
+    {
+        free( table->colinfo[i].index );
+        table->colinfo[i].index = NULL;
+    }
 }
 
 static void free_table( MSITABLE *table )
@@ -687,7 +702,7 @@ static UINT get_tablecolumns( MSIDATABASE *db, const WCHAR *szTableName, struct
             colinfo[col - 1].type = read_table_int( table->data, i, table->colinfo[3].offset,
                                                     sizeof(USHORT) ) - (1 << 15);
             colinfo[col - 1].offset = 0;
-            colinfo[col - 1].hash_table = NULL;
+            colinfo[col - 1].index = NULL;
         }
         n++;
     }
@@ -757,7 +772,7 @@ UINT msi_create_table( MSIDATABASE *db, LPCWSTR name, column_info *col_info,
         table->colinfo[ i ].colname = msi_string_lookup( db->strings, col_id, NULL );
         table->colinfo[ i ].type = col->type;
         table->colinfo[ i ].offset = 0;
-        table->colinfo[ i ].hash_table = NULL;
+        table->colinfo[ i ].index = NULL;
     }
     table_calc_column_offsets( db, table->colinfo, table->col_count);
 
@@ -1156,8 +1171,60 @@ static UINT TABLE_fetch_stream( struct tagMSIVIEW *view, UINT row, UINT col, ISt
 }
 
 /* Set a table value, i.e. preadjusted integer or string ID. */
+static inline UINT hash_value( UINT value, UINT bits )
+{
+    return (value * 0x9e3779b1) >> (32 - bits);
+}
+
+/* add row to its bucket chain, chains are sorted by row and new rows usually go last */
+static void index_link( struct column_index *index, UINT row, UINT value )
+{
+    UINT h = hash_value( value, index->bits ), p = index->tails[h], n = 0;
+
+    while (p > row + 1)
+    {
+        n = p;
+        p = index->prev[p - 1];
+    }
+    index->prev[row] = p;
+    index->next[row] = n;
+    if (p) index->next[p - 1] = row + 1;
+    else index->buckets[h] = row + 1;
+    if (n) index->prev[n - 1] = row + 1;
+    else index->tails[h] = row + 1;
+}
+
+static void index_unlink( struct column_index *index, UINT row, UINT value )
+{
+    UINT h = hash_value( value, index->bits ), p = index->prev[row], n = index->next[row];
+
+    if (p) index->next[p - 1] = n;
+    else index->buckets[h] = n;
+    if (n) index->prev[n - 1] = p;
+    else index->tails[h] = p;
+}
+
+/* make room for a new row and add it with its current value */
+static void index_insert_row( struct column_index *index, UINT row, UINT value )
+{
+    UINT i;
+
+    for (i = 0; i < 2u << index->bits; i++)
+        if (index->buckets[i] > row) index->buckets[i]++;
+    for (i = 0; i < index->row_count; i++)
+    {
+        if (index->next[i] > row) index->next[i]++;
+        if (index->prev[i] > row) index->prev[i]++;
+    }
+    memmove( index->next + row + 1, index->next + row, (index->row_count - row) * sizeof(UINT) );
+    memmove( index->prev + row + 1, index->prev + row, (index->row_count - row) * sizeof(UINT) );
+    index->row_count++;
+    index_link( index, row, value );
+}
+
 static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val )
 {
+    struct column_index *index = NULL;
     UINT offset, n, i;
 
     if( !tv->table )
@@ -1176,9 +1243,6 @@ static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val
         return ERROR_FUNCTION_FAILED;
     }
 
-    free( tv->columns[col-1].hash_table );
-    tv->columns[col-1].hash_table = NULL;
-
     n = bytes_per_column( tv->db, &tv->columns[col - 1], LONG_STR_BYTES );
     if ( n != 2 && n != 3 && n != 4 )
     {
@@ -1187,9 +1251,21 @@ static UINT table_set_bytes( struct table_view *tv, UINT row, UINT col, UINT val
     }
 
     offset = tv->columns[col-1].offset;
+    if (col <= tv->table->col_count && (index = tv->table->colinfo[col-1].index))
+    {
+        if (index->row_count == tv->table->row_count)
+            index_unlink( index, row, read_table_int( tv->table->data, row, offset, n ) );
+        else
+        {
+            free( index );
+            tv->table->colinfo[col-1].index = index = NULL;
+        }
+    }
+
     for ( i = 0; i < n; i++ )
         tv->table->data[row][offset + i] = (val >> i * 8) & 0xff;
 
+    if (index) index_link( index, row, read_table_int( tv->table->data, row, offset, n ) );
     return ERROR_SUCCESS;
 }
 
@@ -1601,6 +1677,73 @@ static UINT TABLE_get_column_info( struct tagMSIVIEW *view,
     return ERROR_SUCCESS;
 }
 
+static struct column_index *get_column_index( struct table_view *tv, UINT col )
+{
+    struct column_info *colinfo = &tv->table->colinfo[col - 1];
+    struct column_index *index = colinfo->index;
+    UINT i, n, bits, capacity, row_count = tv->table->row_count;
+
+    if (index && index->row_count == row_count) return index;
+    free( index );
+    colinfo->index = NULL;
+
+    /* leave room for inserted rows, the index is rebuilt when it's full */
+    capacity = max( 16, row_count * 2 );
+    for (bits = 4; bits < 24 && (1u << bits) < capacity; bits++)
+        ;
+    index = malloc( offsetof( struct column_index, buckets[2 << bits] ) + 2 * capacity * sizeof(UINT) );
+    if (!index) return NULL;
+
+    index->bits = bits;
+    index->row_count = row_count;
+    index->capacity = capacity;
+    index->tails = index->buckets + (1 << bits);
+    index->next = index->buckets + (2 << bits);
+    index->prev = index->next + capacity;
+    memset( index->buckets, 0, (2 << bits) * sizeof(UINT) );
+
+    n = bytes_per_column( tv->db, colinfo, LONG_STR_BYTES );
+    for (i = 0; i < row_count; i++)
+        index_link( index, i, read_table_int( tv->table->data, i, colinfo->offset, n ) );
+
+    TRACE( "built index for %s.%s, %u rows\n", debugstr_w(tv->name), debugstr_w(colinfo->colname), row_count );
+    colinfo->index = index;
+    return index;
+}
+
+static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row,
+                                      MSIITERHANDLE *handle )
+{
+    struct table_view *tv = (struct table_view *)view;
+    const struct column_index *index;
+    UINT n, offset, next;
+
+    TRACE( "view %p, col %u, val %#x, handle %u\n", view, col, val, *handle );
+
+    if (!tv->table || !col || col > tv->table->col_count)
+        return ERROR_INVALID_PARAMETER;
+
+    if (!(index = get_column_index( tv, col )))
+        return ERROR_OUTOFMEMORY;
+
+    if (*handle > index->row_count)
+        return ERROR_NO_MORE_ITEMS;
+
+    n = bytes_per_column( tv->db, &tv->table->colinfo[col - 1], LONG_STR_BYTES );
+    offset = tv->table->colinfo[col - 1].offset;
+
+    next = *handle ? index->next[*handle - 1] : index->buckets[hash_value( val, index->bits )];
+    while (next && read_table_int( tv->table->data, next - 1, offset, n ) != val)
+        next = index->next[next - 1];
+
+    if (!next)
+        return ERROR_NO_MORE_ITEMS;
+
+    *row = next - 1;
+    *handle = next;
+    return ERROR_SUCCESS;
+}
+
 static UINT table_find_row( struct table_view *, MSIRECORD *, UINT *, UINT * );
 
 static UINT table_validate_new( struct table_view *tv, MSIRECORD *rec, UINT *column )
@@ -1722,6 +1865,29 @@ static int find_insert_index( struct table_view *tv, MSIRECORD *rec, BOOL tempor
     return high + 1;
 }
 
+/* add the new row to the column indexes, they are rebuilt on next use when full */
+static void insert_index_row( struct table_view *tv, UINT row )
+{
+    struct column_info *colinfo;
+    UINT i, n;
+
+    for (i = 0; i < tv->table->col_count; i++)
+    {
+        colinfo = &tv->table->colinfo[i];
+        if (!colinfo->index) continue;
+
+        if (colinfo->index->row_count + 1 != tv->table->row_count ||
+            colinfo->index->row_count == colinfo->index->capacity)
+        {
+            free( colinfo->index );
+            colinfo->index = NULL;
+            continue;
+        }
+        n = bytes_per_column( tv->db, colinfo, LONG_STR_BYTES );
+        index_insert_row( colinfo->index, row, read_table_int( tv->table->data, row, colinfo->offset, n ) );
+    }
+}
+
 static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row, BOOL temporary )
 {
     struct table_view *tv = (struct table_view *)view;
@@ -1752,6 +1918,7 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
 
     /* Re-set the persistence flag */
     tv->table->data_persistent[row] = !temporary;
+    insert_index_row( tv, row );
     return TABLE_set_row( view, row, rec, (1<<tv->num_cols) - 1 );
 }
 
@@ -1775,12 +1942,7 @@ static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
     num_rows = tv->table->row_count;
     tv->table->row_count--;
 
-    /* reset the hash tables */
-    for (i = 0; i < tv->num_cols; i++)
-    {
-        free(tv->columns[i].hash_table);
-        tv->columns[i].hash_table = NULL;
-    }
+    free_column_indexes( tv->table );
 
     for (i = row + 1; i < num_rows; i++)
     {
@@ -1964,6 +2126,7 @@ static UINT TABLE_remove_column(struct tagMSIVIEW *view, UINT number)
     if (tv->table->colinfo[number-1].type & MSITYPE_TEMPORARY)
     {
         UINT size = tv->table->colinfo[number-1].offset;
+        free( tv->table->colinfo[number-1].index );
         tv->table->col_count--;
         tv->table->colinfo = realloc(tv->table->colinfo, sizeof(*tv->table->colinfo) * tv->table->col_count);
 
@@ -2075,7 +2238,7 @@ static UINT TABLE_add_column(struct tagMSIVIEW *view, LPCWSTR column,
     colinfo[tv->table->col_count].colname = msi_string_lookup( tv->db->strings, col_id, NULL );
     colinfo[tv->table->col_count].type = type;
     colinfo[tv->table->col_count].offset = 0;
-    colinfo[tv->table->col_count].hash_table = NULL;
+    colinfo[tv->table->col_count].index = NULL;
     tv->table->col_count++;
 
     table_calc_column_offsets( tv->db, tv->table->colinfo, tv->table->col_count);
@@ -2198,6 +2361,7 @@ static const MSIVIEWOPS table_ops =
     TABLE_get_column_info,
     TABLE_modify,
     TABLE_delete,
+    TABLE_find_matching_rows,
     TABLE_add_ref,
     TABLE_release,
     TABLE_add_column,
@@ -2779,6 +2943,7 @@ static const MSIVIEWOPS transform_view_ops =
     NULL,
     NULL,
     NULL,
+    NULL,
     NULL
 };
 
@@ -3165,12 +3330,30 @@ static UINT row_matches( struct table_view *tv, UINT row, const UINT *data, UINT
 
 static UINT table_find_row( struct table_view *tv, MSIRECORD *rec, UINT *row, UINT *column )
 {
-    UINT i, r = ERROR_FUNCTION_FAILED, *data;
+    MSIITERHANDLE handle = 0;
+    UINT i, key, r = ERROR_FUNCTION_FAILED, *data;
 
     data = record_to_row( tv, rec );
     if( !data )
         return r;
-    for( i = 0; i < tv->table->row_count; i++ )
+
+    /* only the rows matching the first key column need to be checked */
+    for (key = 0; key < tv->num_cols; key++)
+        if (tv->columns[key].type & MSITYPE_KEY) break;
+
+    if (key < tv->table->col_count && get_column_index( tv, key + 1 ))
+    {
+        while (TABLE_find_matching_rows( &tv->view, key + 1, data[key], &i, &handle ) == ERROR_SUCCESS)
+        {
+            r = row_matches( tv, i, data, column );
+            if( r == ERROR_SUCCESS )
+            {
+                *row = i;
+                break;
+            }
+        }
+    }
+    else for( i = 0; i < tv->table->row_count; i++ )
     {
         r = row_matches( tv, i, data, column );
         if( r == ERROR_SUCCESS )
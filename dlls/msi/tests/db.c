@@ -9365,6 +9365,113 @@ static void test_viewfetch_wraparound(void)
     DeleteFileA(msifile);
 }
 
+static void test_indexed_lookup(void)
+{
+    MSIHANDLE hdb, view, rec;
+    char query[256];
+    UINT r, i;
+
+    hdb = create_db();
+    ok( hdb, "failed to create db\n" );
+
+    r = run_query( hdb, 0, "CREATE TABLE `Item` (`Key` SHORT NOT NULL, `Name` CHAR(32), `Value` LONG "
+                           "PRIMARY KEY `Key`)" );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    r = run_query( hdb, 0, "CREATE TABLE `Ref` (`Name` CHAR(32) NOT NULL, `Item` SHORT PRIMARY KEY `Name`)" );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+
+    for (i = 0; i < 300; i++)
+    {
+        sprintf( query, "INSERT INTO `Item` (`Key`, `Name`, `Value`) VALUES (%u, 'item%u', %d)",
+                 i, i % 10, (int)i - 150 );
+        r = run_query( hdb, 0, query );
+        ok( r == ERROR_SUCCESS, "got %u\n", r );
+    }
+    for (i = 0; i < 5; i++)
+    {
+        sprintf( query, "INSERT INTO `Ref` (`Name`, `Item`) VALUES ('ref%u', %u)", 4 - i, i * 70 );
+        r = run_query( hdb, 0, query );
+        ok( r == ERROR_SUCCESS, "got %u\n", r );
+    }
+
+    r = do_query( hdb, "SELECT `Name`, `Value` FROM `Item` WHERE `Key` = 123", &rec );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    check_record( rec, 2, "item3", "-27" );
+    MsiCloseHandle( rec );
+
+    r = do_query( hdb, "SELECT `Key` FROM `Item` WHERE `Value` = -150", &rec );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    check_record( rec, 1, "0" );
+    MsiCloseHandle( rec );
+
+    r = do_query( hdb, "SELECT `Key` FROM `Item` WHERE `Key` = 300", &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    r = do_query( hdb, "SELECT `Key` FROM `Item` WHERE `Name` = 'nothing'", &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+
+    /* markers are numbered in the order they appear in the query */
+    r = MsiDatabaseOpenViewA( hdb, "SELECT `Key` FROM `Item` WHERE `Key` >= ? AND `Name` = ? ORDER BY `Value`", &view );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    rec = MsiCreateRecord( 2 );
+    MsiRecordSetInteger( rec, 1, 250 );
+    MsiRecordSetStringA( rec, 2, "item7" );
+    r = MsiViewExecute( view, rec );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    MsiCloseHandle( rec );
+    for (i = 257; i < 300; i += 10)
+    {
+        r = MsiViewFetch( view, &rec );
+        ok( r == ERROR_SUCCESS, "got %u\n", r );
+        ok( MsiRecordGetInteger( rec, 1 ) == i, "expected %u, got %d\n", i, MsiRecordGetInteger( rec, 1 ) );
+        MsiCloseHandle( rec );
+    }
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+
+    r = MsiDatabaseOpenViewA( hdb, "SELECT `Ref`.`Name`, `Item`.`Value` FROM `Item`, `Ref` "
+                                   "WHERE `Ref`.`Item` = `Item`.`Key` ORDER BY `Ref`.`Name`", &view );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    r = MsiViewExecute( view, 0 );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    for (i = 0; i < 5; i++)
+    {
+        char name[8], value[8];
+
+        sprintf( name, "ref%u", i );
+        sprintf( value, "%d", (int)(4 - i) * 70 - 150 );
+        r = MsiViewFetch( view, &rec );
+        ok( r == ERROR_SUCCESS, "got %u\n", r );
+        check_record( rec, 2, name, value );
+        MsiCloseHandle( rec );
+    }
+    r = MsiViewFetch( view, &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+
+    /* changes to the table are seen by subsequent lookups */
+    r = run_query( hdb, 0, "DELETE FROM `Item` WHERE `Key` = 140" );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    r = run_query( hdb, 0, "UPDATE `Item` SET `Name` = 'changed' WHERE `Key` = 210" );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+
+    r = do_query( hdb, "SELECT `Ref`.`Name` FROM `Item`, `Ref` WHERE `Item`.`Key` = `Ref`.`Item` AND `Item`.`Key` = 140", &rec );
+    ok( r == ERROR_NO_MORE_ITEMS, "got %u\n", r );
+    r = do_query( hdb, "SELECT `Key` FROM `Item` WHERE `Name` = 'changed'", &rec );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    check_record( rec, 1, "210" );
+    MsiCloseHandle( rec );
+    r = do_query( hdb, "SELECT `Value` FROM `Item` WHERE `Key` = 299", &rec );
+    ok( r == ERROR_SUCCESS, "got %u\n", r );
+    check_record( rec, 1, "149" );
+    MsiCloseHandle( rec );
+
+    MsiCloseHandle( hdb );
+    DeleteFileA( msifile );
+}
+
 START_TEST(db)
 {
     test_msidatabase();
@@ -9425,4 +9532,5 @@ START_TEST(db)
     test_viewmodify_insert();
     test_view_get_error();
     test_viewfetch_wraparound();
+    test_indexed_lookup();
 }
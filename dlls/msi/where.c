@@ -41,7 +41,7 @@ WINE_DEFAULT_DEBUG_CHANNEL(msidb);
 struct row_entry
 {
     struct tagMSIWHEREVIEW *wv; /* used during sorting */
-    UINT values[1];
+    UINT values[1];             /* row of each table, followed by the sort keys */
 };
 
 struct join_table
@@ -56,7 +56,6 @@ struct join_table
 typedef struct tagMSIORDERINFO
 {
     UINT col_count;
-    UINT error;
     union ext_column columns[1];
 } MSIORDERINFO;
 
@@ -124,6 +123,7 @@ static inline UINT find_row(MSIWHEREVIEW *wv, UINT row, UINT *(values[]))
 
 static UINT add_row(MSIWHEREVIEW *wv, UINT vals[])
 {
+    UINT i, r, key_count = wv->order_info ? wv->order_info->col_count : 0;
     struct row_entry *new;
 
     if (wv->reorder_size <= wv->row_count)
@@ -140,16 +140,31 @@ static UINT add_row(MSIWHEREVIEW *wv, UINT vals[])
         wv->reorder_size = newsize;
     }
 
-    new = malloc(offsetof(struct row_entry, values[wv->table_count]));
+    new = malloc(offsetof(struct row_entry, values[wv->table_count + key_count]));
 
     if (!new)
         return ERROR_OUTOFMEMORY;
 
-    wv->reorder[wv->row_count++] = new;
-
     memcpy(new->values, vals, wv->table_count * sizeof(UINT));
     new->wv = wv;
 
+    /* fetch the sort keys once, rather than for every comparison */
+    for (i = 0; i < key_count; i++)
+    {
+        const union ext_column *column = &wv->order_info->columns[i];
+        struct join_table *table = column->parsed.table;
+
+        r = table->view->ops->fetch_int(table->view, vals[table->table_index], column->parsed.column,
+                                        &new->values[wv->table_count + i]);
+        if (r != ERROR_SUCCESS)
+        {
+            free(new);
+            return r;
+        }
+    }
+
+    wv->reorder[wv->row_count++] = new;
+
     return ERROR_SUCCESS;
 }
 
@@ -647,16 +662,182 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static UINT count_wildcards( const struct expr *expr )
+{
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        return 1;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        return count_wildcards( expr->u.expr.left ) + count_wildcards( expr->u.expr.right );
+    default:
+        return 0;
+    }
+}
+
+static BOOL is_table_column( const struct expr *expr, const struct join_table *table )
+{
+    switch (expr->type)
+    {
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        return expr->u.column.parsed.table == table;
+    default:
+        return FALSE;
+    }
+}
+
+/* Computes the value that a column of the given type must hold to compare equal to
+ * the expression, as returned by fetch_int. Returns ERROR_NOT_FOUND if the value
+ * isn't known yet, and ERROR_NO_MORE_ITEMS if no value of the column can match. */
+static UINT get_lookup_value( MSIWHEREVIEW *wv, const struct expr *expr, int type, MSIRECORD *record,
+                              UINT rec_index, const UINT rows[], UINT *value )
+{
+    const WCHAR *str = NULL;
+    INT ival = 0;
+    UINT val;
+
+    switch (expr->type)
+    {
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        if ((expr->type == EXPR_COL_NUMBER_STRING) != (type == EXPR_COL_NUMBER_STRING))
+            return ERROR_NOT_FOUND;
+        if (expr_fetch_value( &expr->u.column, rows, &val ) != ERROR_SUCCESS)
+            return ERROR_NOT_FOUND;
+        if (expr->type == EXPR_COL_NUMBER_STRING)
+            str = msi_string_lookup( wv->db->strings, val, NULL );
+        else if (expr->type == EXPR_COL_NUMBER32)
+            ival = val - 0x80000000;
+        else
+            ival = val - 0x8000;
+        break;
+
+    case EXPR_UVAL:
+        if (type == EXPR_COL_NUMBER_STRING)
+            return ERROR_NOT_FOUND;
+        ival = expr->u.uval;
+        break;
+
+    case EXPR_SVAL:
+        if (type != EXPR_COL_NUMBER_STRING)
+            return ERROR_NOT_FOUND;
+        str = expr->u.sval;
+        break;
+
+    case EXPR_WILDCARD:
+        if (!record)
+            return ERROR_NOT_FOUND;
+        if (type == EXPR_COL_NUMBER_STRING)
+            str = MSI_RecordGetString( record, rec_index );
+        else
+            ival = MSI_RecordGetInteger( record, rec_index );
+        break;
+
+    default:
+        return ERROR_NOT_FOUND;
+    }
+
+    switch (type)
+    {
+    case EXPR_COL_NUMBER_STRING:
+        /* null and empty strings compare equal */
+        if (!str || !*str)
+            return ERROR_NOT_FOUND;
+        if (msi_string2id( wv->db->strings, str, -1, value ) != ERROR_SUCCESS)
+            return ERROR_NO_MORE_ITEMS;
+        return ERROR_SUCCESS;
+
+    case EXPR_COL_NUMBER32:
+        *value = ival + 0x80000000;
+        return ERROR_SUCCESS;
+
+    default:
+        if (ival < -0x8000 || ival > 0x7fff)
+            return ERROR_NO_MORE_ITEMS;
+        *value = ival + 0x8000;
+        return ERROR_SUCCESS;
+    }
+}
+
+/* Looks for an equality test in the top level conjunction of the condition that
+ * compares a column of the table to a value that is already known, so that only
+ * the matching rows of the table need to be evaluated. */
+static UINT find_lookup( MSIWHEREVIEW *wv, const struct expr *cond, MSIRECORD *record, UINT *rec_index,
+                         const struct join_table *table, const UINT rows[], UINT *col, UINT *value )
+{
+    const struct expr *column, *other;
+    UINT r, base = *rec_index;
+
+    if (cond->type == EXPR_COMPLEX && cond->u.expr.op == OP_AND)
+    {
+        r = find_lookup( wv, cond->u.expr.left, record, rec_index, table, rows, col, value );
+        if (r != ERROR_NOT_FOUND)
+            return r;
+        return find_lookup( wv, cond->u.expr.right, record, rec_index, table, rows, col, value );
+    }
+
+    *rec_index += count_wildcards( cond );
+
+    if ((cond->type != EXPR_COMPLEX && cond->type != EXPR_STRCMP) || cond->u.expr.op != OP_EQ)
+        return ERROR_NOT_FOUND;
+
+    if (is_table_column( cond->u.expr.left, table ))
+    {
+        column = cond->u.expr.left;
+        other = cond->u.expr.right;
+    }
+    else if (is_table_column( cond->u.expr.right, table ))
+    {
+        column = cond->u.expr.right;
+        other = cond->u.expr.left;
+    }
+    else
+        return ERROR_NOT_FOUND;
+
+    if ((cond->type == EXPR_STRCMP) != (column->type == EXPR_COL_NUMBER_STRING))
+        return ERROR_NOT_FOUND;
+
+    /* the column side has no wildcards, so a wildcard on the other side is the next one */
+    r = get_lookup_value( wv, other, column->type, record, base + 1, rows, value );
+    if (r == ERROR_SUCCESS)
+        *col = column->u.column.parsed.column;
+    return r;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, struct join_table **tables,
                              UINT table_rows[] )
 {
-    UINT r = ERROR_FUNCTION_FAILED;
+    struct join_table *table = *tables;
+    UINT r = ERROR_SUCCESS, lookup = ERROR_NOT_FOUND, rec_index = 0, col, value, row = 0, res;
+    MSIITERHANDLE handle = 0;
     INT val;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    if (wv->cond && table->view->ops->find_matching_rows)
+        lookup = find_lookup( wv, wv->cond, record, &rec_index, table, table_rows, &col, &value );
+    if (lookup == ERROR_NO_MORE_ITEMS)
+        return ERROR_SUCCESS;
+
+    for (;;)
     {
+        if (lookup == ERROR_SUCCESS)
+        {
+            res = table->view->ops->find_matching_rows( table->view, col, value, &row, &handle );
+            if (res == ERROR_NO_MORE_ITEMS)
+                break;
+            if (res != ERROR_SUCCESS)
+            {
+                r = res;
+                break;
+            }
+        }
+        else if (row >= table->row_count)
+            break;
+
+        table_rows[table->table_index] = row++;
         val = 0;
         wv->rec_index = 0;
         r = WHERE_evaluate( wv, table_rows, wv->cond, &val, record );
@@ -674,11 +855,13 @@ static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, struct join_ta
             {
                 if (r != ERROR_SUCCESS)
                     break;
-                add_row (wv, table_rows);
+                r = add_row(wv, table_rows);
+                if (r != ERROR_SUCCESS)
+                    break;
             }
         }
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    table_rows[table->table_index] = INVALID_ROW_INDEX;
     return r;
 }
 
@@ -688,7 +871,7 @@ static int __cdecl compare_entry( const void *left, const void *right )
     const struct row_entry *re = *(const struct row_entry **)right;
     const MSIWHEREVIEW *wv = le->wv;
     MSIORDERINFO *order = wv->order_info;
-    UINT i, j, r, l_val, r_val;
+    UINT i, j, l_val, r_val;
 
     assert(le->wv == re->wv);
 
@@ -696,26 +879,8 @@ static int __cdecl compare_entry( const void *left, const void *right )
     {
         for (i = 0; i < order->col_count; i++)
         {
-            const union ext_column *column = &order->columns[i];
-
-            r = column->parsed.table->view->ops->fetch_int(column->parsed.table->view,
-                          le->values[column->parsed.table->table_index],
-                          column->parsed.column, &l_val);
-            if (r != ERROR_SUCCESS)
-            {
-                order->error = r;
-                return 0;
-            }
-
-            r = column->parsed.table->view->ops->fetch_int(column->parsed.table->view,
-                          re->values[column->parsed.table->table_index],
-                          column->parsed.column, &r_val);
-            if (r != ERROR_SUCCESS)
-            {
-                order->error = r;
-                return 0;
-            }
-
+            l_val = le->values[wv->table_count + i];
+            r_val = re->values[wv->table_count + i];
             if (l_val != r_val)
                 return l_val < r_val ? -1 : 1;
         }
@@ -853,14 +1018,8 @@ static UINT WHERE_execute( struct tagMSIVIEW *view, MSIRECORD *record )
 
     r =  check_condition(wv, record, ordered_tables, rows);
 
-    if (wv->order_info)
-        wv->order_info->error = ERROR_SUCCESS;
-
     qsort(wv->reorder, wv->row_count, sizeof(struct row_entry *), compare_entry);
 
-    if (wv->order_info)
-        r = wv->order_info->error;
-
     free(rows);
     free(ordered_tables);
     return r;
@@ -1130,6 +1289,7 @@ static const MSIVIEWOPS where_ops =
     NULL,
     NULL,
     NULL,
+    NULL,
     WHERE_sort,
     NULL,
 };
@@ -1611,11 +1611,11 @@ static void test_StructuredTaskCollection(void)
 {
     HANDLE chore_start_evt, chore_evt1, chore_evt2;
     _StructuredTaskCollection task_coll;
-    struct chore chore1, chore2;
+    struct chore chore1, chore2, chores[64];
     _Cancellation_beacon beacon;
     DWORD main_thread_id;
     Context *context;
-    int status;
+    int status, i;
     DWORD ret;
     BOOL b;
 
@@ -1802,6 +1802,24 @@ static void test_StructuredTaskCollection(void)
     ok(!chore1.executed, "Canceled collection executed chore\n");
     call_func1(p__StructuredTaskCollection_dtor, &task_coll);
 
+    /* test running many chores */
+    call_func2(p__StructuredTaskCollection_ctor, &task_coll, NULL);
+    for (i = 0; i < ARRAY_SIZE(chores); i++)
+    {
+        chore_ctor(&chores[i]);
+        call_func2(p__StructuredTaskCollection__Schedule, &task_coll, &chores[i].chore);
+    }
+    ok(task_coll.count == ARRAY_SIZE(chores), "Wrong chore count: %ld\n", task_coll.count);
+
+    status = p__StructuredTaskCollection__RunAndWait(&task_coll, NULL);
+    ok(status == 1, "_StructuredTaskCollection::_RunAndWait failed: %d\n", status);
+    for (i = 0; i < ARRAY_SIZE(chores); i++)
+    {
+        ok(chores[i].executed, "Chore #%d was not executed\n", i);
+        ok(chores[i].chore.task_collection == NULL, "Chore #%d task collection was not reset\n", i);
+    }
+    call_func1(p__StructuredTaskCollection_dtor, &task_coll);
+
     CloseHandle(chore_start_evt);
     CloseHandle(chore_evt1);
     CloseHandle(chore_evt2);
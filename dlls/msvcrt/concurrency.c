@@ -154,7 +154,12 @@ typedef struct {
     int shutdown_size;
     HANDLE *shutdown_events;
     CRITICAL_SECTION cs;
-    struct list scheduled_chores;
+    struct list scheduled_tasks;
+    TP_WORK *task_work;
+    /* one chore queue per virtual processor, idle threads steal from the others */
+    unsigned int chore_queue_count;
+    struct chore_queue *chore_queues;
+    volatile LONG chore_count;
 } ThreadScheduler;
 extern const vtable_ptr ThreadScheduler_vtable;
 
@@ -225,6 +230,11 @@ struct scheduled_chore {
     _UnrealizedChore *chore;
 };
 
+struct chore_queue {
+    CRITICAL_SECTION cs;
+    struct list chores;
+};
+
 /* keep in sync with msvcp90/msvcp90.h */
 typedef struct cs_queue
 {
@@ -1060,19 +1070,24 @@ static void remove_scheduled_chores(Scheduler *scheduler, const ExternalContextB
 {
     ThreadScheduler *tscheduler = (ThreadScheduler*)scheduler;
     struct scheduled_chore *sc, *next;
+    struct chore_queue *queue;
+    unsigned int i;
 
     if (tscheduler->scheduler.vtable != &ThreadScheduler_vtable)
         return;
 
-    EnterCriticalSection(&tscheduler->cs);
-    LIST_FOR_EACH_ENTRY_SAFE(sc, next, &tscheduler->scheduled_chores,
-                             struct scheduled_chore, entry) {
-        if (sc->chore->task_collection->context == &context->context) {
-            list_remove(&sc->entry);
-            operator_delete(sc);
+    for (i = 0; i < tscheduler->chore_queue_count; i++) {
+        queue = &tscheduler->chore_queues[i];
+        EnterCriticalSection(&queue->cs);
+        LIST_FOR_EACH_ENTRY_SAFE(sc, next, &queue->chores, struct scheduled_chore, entry) {
+            if (sc->chore->task_collection->context == &context->context) {
+                list_remove(&sc->entry);
+                InterlockedDecrement(&tscheduler->chore_count);
+                operator_delete(sc);
+            }
         }
+        LeaveCriticalSection(&queue->cs);
     }
-    LeaveCriticalSection(&tscheduler->cs);
 }
 
 static void ExternalContextBase_dtor(ExternalContextBase *this)
@@ -1402,6 +1417,7 @@ static void ThreadScheduler_dtor(ThreadScheduler *this)
 {
     int i;
     struct scheduled_chore *sc, *next;
+    struct chore_queue *queue;
 
     if(this->ref != 0) WARN("ref = %ld\n", this->ref);
     SchedulerPolicy_dtor(&this->policy);
@@ -1410,14 +1426,25 @@ static void ThreadScheduler_dtor(ThreadScheduler *this)
         SetEvent(this->shutdown_events[i]);
     operator_delete(this->shutdown_events);
 
+    /* callbacks that are still running hold a reference to the work object */
+    if (this->task_work)
+        CloseThreadpoolWork(this->task_work);
+    if (!list_empty(&this->scheduled_tasks))
+        ERR("scheduled task list is not empty\n");
+
     this->cs.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection(&this->cs);
 
-    if (!list_empty(&this->scheduled_chores))
+    if (this->chore_count)
         ERR("scheduled chore list is not empty\n");
-    LIST_FOR_EACH_ENTRY_SAFE(sc, next, &this->scheduled_chores,
-            struct scheduled_chore, entry)
-        operator_delete(sc);
+    for(i=0; i<this->chore_queue_count; i++) {
+        queue = &this->chore_queues[i];
+        LIST_FOR_EACH_ENTRY_SAFE(sc, next, &queue->chores, struct scheduled_chore, entry)
+            operator_delete(sc);
+        queue->cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&queue->cs);
+    }
+    operator_delete(this->chore_queues);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_Id, 4)
@@ -1529,6 +1556,7 @@ DEFINE_THISCALL_WRAPPER(ThreadScheduler_CreateScheduleGroup, 4)
 
 typedef struct
 {
+    struct list entry;
     void (__cdecl *proc)(void*);
     void *data;
     ThreadScheduler *scheduler;
@@ -1536,13 +1564,25 @@ typedef struct
 
 void __cdecl CurrentScheduler_Detach(void);
 
+/* The work object is submitted once per queued task, so every callback
+ * finds at least one task in the list. */
 static void WINAPI schedule_task_proc(PTP_CALLBACK_INSTANCE instance, void *context, PTP_WORK work)
 {
+    ThreadScheduler *scheduler = context;
     schedule_task_arg arg;
     BOOL detach = FALSE;
+    struct list *entry;
 
-    arg = *(schedule_task_arg*)context;
-    operator_delete(context);
+    EnterCriticalSection(&scheduler->cs);
+    entry = list_head(&scheduler->scheduled_tasks);
+    if (entry)
+        list_remove(entry);
+    LeaveCriticalSection(&scheduler->cs);
+    if (!entry)
+        return;
+
+    arg = *LIST_ENTRY(entry, schedule_task_arg, entry);
+    operator_delete(LIST_ENTRY(entry, schedule_task_arg, entry));
 
     if(&arg.scheduler->scheduler != get_current_scheduler()) {
         ThreadScheduler_Attach(arg.scheduler);
@@ -1562,7 +1602,6 @@ void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
 {
     static unsigned int once;
     schedule_task_arg *arg;
-    TP_WORK *work;
 
     if(!once++)
         FIXME("(%p %p %p %p) semi-stub\n", this, proc, data, placement);
@@ -1575,18 +1614,23 @@ void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
     arg->scheduler = this;
     ThreadScheduler_Reference(this);
 
-    work = CreateThreadpoolWork(schedule_task_proc, arg, NULL);
-    if(!work) {
+    EnterCriticalSection(&this->cs);
+    if(!this->task_work)
+        this->task_work = CreateThreadpoolWork(schedule_task_proc, this, NULL);
+    if(!this->task_work) {
         scheduler_resource_allocation_error e;
 
+        LeaveCriticalSection(&this->cs);
         ThreadScheduler_Release(this);
         operator_delete(arg);
         scheduler_resource_allocation_error_ctor_name(&e, NULL,
                 HRESULT_FROM_WIN32(GetLastError()));
         _CxxThrowException(&e, &scheduler_resource_allocation_error_exception_type);
     }
-    SubmitThreadpoolWork(work);
-    CloseThreadpoolWork(work);
+    list_add_tail(&this->scheduled_tasks, &arg->entry);
+    LeaveCriticalSection(&this->cs);
+
+    SubmitThreadpoolWork(this->task_work);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask, 12)
@@ -1629,6 +1673,7 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
         const SchedulerPolicy *policy)
 {
     SYSTEM_INFO si;
+    unsigned int i;
 
     TRACE("(%p)->()\n", this);
 
@@ -1648,7 +1693,17 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
     InitializeCriticalSectionEx(&this->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
     this->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler");
 
-    list_init(&this->scheduled_chores);
+    list_init(&this->scheduled_tasks);
+    this->task_work = NULL;
+
+    this->chore_count = 0;
+    this->chore_queue_count = max(this->virt_proc_no, 1);
+    this->chore_queues = operator_new(this->chore_queue_count * sizeof(*this->chore_queues));
+    for(i=0; i<this->chore_queue_count; i++) {
+        InitializeCriticalSectionEx(&this->chore_queues[i].cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+        this->chore_queues[i].cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler.chore_queues");
+        list_init(&this->chore_queues[i].chores);
+    }
     return this;
 }
 
@@ -2134,7 +2189,9 @@ void __thiscall _StructuredTaskCollection__Cancel(
     void *prev_exception, *new_exception;
     struct scheduled_chore *sc, *next;
     LONG removed = 0, finished = 1;
+    struct chore_queue *queue;
     struct beacon *beacon;
+    unsigned int i;
 
     TRACE("(%p)\n", this);
 
@@ -2162,17 +2219,20 @@ void __thiscall _StructuredTaskCollection__Cancel(
     }
     LeaveCriticalSection(&((ExternalContextBase*)this->context)->beacons_cs);
 
-    EnterCriticalSection(&scheduler->cs);
-    LIST_FOR_EACH_ENTRY_SAFE(sc, next, &scheduler->scheduled_chores,
-                             struct scheduled_chore, entry) {
-        if (sc->chore->task_collection != this)
-            continue;
-        sc->chore->task_collection = NULL;
-        list_remove(&sc->entry);
-        removed++;
-        operator_delete(sc);
+    for (i = 0; i < scheduler->chore_queue_count; i++) {
+        queue = &scheduler->chore_queues[i];
+        EnterCriticalSection(&queue->cs);
+        LIST_FOR_EACH_ENTRY_SAFE(sc, next, &queue->chores, struct scheduled_chore, entry) {
+            if (sc->chore->task_collection != this)
+                continue;
+            sc->chore->task_collection = NULL;
+            list_remove(&sc->entry);
+            InterlockedDecrement(&scheduler->chore_count);
+            removed++;
+            operator_delete(sc);
+        }
+        LeaveCriticalSection(&queue->cs);
     }
-    LeaveCriticalSection(&scheduler->cs);
     if (!removed)
         return;
 
@@ -2280,13 +2340,71 @@ static void __cdecl chore_wrapper(_UnrealizedChore *chore)
     __FINALLY_CTX(chore_wrapper_finally, chore)
 }
 
-static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
+static struct chore_queue *get_current_chore_queue(ThreadScheduler *scheduler)
+{
+    ExternalContextBase *ctx = (ExternalContextBase*)try_get_current_context();
+    unsigned int idx = 0;
+
+    if (ctx && ctx->context.vtable == &ExternalContextBase_vtable)
+        idx = ctx->id % scheduler->chore_queue_count;
+    return &scheduler->chore_queues[idx];
+}
+
+/* Takes a chore from the current thread's queue (newest first) or steals one
+ * from the other queues (oldest first). If task_collection is set, only its
+ * chores are considered. */
+static struct scheduled_chore *take_chore(ThreadScheduler *scheduler,
+        const _StructuredTaskCollection *task_collection)
+{
+    struct chore_queue *local = get_current_chore_queue(scheduler), *queue;
+    struct scheduled_chore *sc = NULL, *cur;
+    unsigned int i, start = local - scheduler->chore_queues;
+
+    for (i = 0; i < scheduler->chore_queue_count && !sc; i++)
+    {
+        if (!scheduler->chore_count)
+            return NULL;
+
+        queue = &scheduler->chore_queues[(start + i) % scheduler->chore_queue_count];
+        if (list_empty(&queue->chores))
+            continue;
+
+        EnterCriticalSection(&queue->cs);
+        if (queue == local)
+        {
+            LIST_FOR_EACH_ENTRY(cur, &queue->chores, struct scheduled_chore, entry)
+            {
+                if (task_collection && cur->chore->task_collection != task_collection) continue;
+                sc = cur;
+                break;
+            }
+        }
+        else
+        {
+            LIST_FOR_EACH_ENTRY_REV(cur, &queue->chores, struct scheduled_chore, entry)
+            {
+                if (task_collection && cur->chore->task_collection != task_collection) continue;
+                sc = cur;
+                break;
+            }
+        }
+        if (sc)
+        {
+            list_remove(&sc->entry);
+            InterlockedDecrement(&scheduler->chore_count);
+        }
+        LeaveCriticalSection(&queue->cs);
+    }
+    return sc;
+}
+
+static BOOL pick_and_execute_chore(ThreadScheduler *scheduler,
+        const _StructuredTaskCollection *task_collection)
 {
-    struct list *entry;
     struct scheduled_chore *sc;
     _UnrealizedChore *chore;
 
-    TRACE("(%p)\n", scheduler);
+    TRACE("(%p %p)\n", scheduler, task_collection);
 
     if (scheduler->scheduler.vtable != &ThreadScheduler_vtable)
     {
@@ -2294,15 +2412,9 @@ static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
         return FALSE;
     }
 
-    EnterCriticalSection(&scheduler->cs);
-    entry = list_head(&scheduler->scheduled_chores);
-    if (entry)
-        list_remove(entry);
-    LeaveCriticalSection(&scheduler->cs);
-    if (!entry)
+    if (!(sc = take_chore(scheduler, task_collection)))
         return FALSE;
 
-    sc = LIST_ENTRY(entry, struct scheduled_chore, entry);
     chore = sc->chore;
     operator_delete(sc);
 
@@ -2312,7 +2424,7 @@ static BOOL pick_and_execute_chore(ThreadScheduler *scheduler)
 
 static void __cdecl _StructuredTaskCollection_scheduler_cb(void *data)
 {
-    pick_and_execute_chore((ThreadScheduler*)get_current_scheduler());
+    pick_and_execute_chore((ThreadScheduler*)get_current_scheduler(), NULL);
 }
 
 static bool schedule_chore(_StructuredTaskCollection *this,
@@ -2320,6 +2432,7 @@ static bool schedule_chore(_StructuredTaskCollection *this,
 {
     struct scheduled_chore *sc;
     ThreadScheduler *scheduler;
+    struct chore_queue *queue;
 
     if (chore->task_collection) {
         invalid_multiple_scheduling e;
@@ -2343,9 +2456,11 @@ static bool schedule_chore(_StructuredTaskCollection *this,
     chore->chore_wrapper = chore_wrapper;
     InterlockedIncrement(&this->count);
 
-    EnterCriticalSection(&scheduler->cs);
-    list_add_head(&scheduler->scheduled_chores, &sc->entry);
-    LeaveCriticalSection(&scheduler->cs);
+    queue = get_current_chore_queue(scheduler);
+    EnterCriticalSection(&queue->cs);
+    list_add_head(&queue->chores, &sc->entry);
+    InterlockedIncrement(&scheduler->chore_count);
+    LeaveCriticalSection(&queue->cs);
     *pscheduler = &scheduler->scheduler;
     return TRUE;
 }
@@ -2424,8 +2539,9 @@ _TaskCollectionStatus __stdcall _StructuredTaskCollection__RunAndWait(
 
     if (this->context) {
         ThreadScheduler *scheduler = get_thread_scheduler_from_context(this->context);
+        /* run the chores of this collection that have not been picked up yet inline */
         if (scheduler) {
-            while (pick_and_execute_chore(scheduler)) ;
+            while (pick_and_execute_chore(scheduler, this)) ;
         }
     }
 
@@ -149,6 +149,130 @@ static inline unsigned int log10i(unsigned int x)
     return t - (x < p10s[t]);
 }
 
+static inline ULONGLONG pf_umul128(ULONGLONG a, ULONGLONG b, ULONGLONG *hi)
+{
+    ULONGLONG p0 = (a & 0xffffffff) * (b & 0xffffffff);
+    ULONGLONG p1 = (a & 0xffffffff) * (b >> 32);
+    ULONGLONG p2 = (a >> 32) * (b & 0xffffffff);
+    ULONGLONG mid = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+
+    *hi = (a >> 32) * (b >> 32) + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    return (mid << 32) | (p0 & 0xffffffff);
+}
+
+/* Compares lowest shift bits of 128-bit number with half of 2^shift */
+static inline enum fpmod pf_u128_rem(ULONGLONG hi, ULONGLONG lo, int shift)
+{
+    ULONGLONG half_hi = 0, half_lo = 0;
+
+    if(shift > 64) {
+        hi &= ((ULONGLONG)1 << (shift - 64)) - 1;
+        half_hi = (ULONGLONG)1 << (shift - 65);
+    } else {
+        hi = 0;
+        if(shift < 64) lo &= ((ULONGLONG)1 << shift) - 1;
+        half_lo = (ULONGLONG)1 << (shift - 1);
+    }
+
+    if(!hi && !lo) return FP_ROUND_ZERO;
+    if(hi < half_hi || (hi == half_hi && lo < half_lo)) return FP_ROUND_DOWN;
+    if(hi == half_hi && lo == half_lo) return FP_ROUND_EVEN;
+    return FP_ROUND_UP;
+}
+
+/* Computes floor(m * 2^e2 * 10^q) with 64-bit arithmetic, mod tells how
+ * the dropped part compares to one half. Returns FALSE if it doesn't fit. */
+static inline BOOL pf_scale_fp(ULONGLONG m, int e2, int q, ULONGLONG *ret, enum fpmod *mod)
+{
+    ULONGLONG p5 = 1, hi, lo, d;
+    int i, s = e2 + q;
+
+    /* 5^27 is the largest power of 5 that fits in 63 bits */
+    if(q > 27 || q < -27) return FALSE;
+    for(i = 0; i < (q < 0 ? -q : q); i++) p5 *= 5;
+
+    if(q >= 0) {
+        /* m * 10^q * 2^e2 = m * 5^q * 2^s */
+        lo = pf_umul128(m, p5, &hi);
+        if(s >= 0) {
+            if(hi || s >= 64 || (lo >> (63 - s)) >> 1) return FALSE;
+            *ret = lo << s;
+            *mod = FP_ROUND_ZERO;
+            return TRUE;
+        }
+
+        s = -s;
+        if(s >= 128) {
+            *ret = 0;
+            *mod = FP_ROUND_DOWN;
+            return TRUE;
+        }
+        if(s >= 64) {
+            *ret = hi >> (s - 64);
+        } else {
+            if(hi >> s) return FALSE;
+            *ret = (lo >> s) | (hi << (64 - s));
+        }
+        *mod = pf_u128_rem(hi, lo, s);
+        return TRUE;
+    }
+
+    /* m * 10^q * 2^e2 = m * 2^s / 5^-q */
+    if(s >= 0) {
+        if(s >= 64 || (m >> (63 - s)) >> 1) return FALSE;
+        lo = m << s;
+        d = p5;
+    } else {
+        if(-s >= 64 || (p5 >> (63 + s)) >> 1) return FALSE;
+        lo = m;
+        d = p5 << -s;
+    }
+    *ret = lo / d;
+    lo %= d;
+    if(!lo) *mod = FP_ROUND_ZERO;
+    else if(lo < d - lo) *mod = FP_ROUND_DOWN;
+    else if(lo == d - lo) *mod = FP_ROUND_EVEN;
+    else *mod = FP_ROUND_UP;
+    return TRUE;
+}
+
+/* Rounds m * 2^e2 to the number of digits printed in given format. On success
+ * the printed value is *digits * 10^-*scale, and it fits in 64 bits. */
+static inline BOOL pf_round_fp(ULONGLONG m, int e2, int format, int precision,
+        BOOL standard_rounding, ULONGLONG *digits, int *scale)
+{
+    ULONGLONG n, p10 = 1;
+    enum fpmod mod;
+    int i, q, e10, sig;
+
+    if(format == 'f' || format == 'F') {
+        q = precision;
+        if(!pf_scale_fp(m, e2, q, &n, &mod)) return FALSE;
+    } else {
+        sig = ((format == 'g' || format == 'G') && precision) ? precision : precision + 1;
+        if(sig > 19) return FALSE;
+        for(i = 1; i < sig; i++) p10 *= 10;
+
+        /* m has MANT_BITS bits, the estimate is exact or one too small */
+        e10 = floor((e2 + MANT_BITS - 1) * 0.30102999566398120);
+        for(i = 0; ; i++) {
+            q = sig - 1 - e10;
+            if(!pf_scale_fp(m, e2, q, &n, &mod)) return FALSE;
+            if(n >= p10 && n / 10 < p10) break;
+            if(i) return FALSE;
+            e10 += n < p10 ? -1 : 1;
+        }
+    }
+
+    if(mod == FP_ROUND_UP || (mod == FP_ROUND_EVEN && (!standard_rounding || (n & 1)))) {
+        if(n == ~(ULONGLONG)0) return FALSE;
+        n++;
+    }
+    *digits = n;
+    *scale = q;
+    return TRUE;
+}
+
 #endif
 
 static inline int FUNC_NAME(pf_output_wstr)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx,
@@ -611,7 +735,7 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
     BOOL trim_tail = FALSE, round_up = FALSE;
     pf_flags f;
     int limb_len, prec;
-    ULONGLONG m;
+    ULONGLONG m = 0;
     DWORD l;
 
     if(flags->Precision == -1)
@@ -621,12 +745,35 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
     if(v) {
         m = (ULONGLONG)1 << (MANT_BITS - 1);
         m |= (*(ULONGLONG*)&v & (((ULONGLONG)1 << (MANT_BITS - 1)) - 1));
+        e2 -= MANT_BITS;
+    }
+
+    if(v && pf_round_fp(m, e2, flags->Format, flags->Precision, standard_rounding, &m, &i)) {
+        /* Store already rounded value, rounding below will find nothing to do.
+         * Radix point needs to be placed on limb boundary. */
+        b->b = 0;
+        b->size = BNUM_PREC64;
+        if(m) {
+            r = i % LIMB_DIGITS;
+            r = r > 0 ? LIMB_DIGITS - r : -r;
+            b->data[0] = m % p10s[LIMB_DIGITS - r] * p10s[r];
+            m /= p10s[LIMB_DIGITS - r];
+            for(b->e = 1; m; b->e++) {
+                b->data[b->e] = m % LIMB_MAX;
+                m /= LIMB_MAX;
+            }
+            e10 = LIMB_DIGITS * (b->e - 2) - i - r;
+        } else {
+            b->e = 1;
+            b->data[0] = 0;
+            e10 = -LIMB_DIGITS;
+        }
+    } else if(v) {
         b->b = 0;
         b->e = 2;
         b->size = BNUM_PREC64;
         b->data[0] = m % LIMB_MAX;
         b->data[1] = m / LIMB_MAX;
-        e2 -= MANT_BITS;
 
         while(e2 > 0) {
             int shift = e2 > 29 ? 29 : e2;
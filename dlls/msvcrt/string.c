@@ -742,6 +742,77 @@ static inline BOOL bnum_to_mant(struct bnum *b, ULONGLONG *m)
     return TRUE;
 }
 
+/* First 19 significant digits of parsed number, used to avoid bnum arithmetic
+ * when the value can be converted exactly with 64-bit integers. */
+struct dec_mant
+{
+    ULONGLONG m;
+    int digits;
+    BOOL inexact;
+};
+
+static inline void dec_mant_add(struct dec_mant *d, wchar_t ch)
+{
+    if (d->digits < 19)
+    {
+        d->m = d->m * 10 + ch - '0';
+        d->digits++;
+    }
+    else if (ch != '0')
+    {
+        d->inexact = TRUE;
+    }
+}
+
+/* Converts m * 10^e10 to binary, rounding information is exact since
+ * the remainder of the division is known. */
+static BOOL fpnum_from_dec_mant(const struct dec_mant *d, int sign, int dp, struct fpnum *ret)
+{
+    int e10 = dp - d->digits, e2 = 0;
+    ULONGLONG m = d->m, div, q, r;
+    enum fpmod mod;
+
+    if (d->inexact || !m || dp < -18 || dp > 38) return FALSE;
+
+    if (e10 >= 0)
+    {
+        if (e10 > 19) return FALSE;
+        for (; e10; e10--)
+        {
+            if (m > UI64_MAX / 10) return FALSE;
+            m *= 10;
+        }
+        *ret = fpnum(sign, 0, m, FP_ROUND_ZERO);
+        return TRUE;
+    }
+
+    /* divisor has to fit in 63 bits for the remainder shifts below */
+    if (e10 < -18) return FALSE;
+    for (div = 1; e10; e10++) div *= 10;
+
+    q = m / div;
+    r = m % div;
+    while (!(q >> 63))
+    {
+        q <<= 1;
+        r <<= 1;
+        e2--;
+        if (r >= div)
+        {
+            r -= div;
+            q |= 1;
+        }
+    }
+
+    if (!r) mod = FP_ROUND_ZERO;
+    else if (r > div - r) mod = FP_ROUND_UP;
+    else if (r == div - r) mod = FP_ROUND_EVEN;
+    else mod = FP_ROUND_DOWN;
+
+    *ret = fpnum(sign, e2, q, mod);
+    return TRUE;
+}
+
 static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
         void *ctx, pthreadlocinfo locinfo, BOOL ldouble, struct bnum *b)
 {
@@ -754,6 +825,8 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     BOOL found_digit = FALSE, found_dp = FALSE, found_sign = FALSE;
     int e2 = 0, dp=0, sign=1, off, limb_digits = 0, i;
     enum fpmod round = FP_ROUND_ZERO;
+    struct dec_mant dec = { 0 };
+    struct fpnum ret;
     wchar_t nch;
     ULONGLONG m;
 
@@ -826,11 +899,13 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
 
         b->data[bnum_idx(b, b->b)] = b->data[bnum_idx(b, b->b)] * 10 + nch - '0';
         limb_digits++;
+        dec_mant_add(&dec, nch);
         nch = get(ctx);
         dp++;
     }
     while(nch>='0' && nch<='9') {
         if(nch != '0') b->data[bnum_idx(b, b->b)] |= 1;
+        dec_mant_add(&dec, nch);
         nch = get(ctx);
         dp++;
     }
@@ -862,10 +937,12 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
 
         b->data[bnum_idx(b, b->b)] = b->data[bnum_idx(b, b->b)] * 10 + nch - '0';
         limb_digits++;
+        dec_mant_add(&dec, nch);
         nch = get(ctx);
     }
     while(nch>='0' && nch<='9') {
         if(nch != '0') b->data[bnum_idx(b, b->b)] |= 1;
+        dec_mant_add(&dec, nch);
         nch = get(ctx);
     }
 
@@ -917,6 +994,9 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     if(!b->data[bnum_idx(b, b->e-1)])
         return fpnum(sign, 0, 0, 0);
 
+    if(fpnum_from_dec_mant(&dec, sign, dp, &ret))
+        return ret;
+
     /* Fill last limb with 0 if needed */
     if(b->b+1 != b->e) {
         for(; limb_digits != LIMB_DIGITS; limb_digits++)
@@ -1560,12 +1640,33 @@ int CDECL _atoldbl(_LDOUBLE *value, char *str)
     return _atoldbl_l( (MSVCRT__LDOUBLE*)value, str, NULL );
 }
 
+/* Helpers for scanning strings a machine word at a time. Reads are aligned,
+ * so they never cross a page boundary even when going past the terminator. */
+#define WORD_ONES  ((uintptr_t)0x0101010101010101ull)
+#define WORD_HIGHS ((uintptr_t)0x8080808080808080ull)
+
+static inline BOOL word_has_zero_byte(uintptr_t v)
+{
+    return ((v - WORD_ONES) & ~v & WORD_HIGHS) != 0;
+}
+
+static inline BOOL word_is_aligned(const void *ptr)
+{
+    return !((uintptr_t)ptr & (sizeof(uintptr_t) - 1));
+}
+
 /*********************************************************************
  *              strlen (MSVCRT.@)
  */
 size_t __cdecl strlen(const char *str)
 {
     const char *s = str;
+
+    for (; !word_is_aligned(s); s++)
+        if (!*s) return s - str;
+
+    while (!word_has_zero_byte(*(const uintptr_t *)s)) s += sizeof(uintptr_t);
+
     while (*s) s++;
     return s - str;
 }
@@ -3249,6 +3350,20 @@ void *__cdecl memset(void *dst, int c, size_t n)
  */
 char* __cdecl strchr(const char *str, int c)
 {
+    uintptr_t v, pattern = WORD_ONES * (unsigned char)c;
+
+    for (; !word_is_aligned(str); str++)
+    {
+        if (*str == (char)c) return (char*)str;
+        if (!*str) return NULL;
+    }
+
+    for (;; str += sizeof(uintptr_t))
+    {
+        v = *(const uintptr_t *)str;
+        if (word_has_zero_byte(v) || word_has_zero_byte(v ^ pattern)) break;
+    }
+
     do
     {
         if (*str == (char)c) return (char*)str;
@@ -3271,9 +3386,16 @@ char* __cdecl strrchr(const char *str, int c)
  */
 void* __cdecl memchr(const void *ptr, int c, size_t n)
 {
+    uintptr_t pattern = WORD_ONES * (unsigned char)c;
     const unsigned char *p = ptr;
 
-    for (p = ptr; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n && !word_is_aligned(p); n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+
+    for (; n >= sizeof(uintptr_t); n -= sizeof(uintptr_t), p += sizeof(uintptr_t))
+        if (word_has_zero_byte(*(const uintptr_t *)p ^ pattern)) break;
+
+    for (; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
     return NULL;
 }
 
@@ -60,6 +60,10 @@ static int (__cdecl *p_memcpy_s)(void *, size_t, const void *, size_t);
 static int (__cdecl *p_memmove_s)(void *, size_t, const void *, size_t);
 static int* (__cdecl *pmemcmp)(void *, const void *, size_t n);
 static int (__cdecl *p_strcmp)(const char *, const char *);
+static size_t (__cdecl *p_strlen)(const char *);
+static char* (__cdecl *p_strchr)(const char *, int);
+static void* (__cdecl *p_memchr)(const void *, int, size_t);
+static size_t (__cdecl *p_wcslen)(const wchar_t *);
 static int (__cdecl *p_strncmp)(const char *, const char *, size_t);
 static int (__cdecl *p_strcpy)(char *dst, const char *src);
 static int (__cdecl *pstrcpy_s)(char *dst, size_t len, const char *src);
@@ -709,6 +713,56 @@ static void test_wcsdup(void)
     ok(errno == 0xdeadbeef, "errno is %d, expected 0xdeadbeef\n", errno);
 }
 
+static void test_string_scan(void)
+{
+    char buf[64];
+    wchar_t bufW[64];
+    unsigned int off, len, pos;
+    void *ret;
+
+    /* all alignments and lengths around machine word boundaries */
+    for (off = 0; off < 8; off++)
+    {
+        for (len = 0; len < 40; len++)
+        {
+            memset(buf, 'a', sizeof(buf));
+            buf[off + len] = 0;
+            ok(p_strlen(buf + off) == len, "off %u, len %u: got %Iu\n", off, len, p_strlen(buf + off));
+
+            for (pos = 0; pos < len; pos++)
+            {
+                buf[off + pos] = 'b';
+                ok(p_strchr(buf + off, 'b') == buf + off + pos, "off %u, len %u, pos %u: got %p\n",
+                        off, len, pos, p_strchr(buf + off, 'b'));
+                ret = p_memchr(buf + off, 'b', len);
+                ok(ret == buf + off + pos, "off %u, len %u, pos %u: got %p\n", off, len, pos, ret);
+                ret = p_memchr(buf + off, 'b', pos);
+                ok(!ret, "off %u, len %u, pos %u: got %p\n", off, len, pos, ret);
+                buf[off + pos] = 'a';
+            }
+            ok(!p_strchr(buf + off, 'b'), "off %u, len %u: found 'b'\n", off, len);
+            ok(p_strchr(buf + off, 0) == buf + off + len, "off %u, len %u: got %p\n",
+                    off, len, p_strchr(buf + off, 0));
+            /* 0x80 and 0xff bytes must not confuse the word scanning */
+            buf[off + len + 1] = 'b';
+            memset(buf + off, 0xff, len);
+            if (len) buf[off] = (char)0x80;
+            ok(p_strlen(buf + off) == len, "off %u, len %u: got %Iu\n", off, len, p_strlen(buf + off));
+            ok(!p_strchr(buf + off, 'b'), "off %u, len %u: found 'b'\n", off, len);
+            ret = p_memchr(buf + off, 'b', len + 2);
+            ok(ret == buf + off + len + 1, "off %u, len %u: got %p\n", off, len, ret);
+
+            memset(bufW, 'a', sizeof(bufW));
+            bufW[off + len] = 0;
+            ok(p_wcslen(bufW + off) == len, "off %u, len %u: got %Iu\n", off, len, p_wcslen(bufW + off));
+            /* unaligned string */
+            memmove((char *)bufW + 1, bufW + off, (len + 1) * sizeof(wchar_t));
+            ok(p_wcslen((const wchar_t *)((char *)bufW + 1)) == len, "off %u, len %u: got %Iu\n", off, len,
+                    p_wcslen((const wchar_t *)((char *)bufW + 1)));
+        }
+    }
+}
+
 static void test_strcmp(void)
 {
     int ret = p_strcmp( "abc", "abcd" );
@@ -2102,6 +2156,13 @@ static void test__strtod(void)
         { ".00", 3, 0 },
         { "-0.", 3, 0 },
         { "0e13", 4, 0 },
+        { "9007199254740993", 16, 9007199254740992.0 },
+        { "9007199254740995", 16, 9007199254740996.0 },
+        { "9007199254740993.0000000000000001", 33, 9007199254740994.0 },
+        { "90071992547409930e-1", 20, 9007199254740992.0 },
+        { "123456789012345678e-18", 22, 0.123456789012345678 },
+        { "0.000001", 8, 1e-6 },
+        { "1844674407370955161.5", 21, 1844674407370955161.5 },
     };
     const char overflow[] = "1d9999999999999999999";
 
@@ -5040,6 +5101,10 @@ START_TEST(string)
     SET(p__mb_cur_max,"__mb_cur_max");
     SET(p_strcpy, "strcpy");
     SET(p_strcmp, "strcmp");
+    SET(p_strlen, "strlen");
+    SET(p_strchr, "strchr");
+    SET(p_memchr, "memchr");
+    SET(p_wcslen, "wcslen");
     SET(p_strncmp, "strncmp");
     pstrcpy_s = (void *)GetProcAddress( hMsvcrt,"strcpy_s" );
     pstrcat_s = (void *)GetProcAddress( hMsvcrt,"strcat_s" );
@@ -5118,6 +5183,7 @@ START_TEST(string)
     test_strdup();
     test_wcsdup();
     test_strcmp();
+    test_string_scan();
     test_strcpy_s();
     test_memcpy_s();
     test_memmove_s();
@@ -2969,7 +2969,24 @@ wchar_t* CDECL wcsrchr(const wchar_t *str, wchar_t ch)
  */
 size_t CDECL wcslen(const wchar_t *str)
 {
+    static const uintptr_t ones = (uintptr_t)0x0001000100010001ull;
+    static const uintptr_t highs = (uintptr_t)0x8000800080008000ull;
     const wchar_t *s = str;
+    uintptr_t v;
+
+    /* scan a machine word at a time, aligned reads never cross a page boundary */
+    if (!((uintptr_t)s & (sizeof(wchar_t) - 1)))
+    {
+        for (; (uintptr_t)s & (sizeof(uintptr_t) - 1); s++)
+            if (!*s) return s - str;
+
+        for (;; s += sizeof(uintptr_t) / sizeof(wchar_t))
+        {
+            v = *(const uintptr_t *)s;
+            if ((v - ones) & ~v & highs) break;
+        }
+    }
+
     while (*s) s++;
     return s - str;
 }
@@ -49,6 +49,15 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msxml);
 
+#define XPATH_CACHE_SIZE 16
+
+struct xpath_cache_entry
+{
+    xmlChar *query;
+    BOOL xpath;
+    xmlXPathCompExprPtr comp;
+};
+
 /* Anything that passes the test_get_ownerDocument()
  * tests can go here (data shared between all instances).
  * We need to preserve this when reloading a document,
@@ -64,8 +73,20 @@ typedef struct {
     LONG selectNsStr_len;
     BOOL XPath;
     IUri *uri;
+    /* compiled selection queries, keyed by query string and language */
+    struct xpath_cache_entry xpath_cache[XPATH_CACHE_SIZE];
+    unsigned int xpath_cache_next;
 } domdoc_properties;
 
+static CRITICAL_SECTION xpath_cache_cs;
+static CRITICAL_SECTION_DEBUG xpath_cache_cs_debug =
+{
+    0, 0, &xpath_cache_cs,
+    { &xpath_cache_cs_debug.ProcessLocksList, &xpath_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": xpath_cache_cs") }
+};
+static CRITICAL_SECTION xpath_cache_cs = { &xpath_cache_cs_debug, -1, 0, 0, 0, 0 };
+
 typedef struct ConnectionPoint ConnectionPoint;
 typedef struct domdoc domdoc;
 
@@ -236,6 +257,79 @@ int registerNamespaces(xmlXPathContextPtr ctxt)
     return n;
 }
 
+static void free_xpath_cache_entry(struct xpath_cache_entry *entry)
+{
+    free(entry->query);
+    if (entry->comp) xmlXPathFreeCompExpr(entry->comp);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static void clear_xpath_cache(domdoc_properties *properties)
+{
+    unsigned int i;
+
+    EnterCriticalSection(&xpath_cache_cs);
+    for (i = 0; i < XPATH_CACHE_SIZE; i++)
+        free_xpath_cache_entry(&properties->xpath_cache[i]);
+    LeaveCriticalSection(&xpath_cache_cs);
+}
+
+/* Compiled queries are removed from the cache while they are being evaluated,
+   so the same expression is never used by two threads at once. */
+xmlXPathCompExprPtr xpath_cache_take(xmlDocPtr doc, const xmlChar *query, BOOL xpath)
+{
+    domdoc_properties *properties = properties_from_xmlDocPtr(doc);
+    xmlXPathCompExprPtr comp = NULL;
+    unsigned int i;
+
+    EnterCriticalSection(&xpath_cache_cs);
+    for (i = 0; i < XPATH_CACHE_SIZE; i++)
+    {
+        struct xpath_cache_entry *entry = &properties->xpath_cache[i];
+
+        if (entry->comp && entry->xpath == xpath && xmlStrEqual(entry->query, query))
+        {
+            comp = entry->comp;
+            entry->comp = NULL;
+            free_xpath_cache_entry(entry);
+            break;
+        }
+    }
+    LeaveCriticalSection(&xpath_cache_cs);
+
+    return comp;
+}
+
+void xpath_cache_put(xmlDocPtr doc, const xmlChar *query, BOOL xpath, xmlXPathCompExprPtr comp)
+{
+    domdoc_properties *properties = properties_from_xmlDocPtr(doc);
+    struct xpath_cache_entry *entry;
+    xmlChar *str;
+    unsigned int i;
+
+    if (!(str = (xmlChar *)strdup((const char *)query)))
+    {
+        xmlXPathFreeCompExpr(comp);
+        return;
+    }
+
+    EnterCriticalSection(&xpath_cache_cs);
+    for (i = 0; i < XPATH_CACHE_SIZE; i++)
+    {
+        entry = &properties->xpath_cache[i];
+        if (entry->comp && entry->xpath == xpath && xmlStrEqual(entry->query, query))
+            break;
+    }
+    if (i == XPATH_CACHE_SIZE)
+        entry = &properties->xpath_cache[properties->xpath_cache_next++ % XPATH_CACHE_SIZE];
+
+    free_xpath_cache_entry(entry);
+    entry->query = str;
+    entry->xpath = xpath;
+    entry->comp = comp;
+    LeaveCriticalSection(&xpath_cache_cs);
+}
+
 static inline void clear_selectNsList(struct list* pNsList)
 {
     select_ns_entry *ns, *ns2;
@@ -280,6 +374,9 @@ static domdoc_properties *create_properties(MSXML_VERSION version)
     /* document uri */
     properties->uri = NULL;
 
+    memset(properties->xpath_cache, 0, sizeof(properties->xpath_cache));
+    properties->xpath_cache_next = 0;
+
     return properties;
 }
 
@@ -319,6 +416,9 @@ static domdoc_properties* copy_properties(domdoc_properties const* properties)
         pcopy->uri = properties->uri;
         if (pcopy->uri)
             IUri_AddRef(pcopy->uri);
+
+        memset(pcopy->xpath_cache, 0, sizeof(pcopy->xpath_cache));
+        pcopy->xpath_cache_next = 0;
     }
 
     return pcopy;
@@ -356,6 +456,7 @@ static void properties_release(domdoc_properties *properties)
         free((xmlChar*)properties->selectNsStr);
         if (properties->uri)
             IUri_Release(properties->uri);
+        clear_xpath_cache(properties);
         free(properties);
     }
 }
@@ -3058,6 +3159,7 @@ static HRESULT WINAPI domdoc_setProperty(
 
         pNsList = &(This->properties->selectNsList);
         clear_selectNsList(pNsList);
+        clear_xpath_cache(This->properties);
         free(nsStr);
         nsStr = xmlchar_from_wchar(bstr);
 
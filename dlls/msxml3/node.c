@@ -1477,23 +1477,51 @@ failed:
     return doc;
 }
 
+/* Returned stylesheet is NULL if document could not be compiled. */
+HRESULT node_compile_stylesheet(IXMLDOMNode *stylesheet, xsltStylesheetPtr *ret)
+{
+    xmlDocPtr sheet_doc;
+    xmlnode *sheet;
+
+    *ret = NULL;
+
+    sheet = get_node_obj(stylesheet);
+    if(!sheet) return E_FAIL;
+
+    sheet_doc = xmlCopyDoc(sheet->node->doc, 1);
+    if (!(*ret = xsltParseStylesheetDoc(sheet_doc)))
+        xmlFreeDoc(sheet_doc);
+
+    return S_OK;
+}
+
 HRESULT node_transform_node_params(const xmlnode *This, IXMLDOMNode *stylesheet, BSTR *p,
     ISequentialStream *stream, const struct xslprocessor_params *params)
 {
     xsltStylesheetPtr xsltSS;
-    xmlDocPtr sheet_doc;
-    HRESULT hr = S_OK;
-    xmlnode *sheet;
+    HRESULT hr;
 
     if (!stylesheet || (!p && !stream)) return E_INVALIDARG;
 
     if (p) *p = NULL;
 
-    sheet = get_node_obj(stylesheet);
-    if(!sheet) return E_FAIL;
+    if (FAILED(hr = node_compile_stylesheet(stylesheet, &xsltSS)))
+        return hr;
+
+    hr = node_transform_node_compiled(This, xsltSS, p, stream, params);
+    if (xsltSS)
+        xsltFreeStylesheet(xsltSS);
+
+    return hr;
+}
+
+HRESULT node_transform_node_compiled(const xmlnode *This, xsltStylesheetPtr xsltSS, BSTR *p,
+    ISequentialStream *stream, const struct xslprocessor_params *params)
+{
+    HRESULT hr = S_OK;
+
+    if (p) *p = NULL;
 
-    sheet_doc = xmlCopyDoc(sheet->node->doc, 1);
-    xsltSS = xsltParseStylesheetDoc(sheet_doc);
     if (xsltSS)
     {
         const char **xslparams = NULL;
@@ -1539,11 +1567,7 @@ HRESULT node_transform_node_params(const xmlnode *This, IXMLDOMNode *stylesheet,
                 hr = node_transform_write_to_bstr(xsltSS, result, p);
             xmlFreeDoc(result);
         }
-
-        xsltFreeStylesheet(xsltSS);
     }
-    else
-        xmlFreeDoc(sheet_doc);
 
     if (p && !*p) *p = SysAllocStringLen(NULL, 0);
 
@@ -52,6 +52,8 @@ WINE_DEFAULT_DEBUG_CHANNEL(msxml);
 
 int registerNamespaces(xmlXPathContextPtr ctxt);
 xmlChar* XSLPattern_to_XPath(xmlXPathContextPtr ctxt, xmlChar const* xslpat_str);
+xmlXPathCompExprPtr xpath_cache_take(xmlDocPtr doc, const xmlChar *query, BOOL xpath);
+void xpath_cache_put(xmlDocPtr doc, const xmlChar *query, BOOL xpath, xmlXPathCompExprPtr comp);
 
 typedef struct
 {
@@ -761,6 +763,32 @@ static void query_serror(void* ctx, const xmlError* err)
     LIBXML2_CALLBACK_SERROR(domselection_create, err);
 }
 
+/* Evaluates query reusing compiled expression from the document cache if possible. */
+static xmlXPathObjectPtr eval_query(xmlXPathContextPtr ctxt, const xmlChar *query, BOOL xpath)
+{
+    xmlXPathCompExprPtr comp;
+    xmlXPathObjectPtr result;
+    xmlChar *pattern_query;
+
+    if (!(comp = xpath_cache_take(ctxt->doc, query, xpath)))
+    {
+        if (xpath)
+            comp = xmlXPathCtxtCompile(ctxt, query);
+        else
+        {
+            if (!(pattern_query = XSLPattern_to_XPath(ctxt, query))) return NULL;
+            comp = xmlXPathCtxtCompile(ctxt, pattern_query);
+            xmlFree(pattern_query);
+        }
+        if (!comp) return NULL;
+    }
+
+    result = xmlXPathCompiledEval(comp, ctxt);
+    xpath_cache_put(ctxt->doc, query, xpath, comp);
+
+    return result;
+}
+
 HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
 {
     domselection *This = malloc(sizeof(domselection));
@@ -793,12 +821,10 @@ HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
     if (is_xpathmode(This->node->doc))
     {
         xmlXPathRegisterAllFunctions(ctxt);
-        This->result = xmlXPathEvalExpression(query, ctxt);
+        This->result = eval_query(ctxt, query, TRUE);
     }
     else
     {
-        xmlChar* pattern_query = XSLPattern_to_XPath(ctxt, query);
-
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"not", xmlXPathNotFunction);
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"boolean", xmlXPathBooleanFunction);
 
@@ -813,8 +839,7 @@ HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"OP_IGt", XSLPattern_OP_IGt);
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"OP_IGEq", XSLPattern_OP_IGEq);
 
-        This->result = xmlXPathEvalExpression(pattern_query, ctxt);
-        xmlFree(pattern_query);
+        This->result = eval_query(ctxt, query, FALSE);
     }
 
     if (!This->result || This->result->type != XPATH_NODESET)
@@ -39,6 +39,14 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msxml);
 
+/* Processors keep a reference while transforming, so replacing the template
+ * stylesheet never frees one that is still in use. */
+struct compiled_stylesheet
+{
+    LONG ref;
+    xsltStylesheetPtr sheet;
+};
+
 typedef struct
 {
     DispatchEx dispex;
@@ -46,8 +54,19 @@ typedef struct
     LONG ref;
 
     IXMLDOMNode *node;
+    /* compiled when stylesheet is set, shared by all processors */
+    struct compiled_stylesheet *compiled;
 } xsltemplate;
 
+static CRITICAL_SECTION template_cs;
+static CRITICAL_SECTION_DEBUG template_cs_debug =
+{
+    0, 0, &template_cs,
+    { &template_cs_debug.ProcessLocksList, &template_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": template_cs") }
+};
+static CRITICAL_SECTION template_cs = { &template_cs_debug, -1, 0, 0, 0, 0 };
+
 enum output_type
 {
     PROCESSOR_OUTPUT_NOT_SET,
@@ -99,11 +118,43 @@ static void xslprocessor_par_free(struct xslprocessor_params *params, struct xsl
     free(par);
 }
 
+static void compiled_stylesheet_release( struct compiled_stylesheet *compiled )
+{
+    if (compiled && !InterlockedDecrement( &compiled->ref ))
+    {
+        xsltFreeStylesheet( compiled->sheet );
+        free( compiled );
+    }
+}
+
 static void xsltemplate_set_node( xsltemplate *This, IXMLDOMNode *node )
 {
-    if (This->node) IXMLDOMNode_Release(This->node);
-    This->node = node;
+    struct compiled_stylesheet *compiled = NULL, *old_compiled;
+    xsltStylesheetPtr sheet;
+    IXMLDOMNode *old_node;
+
+    /* stylesheets that fail to compile are handled by the uncached path */
+    if (node && SUCCEEDED(node_compile_stylesheet( node, &sheet )) && sheet)
+    {
+        if ((compiled = malloc( sizeof(*compiled) )))
+        {
+            compiled->ref = 1;
+            compiled->sheet = sheet;
+        }
+        else
+            xsltFreeStylesheet( sheet );
+    }
     if (node) IXMLDOMNode_AddRef(node);
+
+    EnterCriticalSection( &template_cs );
+    old_node = This->node;
+    old_compiled = This->compiled;
+    This->node = node;
+    This->compiled = compiled;
+    LeaveCriticalSection( &template_cs );
+
+    if (old_node) IXMLDOMNode_Release(old_node);
+    compiled_stylesheet_release( old_compiled );
 }
 
 static HRESULT WINAPI xsltemplate_QueryInterface(
@@ -151,7 +202,7 @@ static ULONG WINAPI xsltemplate_Release( IXSLTemplate *iface )
     TRACE("%p, refcount %lu.\n", iface, ref);
     if ( ref == 0 )
     {
-        if (This->node) IXMLDOMNode_Release( This->node );
+        xsltemplate_set_node( This, NULL );
         free( This );
     }
 
@@ -274,6 +325,7 @@ HRESULT XSLTemplate_create(void **ppObj)
     This->IXSLTemplate_iface.lpVtbl = &XSLTemplateVtbl;
     This->ref = 1;
     This->node = NULL;
+    This->compiled = NULL;
     init_dispex(&This->dispex, (IUnknown*)&This->IXSLTemplate_iface, &xsltemplate_dispex);
 
     *ppObj = &This->IXSLTemplate_iface;
@@ -555,6 +607,33 @@ static HRESULT WINAPI xslprocessor_get_output(
     return S_OK;
 }
 
+static HRESULT xslprocessor_transform_node( xslprocessor *This, ISequentialStream *stream )
+{
+    struct compiled_stylesheet *compiled;
+    IXMLDOMNode *node;
+    HRESULT hr;
+
+    EnterCriticalSection( &template_cs );
+    if ((compiled = This->stylesheet->compiled))
+        InterlockedIncrement( &compiled->ref );
+    if ((node = This->stylesheet->node))
+        IXMLDOMNode_AddRef(node);
+    LeaveCriticalSection( &template_cs );
+
+    if (compiled)
+        hr = node_transform_node_compiled(get_node_obj(This->input), compiled->sheet, &This->outstr, stream,
+                &This->params);
+    else if (node)
+        hr = node_transform_node_params(get_node_obj(This->input), node, &This->outstr, stream,
+                &This->params);
+    else
+        hr = E_INVALIDARG;
+
+    compiled_stylesheet_release( compiled );
+    if (node) IXMLDOMNode_Release(node);
+    return hr;
+}
+
 static HRESULT WINAPI xslprocessor_transform(
     IXSLProcessor *iface,
     VARIANT_BOOL  *ret)
@@ -582,8 +661,7 @@ static HRESULT WINAPI xslprocessor_transform(
 
     SysFreeString(This->outstr);
 
-    hr = node_transform_node_params(get_node_obj(This->input), This->stylesheet->node,
-            &This->outstr, stream, &This->params);
+    hr = xslprocessor_transform_node(This, stream);
     if (SUCCEEDED(hr))
     {
         IStream *src = (IStream *)stream;
@@ -5196,6 +5196,15 @@ if (0)
     ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
     expect_list_and_release(list, "E6.E1.E5.E1.E2.D1 E6.E2.E5.E1.E2.D1");
 
+    /* same query after the prefix was bound to another namespace */
+    hr = IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionNamespaces"),
+        _variantbstr_("xmlns:test='urn:wine-other'"));
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IXMLDOMDocument2_selectNodes(doc, _bstr_("root//test:c"), &list);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    EXPECT_LIST_LEN(list, 0);
+    IXMLDOMNodeList_Release(list);
+
     /* SelectionNamespaces syntax error - the namespaces doesn't work anymore but the value is stored */
     hr = IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionNamespaces"),
         _variantbstr_("xmlns:test='urn:uuid:86B2F87F-ACB6-45cd-8B77-9BDB92A01A29' xmlns:foo=###"));
@@ -9557,6 +9566,94 @@ todo_wine {
     free_bstrs();
 }
 
+static const char template_first_xsl[] =
+"<?xml version=\"1.0\"?>"
+"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\" >"
+"<xsl:output method=\"text\"/>"
+"<xsl:template match=\"/\"><xsl:text>first</xsl:text></xsl:template>"
+"</xsl:stylesheet>";
+
+static const char template_second_xsl[] =
+"<?xml version=\"1.0\"?>"
+"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\" >"
+"<xsl:output method=\"text\"/>"
+"<xsl:template match=\"/\"><xsl:text>second</xsl:text></xsl:template>"
+"</xsl:stylesheet>";
+
+#define check_template_transform(a,b,c) _check_template_transform(a,b,c,__LINE__)
+static void _check_template_transform(IXSLTemplate *template, IXMLDOMDocument *input, const WCHAR *expected,
+        int line)
+{
+    IXSLProcessor *processor;
+    VARIANT_BOOL b;
+    HRESULT hr;
+    VARIANT v;
+
+    hr = IXSLTemplate_createProcessor(template, &processor);
+    ok_(__FILE__,line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    V_VT(&v) = VT_UNKNOWN;
+    V_UNKNOWN(&v) = (IUnknown *)input;
+    hr = IXSLProcessor_put_input(processor, v);
+    ok_(__FILE__,line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    b = VARIANT_FALSE;
+    hr = IXSLProcessor_transform(processor, &b);
+    ok_(__FILE__,line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok_(__FILE__,line)(b == VARIANT_TRUE, "got %d\n", b);
+
+    V_VT(&v) = VT_EMPTY;
+    hr = IXSLProcessor_get_output(processor, &v);
+    ok_(__FILE__,line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok_(__FILE__,line)(V_VT(&v) == VT_BSTR, "got type %d\n", V_VT(&v));
+    ok_(__FILE__,line)(!lstrcmpW(V_BSTR(&v), expected), "got %s\n", wine_dbgstr_w(V_BSTR(&v)));
+    VariantClear(&v);
+
+    IXSLProcessor_Release(processor);
+}
+
+static void test_xsltemplate_stylesheet_update(void)
+{
+    IXMLDOMDocument *doc, *input;
+    IXSLTemplate *template;
+    VARIANT_BOOL b;
+    HRESULT hr;
+
+    if (!is_clsid_supported(&CLSID_XSLTemplate, &IID_IXSLTemplate)) return;
+    if (!is_clsid_supported(&CLSID_FreeThreadedDOMDocument, &IID_IXMLDOMDocument)) return;
+
+    template = create_xsltemplate(&IID_IXSLTemplate);
+
+    hr = CoCreateInstance(&CLSID_FreeThreadedDOMDocument, NULL, CLSCTX_INPROC_SERVER, &IID_IXMLDOMDocument, (void**)&doc);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IXMLDOMDocument_loadXML(doc, _bstr_(template_first_xsl), &b);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    input = create_document(&IID_IXMLDOMDocument);
+    hr = IXMLDOMDocument_loadXML(input, _bstr_("<a/>"), &b);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    hr = IXSLTemplate_putref_stylesheet(template, (IXMLDOMNode *)doc);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    check_template_transform(template, input, L"first");
+
+    /* processors share the stylesheet compiled by the template, later changes to the document are not used */
+    hr = IXMLDOMDocument_loadXML(doc, _bstr_(template_second_xsl), &b);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    check_template_transform(template, input, L"first");
+    check_template_transform(template, input, L"first");
+
+    /* setting stylesheet again picks them up */
+    hr = IXSLTemplate_putref_stylesheet(template, (IXMLDOMNode *)doc);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    check_template_transform(template, input, L"second");
+
+    IXMLDOMDocument_Release(input);
+    IXMLDOMDocument_Release(doc);
+    IXSLTemplate_Release(template);
+    free_bstrs();
+}
+
 static void test_insertBefore(void)
 {
     IXMLDOMDocument *doc, *doc2, *doc3;
@@ -14358,6 +14455,7 @@ START_TEST(domdoc)
     test_namespaces_as_attributes();
     test_validate_on_parse_values();
     test_xsltemplate();
+    test_xsltemplate_stylesheet_update();
     test_xsltext();
     test_max_element_depth_values();
 
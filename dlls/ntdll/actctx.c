@@ -3156,17 +3156,127 @@ static NTSTATUS get_manifest_in_associated_manifest( struct actctx_loader* acl,
     return status;
 }
 
-static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
+/* Results of previous winsxs lookups, valid as long as the manifests directory is unchanged.
+ * The cache is per process and starts out empty, so the lookups done for the process activation
+ * context always scan the directory. It helps when the same dependency is resolved again, like
+ * for every module with its own manifest resource (see create_module_activation_context)
+ * or repeated CreateActCtx calls. */
+struct winsxs_lookup
+{
+    WCHAR *lookup;        /* file name pattern */
+    ULONG  min_build;     /* version requested by the caller */
+    ULONG  min_revision;
+    ULONG  build;         /* version of the manifest that was found */
+    ULONG  revision;
+    WCHAR *file;          /* manifest file name, NULL if there was no match */
+};
+
+#define WINSXS_CACHE_SIZE 32
+
+static struct winsxs_lookup winsxs_cache[WINSXS_CACHE_SIZE];
+static unsigned int winsxs_cache_next;
+static LARGE_INTEGER winsxs_cache_time;
+
+static RTL_CRITICAL_SECTION winsxs_cache_section;
+static RTL_CRITICAL_SECTION_DEBUG winsxs_cache_section_debug =
 {
-    static const WCHAR lookup_fmtW[] = L"%s_%s_%s_%u.%u.*.*_%s_*.manifest";
-    static const WCHAR wine_trailerW[] = {'d','e','a','d','b','e','e','f','.','m','a','n','i','f','e','s','t'};
+    0, 0, &winsxs_cache_section,
+    { &winsxs_cache_section_debug.ProcessLocksList, &winsxs_cache_section_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": winsxs_cache_section") }
+};
+static RTL_CRITICAL_SECTION winsxs_cache_section = { &winsxs_cache_section_debug, -1, 0, 0, 0, 0 };
 
-    WCHAR *lookup, *ret = NULL;
-    UNICODE_STRING lookup_us;
-    IO_STATUS_BLOCK io;
+static void free_winsxs_lookup( struct winsxs_lookup *entry )
+{
+    RtlFreeHeap( GetProcessHeap(), 0, entry->lookup );
+    RtlFreeHeap( GetProcessHeap(), 0, entry->file );
+    memset( entry, 0, sizeof(*entry) );
+}
+
+/* caller must hold winsxs_cache_section */
+static struct winsxs_lookup *find_winsxs_lookup( const WCHAR *lookup, const struct assembly_identity *ai )
+{
+    unsigned int i;
+
+    for (i = 0; i < WINSXS_CACHE_SIZE; i++)
+    {
+        struct winsxs_lookup *entry = &winsxs_cache[i];
+        if (entry->lookup && entry->min_build == ai->version.build &&
+            entry->min_revision == ai->version.revision && !wcscmp( entry->lookup, lookup ))
+            return entry;
+    }
+    return NULL;
+}
+
+/* returns TRUE and fills ai and file if the lookup result is cached */
+static BOOL get_cached_winsxs_lookup( const WCHAR *lookup, const LARGE_INTEGER *dir_time,
+                                      struct assembly_identity *ai, WCHAR **file )
+{
+    struct winsxs_lookup *entry;
+    unsigned int i;
+    BOOL ret = FALSE;
+
+    RtlEnterCriticalSection( &winsxs_cache_section );
+    if (winsxs_cache_time.QuadPart != dir_time->QuadPart)
+    {
+        for (i = 0; i < WINSXS_CACHE_SIZE; i++) free_winsxs_lookup( &winsxs_cache[i] );
+        winsxs_cache_time = *dir_time;
+    }
+    else if ((entry = find_winsxs_lookup( lookup, ai )))
+    {
+        *file = NULL;
+        if (!entry->file || (*file = strdupW( entry->file )))
+        {
+            if (entry->file)
+            {
+                ai->version.build = entry->build;
+                ai->version.revision = entry->revision;
+            }
+            ret = TRUE;
+        }
+    }
+    RtlLeaveCriticalSection( &winsxs_cache_section );
+    return ret;
+}
+
+static void cache_winsxs_lookup( const WCHAR *lookup, const LARGE_INTEGER *dir_time,
+                                 const struct assembly_identity *req, const struct assembly_identity *ai,
+                                 const WCHAR *file )
+{
+    struct winsxs_lookup *entry;
+    LARGE_INTEGER now;
+
+    /* the write time has a coarse granularity, a manifest added right after the scan
+     * may not change it, so only trust it once it's a few seconds old */
+    NtQuerySystemTime( &now );
+    if (now.QuadPart - dir_time->QuadPart < 2 * 10000000LL) return;
+
+    RtlEnterCriticalSection( &winsxs_cache_section );
+    /* don't store results obtained from a directory that has since changed */
+    if (winsxs_cache_time.QuadPart == dir_time->QuadPart && !find_winsxs_lookup( lookup, req ))
+    {
+        entry = &winsxs_cache[winsxs_cache_next++ % WINSXS_CACHE_SIZE];
+        free_winsxs_lookup( entry );
+        entry->lookup = strdupW( lookup );
+        entry->file = file ? strdupW( file ) : NULL;
+        if (!entry->lookup || (file && !entry->file)) free_winsxs_lookup( entry );
+        else
+        {
+            entry->min_build = req->version.build;
+            entry->min_revision = req->version.revision;
+            entry->build = ai->version.build;
+            entry->revision = ai->version.revision;
+        }
+    }
+    RtlLeaveCriticalSection( &winsxs_cache_section );
+}
+
+static WCHAR *build_winsxs_lookup( const struct assembly_identity *ai )
+{
+    static const WCHAR lookup_fmtW[] = L"%s_%s_%s_%u.%u.*.*_%s_*.manifest";
     const WCHAR *lang = ai->language;
-    unsigned int data_pos = 0, data_len, len;
-    char buffer[8192];
+    WCHAR *lookup;
+    unsigned int len;
 
     if (!lang || !wcsicmp( lang, L"neutral" )) lang = L"*";
 
@@ -3174,11 +3284,24 @@ static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
     if (!(lookup = RtlAllocateHeap( GetProcessHeap(), 0, len * sizeof(WCHAR) ))) return NULL;
     swprintf( lookup, len, lookup_fmtW, ai->arch, ai->name, ai->public_key,
               ai->version.major, ai->version.minor, lang );
-    RtlInitUnicodeString( &lookup_us, lookup );
 
 #ifdef __arm64ec__
     if (!wcsncmp( lookup, L"amd64_", 6 )) memcpy( lookup, L"a??", 3 * sizeof(WCHAR) );
 #endif
+    return lookup;
+}
+
+static WCHAR *lookup_manifest_file( HANDLE dir, const WCHAR *lookup, struct assembly_identity *ai )
+{
+    static const WCHAR wine_trailerW[] = {'d','e','a','d','b','e','e','f','.','m','a','n','i','f','e','s','t'};
+
+    WCHAR *ret = NULL;
+    UNICODE_STRING lookup_us;
+    IO_STATUS_BLOCK io;
+    unsigned int data_pos = 0, data_len;
+    char buffer[8192];
+
+    RtlInitUnicodeString( &lookup_us, lookup );
 
     if (!NtQueryDirectoryFile( dir, 0, NULL, NULL, &io, buffer, sizeof(buffer),
                                FileBothDirectoryInformation, FALSE, &lookup_us, TRUE ))
@@ -3236,7 +3359,6 @@ static WCHAR *lookup_manifest_file( HANDLE dir, struct assembly_identity *ai )
         }
     }
     else WARN("no matching file for %s\n", debugstr_w(lookup));
-    RtlFreeHeap( GetProcessHeap(), 0, lookup );
     return ret;
 }
 
@@ -3246,7 +3368,9 @@ static NTSTATUS lookup_winsxs(struct actctx_loader* acl, struct assembly_identit
     UNICODE_STRING              path_us;
     OBJECT_ATTRIBUTES           attr;
     IO_STATUS_BLOCK             io;
-    WCHAR *path, *file = NULL;
+    FILE_NETWORK_OPEN_INFORMATION info;
+    WCHAR *path, *lookup, *file = NULL;
+    BOOL cached = FALSE;
     HANDLE handle;
 
     if (!ai->arch || !ai->name || !ai->public_key) return STATUS_NO_SUCH_FILE;
@@ -3272,13 +3396,27 @@ static NTSTATUS lookup_winsxs(struct actctx_loader* acl, struct assembly_identit
     attr.SecurityDescriptor = NULL;
     attr.SecurityQualityOfService = NULL;
 
-    if (!NtOpenFile( &handle, GENERIC_READ | SYNCHRONIZE, &attr, &io, FILE_SHARE_READ | FILE_SHARE_WRITE,
-                     FILE_DIRECTORY_FILE | FILE_SYNCHRONOUS_IO_NONALERT ))
+    if (!(lookup = build_winsxs_lookup( ai )))
     {
-        sxs_ai = *ai;
-        file = lookup_manifest_file( handle, &sxs_ai );
+        RtlFreeUnicodeString( &path_us );
+        return STATUS_NO_MEMORY;
+    }
+
+    sxs_ai = *ai;
+    /* scanning the directory is expensive, reuse the previous result if nothing was added or removed */
+    if (NtQueryFullAttributesFile( &attr, &info )) info.LastWriteTime.QuadPart = 0;
+    else cached = get_cached_winsxs_lookup( lookup, &info.LastWriteTime, &sxs_ai, &file );
+
+    if (!cached && !NtOpenFile( &handle, GENERIC_READ | SYNCHRONIZE, &attr, &io, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                FILE_DIRECTORY_FILE | FILE_SYNCHRONOUS_IO_NONALERT ))
+    {
+        file = lookup_manifest_file( handle, lookup, &sxs_ai );
         NtClose( handle );
+        if (info.LastWriteTime.QuadPart)
+            cache_winsxs_lookup( lookup, &info.LastWriteTime, ai, &sxs_ai, file );
     }
+    RtlFreeHeap( GetProcessHeap(), 0, lookup );
+
     if (!file)
     {
         RtlFreeUnicodeString( &path_us );
@@ -3990,6 +3990,7 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   ULONG depotBlockCount  = offsetInDepot / This->bigBlockSize;
   ULONG depotBlockOffset = offsetInDepot % This->bigBlockSize;
   BYTE depotBuffer[MAX_BIG_BLOCK_SIZE];
+  BlockDepotCacheEntry *entry = NULL;
   ULONG read;
   ULONG depotBlockIndexPos;
   int index, num_blocks;
@@ -4002,12 +4003,24 @@ static HRESULT StorageImpl_GetNextBlockInChain(
     return STG_E_READFAULT;
   }
 
+  for (index = 0; index < BLOCKDEPOT_CACHE_SIZE; index++)
+  {
+    if (This->blockDepotCache[index].index == depotBlockCount)
+    {
+      entry = &This->blockDepotCache[index];
+      break;
+    }
+  }
+
   /*
    * Cache the currently accessed depot block.
    */
-  if (depotBlockCount != This->indexBlockDepotCached)
+  if (!entry)
   {
-    This->indexBlockDepotCached = depotBlockCount;
+    entry = &This->blockDepotCache[This->blockDepotToEvict++];
+    if (This->blockDepotToEvict == BLOCKDEPOT_CACHE_SIZE)
+      This->blockDepotToEvict = 0;
+    entry->index = 0xFFFFFFFF;
 
     if (depotBlockCount < COUNT_BBDEPOTINHEADER)
     {
@@ -4029,13 +4042,12 @@ static HRESULT StorageImpl_GetNextBlockInChain(
     num_blocks = This->bigBlockSize / 4;
 
     for (index = 0; index < num_blocks; index++)
-    {
-      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), nextBlockIndex);
-      This->blockDepotCached[index] = *nextBlockIndex;
-    }
+      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), &entry->data[index]);
+
+    entry->index = depotBlockCount;
   }
 
-  *nextBlockIndex = This->blockDepotCached[depotBlockOffset/sizeof(ULONG)];
+  *nextBlockIndex = entry->data[depotBlockOffset/sizeof(ULONG)];
 
   return S_OK;
 }
@@ -4089,6 +4101,7 @@ static void StorageImpl_SetNextBlockInChain(
   ULONG depotBlockCount  = offsetInDepot / This->bigBlockSize;
   ULONG depotBlockOffset = offsetInDepot % This->bigBlockSize;
   ULONG depotBlockIndexPos;
+  int i;
 
   assert(depotBlockCount < This->bigBlockDepotCount);
   assert(blockIndex != nextBlock);
@@ -4117,9 +4130,13 @@ static void StorageImpl_SetNextBlockInChain(
   /*
    * Update the cached block depot, if necessary.
    */
-  if (depotBlockCount == This->indexBlockDepotCached)
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
   {
-    This->blockDepotCached[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+    if (This->blockDepotCache[i].index == depotBlockCount)
+    {
+      This->blockDepotCache[i].data[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+      break;
+    }
   }
 }
 
@@ -4588,6 +4605,7 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   DirEntry currentEntry;
   DirRef      currentEntryRef;
   BlockChainStream *blockChainStream;
+  ULONG i;
 
   if (create)
   {
@@ -4654,7 +4672,9 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   /*
    * There is no block depot cached yet.
    */
-  This->indexBlockDepotCached = 0xFFFFFFFF;
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
+    This->blockDepotCache[i].index = 0xFFFFFFFF;
+  This->blockDepotToEvict = 0;
   This->indexExtBlockDepotCached = 0xFFFFFFFF;
 
   /*
@@ -4669,7 +4689,6 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   {
     ULONG current_block = This->extBigBlockDepotStart;
     ULONG cache_size = This->extBigBlockDepotCount * 2;
-    ULONG i;
 
     This->extBigBlockDepotLocations = HeapAlloc(GetProcessHeap(), 0, sizeof(ULONG) * cache_size);
     if (!This->extBigBlockDepotLocations)
@@ -7173,6 +7192,21 @@ static ULONG BlockChainStream_GetSectorOfOffset(BlockChainStream *This, ULONG of
   return This->indexCache[min_run].firstSector + offset - This->indexCache[min_run].firstOffset;
 }
 
+/* Returns how many of the blocks following the nth block are stored right after
+ * it in the file and are not cached, up to max. */
+static ULONG BlockChainStream_GetContiguousBlocks(BlockChainStream *This, ULONG index, ULONG sector, ULONG max)
+{
+  ULONG count = 0;
+
+  while (count < max &&
+         This->cachedBlocks[0].index != index + count + 1 &&
+         This->cachedBlocks[1].index != index + count + 1 &&
+         BlockChainStream_GetSectorOfOffset(This, index + count + 1) == sector + count + 1)
+    count++;
+
+  return count;
+}
+
 static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
     ULONG index, BlockChainBlock **block, ULONG *sector, BOOL create)
 {
@@ -7617,7 +7651,14 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to read past the end of the block. */
+      /* Not in cache, and we're going to read past the end of the block.
+       * Read the following blocks too if they are contiguous in the file. */
+      ULONG count = BlockChainStream_GetContiguousBlocks(This, blockNoInSequence, blockIndex,
+          (size - bytesToReadInBuffer - 1) / This->parentStorage->bigBlockSize);
+
+      blockNoInSequence += count;
+      bytesToReadInBuffer += count * This->parentStorage->bigBlockSize;
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7701,7 +7742,14 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to write past the end of the block. */
+      /* Not in cache, and we're going to write past the end of the block.
+       * Write the following blocks too if they are contiguous in the file. */
+      ULONG count = BlockChainStream_GetContiguousBlocks(This, blockNoInSequence, blockIndex,
+          (size - bytesToWrite - 1) / This->parentStorage->bigBlockSize);
+
+      blockNoInSequence += count;
+      bytesToWrite += count * This->parentStorage->bigBlockSize;
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -362,6 +362,15 @@ void StorageBaseImpl_RemoveStream(StorageBaseImpl * stg, StgStreamImpl * strm);
 /* Number of BlockChainStream objects to cache in a StorageImpl */
 #define BLOCKCHAIN_CACHE_SIZE 4
 
+/* Number of big block depot sectors to cache in a StorageImpl */
+#define BLOCKDEPOT_CACHE_SIZE 16
+
+typedef struct BlockDepotCacheEntry
+{
+  ULONG index;
+  ULONG data[MAX_BIG_BLOCK_SIZE / 4];
+} BlockDepotCacheEntry;
+
 /****************************************************************************
  * StorageImpl definitions.
  *
@@ -393,8 +402,9 @@ struct StorageImpl
   ULONG extBlockDepotCached[MAX_BIG_BLOCK_SIZE / 4];
   ULONG indexExtBlockDepotCached;
 
-  ULONG blockDepotCached[MAX_BIG_BLOCK_SIZE / 4];
-  ULONG indexBlockDepotCached;
+  /* Recently used sectors of the big block depot, shared by all chains */
+  BlockDepotCacheEntry blockDepotCache[BLOCKDEPOT_CACHE_SIZE];
+  UINT blockDepotToEvict;
   ULONG prevFreeBlock;
 
   /* All small blocks before this one are known to be in use. */
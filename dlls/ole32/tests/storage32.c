@@ -3872,6 +3872,130 @@ static void test_custom_lockbytes(void)
     DeleteTestLockBytes(lockbytes);
 }
 
+static BYTE large_stream_byte(int stream, ULONG offset)
+{
+    return (offset * 7 + (offset >> 9) * 13 + stream * 101) & 0xff;
+}
+
+static BOOL check_large_stream_data(int stream, ULONG offset, const BYTE *data, ULONG size)
+{
+    ULONG i;
+
+    for (i = 0; i < size; i++)
+        if (data[i] != large_stream_byte(stream, offset + i)) return FALSE;
+    return TRUE;
+}
+
+static void test_large_stream(void)
+{
+    static const WCHAR *names[] = { L"stream1", L"stream2" };
+    static const ULONG stream_size = 1536 * 1024;
+    IStream *stm[2];
+    IStorage *stg;
+    ULARGE_INTEGER upos;
+    LARGE_INTEGER pos;
+    ULONG offset, size, count, seed = 1234;
+    BYTE *buffer;
+    HRESULT hr;
+    ULONG j;
+    int i;
+
+    buffer = malloc(65536);
+
+    hr = StgCreateDocfile(filename, STGM_CREATE | STGM_READWRITE | STGM_SHARE_EXCLUSIVE, 0, &stg);
+    ok(hr == S_OK, "StgCreateDocfile failed %#lx\n", hr);
+
+    for (i = 0; i < 2; i++)
+    {
+        hr = IStorage_CreateStream(stg, names[i], STGM_READWRITE | STGM_SHARE_EXCLUSIVE, 0, 0, &stm[i]);
+        ok(hr == S_OK, "CreateStream failed %#lx\n", hr);
+    }
+
+    /* interleave the writes so that the chains of both streams are fragmented */
+    for (offset = 0; offset < stream_size; offset += size)
+    {
+        size = min(5000 + (offset / 5000) % 3 * 4096, stream_size - offset);
+        for (i = 0; i < 2; i++)
+        {
+            for (j = 0; j < size; j++) buffer[j] = large_stream_byte(i, offset + j);
+            hr = IStream_Write(stm[i], buffer, size, &count);
+            ok(hr == S_OK, "Write failed %#lx\n", hr);
+            ok(count == size, "got %lu\n", count);
+        }
+    }
+
+    /* overwrite random ranges */
+    for (i = 0; i < 50; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        offset = (seed >> 8) % stream_size;
+        size = min((seed >> 4) % 65536, stream_size - offset);
+
+        pos.QuadPart = offset;
+        hr = IStream_Seek(stm[i & 1], pos, STREAM_SEEK_SET, NULL);
+        ok(hr == S_OK, "Seek failed %#lx\n", hr);
+        for (j = 0; j < size; j++) buffer[j] = large_stream_byte(i & 1, offset + j);
+        hr = IStream_Write(stm[i & 1], buffer, size, &count);
+        ok(hr == S_OK, "Write failed %#lx\n", hr);
+        ok(count == size, "got %lu\n", count);
+    }
+
+    for (i = 0; i < 2; i++) IStream_Release(stm[i]);
+    IStorage_Release(stg);
+
+    hr = StgOpenStorage(filename, NULL, STGM_READ | STGM_SHARE_EXCLUSIVE, NULL, 0, &stg);
+    ok(hr == S_OK, "StgOpenStorage failed %#lx\n", hr);
+
+    for (i = 0; i < 2; i++)
+    {
+        hr = IStorage_OpenStream(stg, names[i], NULL, STGM_READ | STGM_SHARE_EXCLUSIVE, 0, &stm[i]);
+        ok(hr == S_OK, "OpenStream failed %#lx\n", hr);
+
+        pos.QuadPart = 0;
+        hr = IStream_Seek(stm[i], pos, STREAM_SEEK_END, &upos);
+        ok(hr == S_OK, "Seek failed %#lx\n", hr);
+        ok(upos.QuadPart == stream_size, "got size %s\n", wine_dbgstr_longlong(upos.QuadPart));
+    }
+
+    /* sequential reads */
+    for (i = 0; i < 2; i++)
+    {
+        pos.QuadPart = 0;
+        hr = IStream_Seek(stm[i], pos, STREAM_SEEK_SET, NULL);
+        ok(hr == S_OK, "Seek failed %#lx\n", hr);
+        for (offset = 0; offset < stream_size; offset += count)
+        {
+            hr = IStream_Read(stm[i], buffer, 65536, &count);
+            ok(hr == S_OK, "Read failed %#lx\n", hr);
+            ok(count == min(65536, stream_size - offset), "got %lu at %lu\n", count, offset);
+            ok(check_large_stream_data(i, offset, buffer, count), "wrong data at %lu\n", offset);
+            if (!count) break;
+        }
+    }
+
+    /* random reads */
+    for (i = 0; i < 200; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        offset = (seed >> 8) % stream_size;
+        size = (seed >> 4) % 20000;
+
+        pos.QuadPart = offset;
+        hr = IStream_Seek(stm[i & 1], pos, STREAM_SEEK_SET, NULL);
+        ok(hr == S_OK, "Seek failed %#lx\n", hr);
+        hr = IStream_Read(stm[i & 1], buffer, size, &count);
+        ok(hr == S_OK, "Read failed %#lx\n", hr);
+        ok(count == min(size, stream_size - offset), "got %lu\n", count);
+        ok(check_large_stream_data(i & 1, offset, buffer, count), "wrong data at %lu\n", offset);
+    }
+
+    for (i = 0; i < 2; i++) IStream_Release(stm[i]);
+    IStorage_Release(stg);
+
+    free(buffer);
+    DeleteFileA(filenameA);
+}
+
 START_TEST(storage32)
 {
     CHAR temp[MAX_PATH];
@@ -3921,4 +4045,5 @@ START_TEST(storage32)
     test_transacted_shared();
     test_overwrite();
     test_custom_lockbytes();
+    test_large_stream();
 }
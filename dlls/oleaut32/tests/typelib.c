@@ -7765,6 +7765,154 @@ todo_wine {
     ITypeLib_Release(tl);
 }
 
+static void test_name_lookup(void)
+{
+    static OLECHAR nameW[] = L"NameLookup";
+    static OLECHAR addedW[] = L"Added";
+    static OLECHAR *added_names[] = {addedW};
+    CHAR filenameA[MAX_PATH];
+    WCHAR filenameW[MAX_PATH];
+    WCHAR method[16], param[16], buffW[16];
+    OLECHAR *names[2];
+    ICreateTypeLib2 *ctl;
+    ICreateTypeInfo *cti;
+    ICreateTypeInfo2 *cti2;
+    ITypeLib *tl;
+    ITypeInfo *ti;
+    MEMBERID memids[2];
+    FUNCDESC funcdesc;
+    ELEMDESC edesc;
+    USHORT found;
+    BOOL is_name;
+    HRESULT hr;
+    UINT i;
+
+    GetTempFileNameA(".", "tlb", 0, filenameA);
+    MultiByteToWideChar(CP_ACP, 0, filenameA, -1, filenameW, MAX_PATH);
+
+    hr = CreateTypeLib2(SYS_WIN32, filenameW, &ctl);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    hr = ICreateTypeLib2_CreateTypeInfo(ctl, nameW, TKIND_DISPATCH, &cti);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    memset(&edesc, 0, sizeof(edesc));
+    edesc.tdesc.vt = VT_BSTR;
+    edesc.idldesc.wIDLFlags = IDLFLAG_FIN;
+
+    memset(&funcdesc, 0, sizeof(funcdesc));
+    funcdesc.funckind = FUNC_DISPATCH;
+    funcdesc.invkind = INVOKE_FUNC;
+    funcdesc.callconv = CC_STDCALL;
+    funcdesc.elemdescFunc.tdesc.vt = VT_VOID;
+    funcdesc.lprgelemdescParam = &edesc;
+    funcdesc.cParams = 1;
+
+    /* enough members to exceed any linear search threshold */
+    for (i = 0; i < 40; i++)
+    {
+        swprintf(method, ARRAY_SIZE(method), L"Method%u", i);
+        swprintf(param, ARRAY_SIZE(param), L"param%u", i);
+        names[0] = method;
+        names[1] = param;
+
+        funcdesc.memid = i;
+        hr = ICreateTypeInfo_AddFuncDesc(cti, i, &funcdesc);
+        ok(hr == S_OK, "%u: got %08lx\n", i, hr);
+        hr = ICreateTypeInfo_SetFuncAndParamNames(cti, i, names, 2);
+        ok(hr == S_OK, "%u: got %08lx\n", i, hr);
+    }
+
+    hr = ICreateTypeLib2_QueryInterface(ctl, &IID_ITypeLib, (void **)&tl);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    found = 2;
+    memids[0] = 0xdeadbeef;
+    lstrcpyW(buffW, L"Method17");
+    hr = ITypeLib_FindName(tl, buffW, 0, &ti, memids, &found);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ok(found == 1, "got %u\n", found);
+    ok(memids[0] == 17, "got %ld\n", memids[0]);
+    ITypeInfo_Release(ti);
+
+    /* members added or removed after a lookup must be found */
+    funcdesc.memid = 100;
+    funcdesc.cParams = 0;
+    hr = ICreateTypeInfo_AddFuncDesc(cti, 0, &funcdesc);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    hr = ICreateTypeInfo_SetFuncAndParamNames(cti, 0, added_names, 1);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    found = 2;
+    memids[0] = 0xdeadbeef;
+    hr = ITypeLib_FindName(tl, addedW, 0, &ti, memids, &found);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ok(found == 1, "got %u\n", found);
+    ok(memids[0] == 100, "got %ld\n", memids[0]);
+    ITypeInfo_Release(ti);
+
+    hr = ICreateTypeInfo_QueryInterface(cti, &IID_ICreateTypeInfo2, (void **)&cti2);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    hr = ICreateTypeInfo2_DeleteFuncDesc(cti2, 0);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ICreateTypeInfo2_Release(cti2);
+
+    found = 2;
+    hr = ITypeLib_FindName(tl, addedW, 0, &ti, memids, &found);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ok(found == 0, "got %u\n", found);
+
+    ITypeLib_Release(tl);
+    ICreateTypeInfo_Release(cti);
+
+    hr = ICreateTypeLib2_SaveAllChanges(ctl);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ICreateTypeLib2_Release(ctl);
+
+    hr = LoadTypeLib(filenameW, &tl);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    is_name = FALSE;
+    lstrcpyW(buffW, L"param39");
+    hr = ITypeLib_IsName(tl, buffW, 0, &is_name);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ok(is_name, "expected name to be found\n");
+
+    is_name = TRUE;
+    lstrcpyW(buffW, L"Method40");
+    hr = ITypeLib_IsName(tl, buffW, 0, &is_name);
+    ok(hr == S_OK, "got %08lx\n", hr);
+    ok(!is_name, "expected name not to be found\n");
+
+    hr = ITypeLib_GetTypeInfo(tl, 0, &ti);
+    ok(hr == S_OK, "got %08lx\n", hr);
+
+    for (i = 0; i < 40; i += 13)
+    {
+        swprintf(method, ARRAY_SIZE(method), L"METHOD%u", i);
+        swprintf(param, ARRAY_SIZE(param), L"Param%u", i);
+        names[0] = method;
+        names[1] = param;
+
+        memids[0] = memids[1] = 0xdeadbeef;
+        hr = ITypeInfo_GetIDsOfNames(ti, names, 2, memids);
+        ok(hr == S_OK, "%u: got %08lx\n", i, hr);
+        ok(memids[0] == i, "%u: got %ld\n", i, memids[0]);
+        ok(memids[1] == 0, "%u: got %ld\n", i, memids[1]);
+    }
+
+    names[0] = addedW;
+    memids[0] = 0xdeadbeef;
+    hr = ITypeInfo_GetIDsOfNames(ti, names, 1, memids);
+    ok(hr == DISP_E_UNKNOWNNAME, "got %08lx\n", hr);
+    ok(memids[0] == MEMBERID_NIL, "got %ld\n", memids[0]);
+
+    ITypeInfo_Release(ti);
+    ITypeLib_Release(tl);
+
+    DeleteFileA(filenameA);
+}
+
 static void test_TypeInfo2_GetContainingTypeLib(void)
 {
     static const WCHAR test[] = {'t','e','s','t','.','t','l','b',0};
@@ -8788,6 +8936,7 @@ START_TEST(typelib)
     test_SetFuncAndParamNames();
     test_SetDocString();
     test_FindName();
+    test_name_lookup();
 
     if ((filename = create_test_typelib(2)))
     {
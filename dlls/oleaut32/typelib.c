@@ -1100,6 +1100,7 @@ typedef struct tagITypeLibImpl
 				   typelibs */
     struct list ref_list;       /* list of ref types in this typelib */
     HREFTYPE dispatch_href;     /* reference to IDispatch, -1 if unused */
+    struct name_index *name_index; /* type and member names, built on first lookup */
 
 
     /* typelibs are cached, keyed by path and index, so store the linked list info within them */
@@ -1240,6 +1241,8 @@ typedef struct tagITypeInfoImpl
 
     struct list *pcustdata_list;
     struct list custdata_list;
+
+    struct name_index *name_index; /* function and variable names, built on first lookup */
 } ITypeInfoImpl;
 
 static inline ITypeInfoImpl *info_impl_from_ITypeComp( ITypeComp *iface )
@@ -1277,6 +1280,12 @@ typedef struct tagTLBContext
 	void *mapping;        /* memory mapping */
 	MSFT_SegDir * pTblDir;
 	ITypeLibImpl* pLibInfo;
+	TLBString **names;    /* name table entries, sorted by offset */
+	UINT name_count;
+	TLBString **strings;  /* string table entries, sorted by offset */
+	UINT string_count;
+	TLBGuid **guids;      /* guid table entries, sorted by offset */
+	UINT guid_count;
 } TLBContext;
 
 
@@ -1727,6 +1736,212 @@ static inline ITypeInfoImpl *TLB_get_typeinfo_by_name(ITypeLibImpl *typelib, con
     return NULL;
 }
 
+/* Hashed index of type and member names.
+ *
+ * The library index has one entry per distinct name in every typeinfo and
+ * is used to find the candidate typeinfos for IsName() and FindName(). The
+ * typeinfo index maps function and variable names to their position, with
+ * variables numbered after the functions. Entries on a chain are kept in
+ * typeinfo and member order, so the first match is the one a linear search
+ * would have found.
+ *
+ * Only names made of ASCII letters, digits and underscores are hashed, for
+ * which lstrcmpiW() reduces to an ASCII case-insensitive comparison; if a
+ * typelib contains any other name, lookups fall back to a linear search.
+ */
+struct name_index_entry
+{
+    const TLBString *name;
+    ITypeInfoImpl *info;
+    UINT hash;
+    UINT member;
+    UINT next;
+};
+
+struct name_index
+{
+    UINT count;
+    UINT size;
+    UINT *buckets;
+    struct name_index_entry *entries;
+};
+
+#define NAME_INDEX_MIN_MEMBERS 16
+
+static struct name_index no_name_index;
+
+static BOOL name_index_hash(const WCHAR *name, UINT *hash)
+{
+    UINT h = 2166136261u;
+
+    if (!name) return FALSE;
+    for (; *name; name++)
+    {
+        WCHAR c = *name;
+
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        else if (!(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9') && c != '_') return FALSE;
+        h = (h ^ c) * 16777619;
+    }
+    *hash = h;
+    return TRUE;
+}
+
+static void name_index_free(struct name_index *index)
+{
+    if (!index || index == &no_name_index) return;
+    free(index->buckets);
+    free(index->entries);
+    free(index);
+}
+
+static struct name_index *name_index_create(UINT max_count)
+{
+    struct name_index *index;
+    UINT i;
+
+    if (!(index = malloc(sizeof(*index)))) return NULL;
+    index->count = 0;
+    for (index->size = 16; index->size < max_count; index->size *= 2);
+    index->buckets = malloc(index->size * sizeof(*index->buckets));
+    index->entries = malloc(max(max_count, 1) * sizeof(*index->entries));
+    if (!index->buckets || !index->entries)
+    {
+        name_index_free(index);
+        return NULL;
+    }
+    for (i = 0; i < index->size; i++) index->buckets[i] = ~0u;
+    return index;
+}
+
+/* entries are inserted at the head of their chain, so they have to be added
+ * in reverse order; if unique is set, names already present for the same
+ * typeinfo are skipped */
+static BOOL name_index_add(struct name_index *index, const TLBString *name, ITypeInfoImpl *info,
+                           UINT member, BOOL unique)
+{
+    struct name_index_entry *entry;
+    UINT hash, i, *head;
+
+    if (!name) return TRUE;
+    if (!name_index_hash(name->str, &hash)) return FALSE;
+
+    head = &index->buckets[hash & (index->size - 1)];
+    if (unique)
+    {
+        for (i = *head; i != ~0u && index->entries[i].info == info; i = index->entries[i].next)
+            if (index->entries[i].name == name) return TRUE;
+    }
+
+    entry = &index->entries[index->count];
+    entry->name = name;
+    entry->info = info;
+    entry->hash = hash;
+    entry->member = member;
+    entry->next = *head;
+    *head = index->count++;
+    return TRUE;
+}
+
+/* returns the entry following prev whose name matches, or the first one if prev is NULL */
+static const struct name_index_entry *name_index_next(const struct name_index *index, const WCHAR *name,
+                                                      UINT hash, const struct name_index_entry *prev)
+{
+    UINT i = prev ? prev->next : index->buckets[hash & (index->size - 1)];
+
+    for (; i != ~0u; i = index->entries[i].next)
+    {
+        const struct name_index_entry *entry = &index->entries[i];
+        if (entry->hash == hash && !lstrcmpiW(entry->name->str, name)) return entry;
+    }
+    return NULL;
+}
+
+static const struct name_index *name_index_publish(struct name_index **ptr, struct name_index *index)
+{
+    struct name_index *prev;
+
+    if ((prev = InterlockedCompareExchangePointer((void **)ptr, index, NULL)))
+    {
+        name_index_free(index);
+        index = prev;
+    }
+    return index == &no_name_index ? NULL : index;
+}
+
+static const struct name_index *TLB_get_name_index(ITypeLibImpl *typelib)
+{
+    struct name_index *index;
+    UINT count = 0;
+    int i, j, k;
+
+    if ((index = typelib->name_index)) return index == &no_name_index ? NULL : index;
+
+    for (i = 0; i < typelib->TypeInfoCount; ++i)
+    {
+        ITypeInfoImpl *info = typelib->typeinfos[i];
+
+        count += 1 + info->typeattr.cFuncs + info->typeattr.cVars;
+        for (j = 0; j < info->typeattr.cFuncs; ++j)
+            count += info->funcdescs[j].funcdesc.cParams;
+    }
+    if (!(index = name_index_create(count))) return NULL;
+
+    for (i = typelib->TypeInfoCount - 1; i >= 0; --i)
+    {
+        ITypeInfoImpl *info = typelib->typeinfos[i];
+
+        if (!name_index_add(index, info->Name, info, 0, TRUE)) goto unindexable;
+        for (j = 0; j < info->typeattr.cFuncs; ++j)
+        {
+            const TLBFuncDesc *func = &info->funcdescs[j];
+
+            if (!name_index_add(index, func->Name, info, 0, TRUE)) goto unindexable;
+            for (k = 0; k < func->funcdesc.cParams; ++k)
+                if (!name_index_add(index, func->pParamDesc[k].Name, info, 0, TRUE)) goto unindexable;
+        }
+        for (j = 0; j < info->typeattr.cVars; ++j)
+            if (!name_index_add(index, info->vardescs[j].Name, info, 0, TRUE)) goto unindexable;
+    }
+    TRACE("%p: indexed %u names\n", typelib, index->count);
+    return name_index_publish(&typelib->name_index, index);
+
+unindexable:
+    name_index_free(index);
+    return name_index_publish(&typelib->name_index, &no_name_index);
+}
+
+static const struct name_index *TLB_get_member_index(ITypeInfoImpl *info)
+{
+    struct name_index *index;
+    UINT count = info->typeattr.cFuncs + info->typeattr.cVars;
+    int i;
+
+    if ((index = info->name_index)) return index == &no_name_index ? NULL : index;
+    if (count < NAME_INDEX_MIN_MEMBERS) return NULL;
+    if (!(index = name_index_create(count))) return NULL;
+
+    for (i = info->typeattr.cVars - 1; i >= 0; --i)
+        if (!name_index_add(index, info->vardescs[i].Name, info, info->typeattr.cFuncs + i, FALSE))
+            goto unindexable;
+    for (i = info->typeattr.cFuncs - 1; i >= 0; --i)
+        if (!name_index_add(index, info->funcdescs[i].Name, info, i, FALSE))
+            goto unindexable;
+    return name_index_publish(&info->name_index, index);
+
+unindexable:
+    name_index_free(index);
+    return name_index_publish(&info->name_index, &no_name_index);
+}
+
+/* must be called whenever names or members of a typeinfo are changed */
+static void TLB_invalidate_name_index(ITypeInfoImpl *info)
+{
+    name_index_free(InterlockedExchangePointer((void **)&info->name_index, NULL));
+    if (info->pTypeLib)
+        name_index_free(InterlockedExchangePointer((void **)&info->pTypeLib->name_index, NULL));
+}
+
 static void TLBVarDesc_Constructor(TLBVarDesc *var_desc)
 {
     list_init(&var_desc->custdata_list);
@@ -2074,6 +2289,10 @@ static HRESULT MSFT_ReadAllGuids(TLBContext *pcx)
     MSFT_GuidEntry entry;
     int offs = 0;
 
+    if (pcx->pTblDir->pGuidTab.length > 0 &&
+        !(pcx->guids = malloc((pcx->pTblDir->pGuidTab.length / sizeof(MSFT_GuidEntry) + 1) * sizeof(*pcx->guids))))
+        return E_OUTOFMEMORY;
+
     MSFT_Seek(pcx, pcx->pTblDir->pGuidTab.offset);
     while (1) {
         if (offs >= pcx->pTblDir->pGuidTab.length)
@@ -2088,6 +2307,7 @@ static HRESULT MSFT_ReadAllGuids(TLBContext *pcx)
         guid->hreftype = entry.hreftype;
 
         list_add_tail(&pcx->pLibInfo->guid_list, &guid->entry);
+        pcx->guids[pcx->guid_count++] = guid;
 
         offs += sizeof(MSFT_GuidEntry);
     }
@@ -2095,13 +2315,20 @@ static HRESULT MSFT_ReadAllGuids(TLBContext *pcx)
 
 static TLBGuid *MSFT_ReadGuid( int offset, TLBContext *pcx)
 {
-    TLBGuid *ret;
+    UINT lo = 0, hi = pcx->guid_count, mid;
+
+    /* the table is filled in file order, so it is sorted by offset */
+    while (lo < hi)
+    {
+        TLBGuid *ret = pcx->guids[mid = lo + (hi - lo) / 2];
 
-    LIST_FOR_EACH_ENTRY(ret, &pcx->pLibInfo->guid_list, TLBGuid, entry){
-        if(ret->offset == offset){
+        if (ret->offset == (UINT)offset)
+        {
             TRACE_(typelib)("%s\n", debugstr_guid(&ret->guid));
             return ret;
         }
+        if (ret->offset < (UINT)offset) lo = mid + 1;
+        else hi = mid;
     }
 
     return NULL;
@@ -2130,6 +2357,11 @@ static HRESULT MSFT_ReadAllNames(TLBContext *pcx)
     INT16 len_piece;
     int offs = 0, lengthInChars;
 
+    /* every entry takes at least 8 bytes */
+    if (pcx->pTblDir->pNametab.length > 0 &&
+        !(pcx->names = malloc((pcx->pTblDir->pNametab.length / 8 + 1) * sizeof(*pcx->names))))
+        return E_OUTOFMEMORY;
+
     MSFT_Seek(pcx, pcx->pTblDir->pNametab.offset);
     while (1) {
         TLBString *tlbstr;
@@ -2165,37 +2397,41 @@ static HRESULT MSFT_ReadAllNames(TLBContext *pcx)
         free(string);
 
         list_add_tail(&pcx->pLibInfo->name_list, &tlbstr->entry);
+        pcx->names[pcx->name_count++] = tlbstr;
 
         offs += len_piece;
     }
 }
 
-static TLBString *MSFT_ReadName( TLBContext *pcx, int offset)
+/* the tables are filled in file order, so they are sorted by offset */
+static TLBString *MSFT_FindString( TLBString **table, UINT count, int offset )
 {
-    TLBString *tlbstr;
+    UINT lo = 0, hi = count, mid;
 
-    LIST_FOR_EACH_ENTRY(tlbstr, &pcx->pLibInfo->name_list, TLBString, entry) {
-        if (tlbstr->offset == offset) {
+    while (lo < hi)
+    {
+        TLBString *tlbstr = table[mid = lo + (hi - lo) / 2];
+
+        if (tlbstr->offset == (UINT)offset)
+        {
             TRACE_(typelib)("%s\n", debugstr_w(tlbstr->str));
             return tlbstr;
         }
+        if (tlbstr->offset < (UINT)offset) lo = mid + 1;
+        else hi = mid;
     }
 
     return NULL;
 }
 
-static TLBString *MSFT_ReadString( TLBContext *pcx, int offset)
+static TLBString *MSFT_ReadName( TLBContext *pcx, int offset)
 {
-    TLBString *tlbstr;
-
-    LIST_FOR_EACH_ENTRY(tlbstr, &pcx->pLibInfo->string_list, TLBString, entry) {
-        if (tlbstr->offset == offset) {
-            TRACE_(typelib)("%s\n", debugstr_w(tlbstr->str));
-            return tlbstr;
-        }
-    }
+    return MSFT_FindString(pcx->names, pcx->name_count, offset);
+}
 
-    return NULL;
+static TLBString *MSFT_ReadString( TLBContext *pcx, int offset)
+{
+    return MSFT_FindString(pcx->strings, pcx->string_count, offset);
 }
 
 /*
@@ -2762,6 +2998,11 @@ static HRESULT MSFT_ReadAllStrings(TLBContext *pcx)
     INT16 len_str, len_piece;
     int offs = 0, lengthInChars;
 
+    /* every entry takes at least 8 bytes */
+    if (pcx->pTblDir->pStringtab.length > 0 &&
+        !(pcx->strings = malloc((pcx->pTblDir->pStringtab.length / 8 + 1) * sizeof(*pcx->strings))))
+        return E_OUTOFMEMORY;
+
     MSFT_Seek(pcx, pcx->pTblDir->pStringtab.offset);
     while (1) {
         TLBString *tlbstr;
@@ -2796,6 +3037,7 @@ static HRESULT MSFT_ReadAllStrings(TLBContext *pcx)
         free(string);
 
         list_add_tail(&pcx->pLibInfo->string_list, &tlbstr->entry);
+        pcx->strings[pcx->string_count++] = tlbstr;
 
         offs += len_piece;
     }
@@ -3449,6 +3691,9 @@ static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength)
     cx.mapping = pLib;
     cx.pLibInfo = pTypeLibImpl;
     cx.length = dwTLBLength;
+    cx.names = cx.strings = NULL;
+    cx.guids = NULL;
+    cx.name_count = cx.string_count = cx.guid_count = 0;
 
     /* read header */
     MSFT_ReadLEDWords(&tlbHeader, sizeof(tlbHeader), &cx, 0);
@@ -3640,6 +3885,10 @@ static ITypeLib2* ITypeLib2_Constructor_MSFT(LPVOID pLib, DWORD dwTLBLength)
             TLB_fix_typeinfo_ptr_size(pTypeLibImpl->typeinfos[i]);
     }
 
+    free(cx.names);
+    free(cx.strings);
+    free(cx.guids);
+
     TRACE("(%p)\n", pTypeLibImpl);
     return &pTypeLibImpl->ITypeLib2_iface;
 }
@@ -4855,6 +5104,7 @@ static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
           ITypeInfoImpl_Destroy(This->typeinfos[i]);
       }
       free(This->typeinfos);
+      name_index_free(This->name_index);
       free(This);
     }
 
@@ -5093,6 +5343,27 @@ memerr1:
  * described in the library.
  *
  */
+static BOOL TLB_typeinfo_has_name(ITypeInfoImpl *pTInfo, LPOLESTR szNameBuf, UINT nNameBufLen)
+{
+    UINT fdc, vrc;
+
+    if(!TLB_str_memcmp(szNameBuf, pTInfo->Name, nNameBufLen)) return TRUE;
+    for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
+        TLBFuncDesc *pFInfo = &pTInfo->funcdescs[fdc];
+        int pc;
+        if(!TLB_str_memcmp(szNameBuf, pFInfo->Name, nNameBufLen)) return TRUE;
+        for(pc=0; pc < pFInfo->funcdesc.cParams; pc++){
+            if(!TLB_str_memcmp(szNameBuf, pFInfo->pParamDesc[pc].Name, nNameBufLen))
+                return TRUE;
+        }
+    }
+    for(vrc = 0; vrc < pTInfo->typeattr.cVars; ++vrc){
+        TLBVarDesc *pVInfo = &pTInfo->vardescs[vrc];
+        if(!TLB_str_memcmp(szNameBuf, pVInfo->Name, nNameBufLen)) return TRUE;
+    }
+    return FALSE;
+}
+
 static HRESULT WINAPI ITypeLib2_fnIsName(
 	ITypeLib2 *iface,
 	LPOLESTR szNameBuf,
@@ -5100,34 +5371,27 @@ static HRESULT WINAPI ITypeLib2_fnIsName(
 	BOOL *pfName)
 {
     ITypeLibImpl *This = impl_from_ITypeLib2(iface);
+    const struct name_index_entry *entry;
+    const struct name_index *index;
+    UINT nNameBufLen = (lstrlenW(szNameBuf)+1)*sizeof(WCHAR), hash;
     int tic;
-    UINT nNameBufLen = (lstrlenW(szNameBuf)+1)*sizeof(WCHAR), fdc, vrc;
 
     TRACE("%p, %s, %#lx, %p.\n", iface, debugstr_w(szNameBuf), lHashVal, pfName);
 
-    *pfName=TRUE;
-    for(tic = 0; tic < This->TypeInfoCount; ++tic){
-        ITypeInfoImpl *pTInfo = This->typeinfos[tic];
-        if(!TLB_str_memcmp(szNameBuf, pTInfo->Name, nNameBufLen)) goto ITypeLib2_fnIsName_exit;
-        for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
-            TLBFuncDesc *pFInfo = &pTInfo->funcdescs[fdc];
-            int pc;
-            if(!TLB_str_memcmp(szNameBuf, pFInfo->Name, nNameBufLen)) goto ITypeLib2_fnIsName_exit;
-            for(pc=0; pc < pFInfo->funcdesc.cParams; pc++){
-                if(!TLB_str_memcmp(szNameBuf, pFInfo->pParamDesc[pc].Name, nNameBufLen))
-                    goto ITypeLib2_fnIsName_exit;
-            }
-        }
-        for(vrc = 0; vrc < pTInfo->typeattr.cVars; ++vrc){
-            TLBVarDesc *pVInfo = &pTInfo->vardescs[vrc];
-            if(!TLB_str_memcmp(szNameBuf, pVInfo->Name, nNameBufLen)) goto ITypeLib2_fnIsName_exit;
-        }
-
-    }
     *pfName=FALSE;
+    if ((index = TLB_get_name_index(This)) && name_index_hash(szNameBuf, &hash))
+    {
+        for (entry = name_index_next(index, szNameBuf, hash, NULL); entry && !*pfName;
+             entry = name_index_next(index, szNameBuf, hash, entry))
+            *pfName = TLB_typeinfo_has_name(entry->info, szNameBuf, nNameBufLen);
+    }
+    else
+    {
+        for(tic = 0; tic < This->TypeInfoCount && !*pfName; ++tic)
+            *pfName = TLB_typeinfo_has_name(This->typeinfos[tic], szNameBuf, nNameBufLen);
+    }
 
-ITypeLib2_fnIsName_exit:
-    TRACE("(%p)slow! search for %s: %sfound!\n", This,
+    TRACE("(%p) search for %s: %sfound!\n", This,
           debugstr_w(szNameBuf), *pfName ? "" : "NOT ");
 
     return S_OK;
@@ -5139,6 +5403,34 @@ ITypeLib2_fnIsName_exit:
  * to quickly verify that a name exists in a type library.
  *
  */
+static BOOL TLB_find_name_in_typeinfo(ITypeInfoImpl *pTInfo, LPOLESTR name, UINT len, MEMBERID *memid)
+{
+    TLBVarDesc *var;
+    UINT fdc;
+
+    if(!TLB_str_memcmp(name, pTInfo->Name, len)) {
+        *memid = MEMBERID_NIL;
+        return TRUE;
+    }
+
+    for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
+        TLBFuncDesc *func = &pTInfo->funcdescs[fdc];
+
+        if(!TLB_str_memcmp(name, func->Name, len)) {
+            *memid = func->funcdesc.memid;
+            return TRUE;
+        }
+    }
+
+    var = TLB_get_vardesc_by_name(pTInfo, name);
+    if (var) {
+        *memid = var->vardesc.memid;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 static HRESULT WINAPI ITypeLib2_fnFindName(
 	ITypeLib2 *iface,
 	LPOLESTR name,
@@ -5148,9 +5440,12 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
 	UINT16 *found)
 {
     ITypeLibImpl *This = impl_from_ITypeLib2(iface);
+    const struct name_index_entry *entry;
+    const struct name_index *index;
+    ITypeInfoImpl *prev = NULL;
     int tic;
     UINT count = 0;
-    UINT len;
+    UINT len, name_hash;
 
     TRACE("%p, %s %#lx, %p, %p, %p.\n", iface, debugstr_w(name), hash, ppTInfo, memid, found);
 
@@ -5158,36 +5453,32 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
         return E_INVALIDARG;
 
     len = (lstrlenW(name) + 1)*sizeof(WCHAR);
-    for(tic = 0; count < *found && tic < This->TypeInfoCount; ++tic) {
-        ITypeInfoImpl *pTInfo = This->typeinfos[tic];
-        TLBVarDesc *var;
-        UINT fdc;
-
-        if(!TLB_str_memcmp(name, pTInfo->Name, len)) {
-            memid[count] = MEMBERID_NIL;
-            goto ITypeLib2_fnFindName_exit;
-        }
-
-        for(fdc = 0; fdc < pTInfo->typeattr.cFuncs; ++fdc) {
-            TLBFuncDesc *func = &pTInfo->funcdescs[fdc];
-
-            if(!TLB_str_memcmp(name, func->Name, len)) {
-                memid[count] = func->funcdesc.memid;
-                goto ITypeLib2_fnFindName_exit;
+    if ((index = TLB_get_name_index(This)) && name_index_hash(name, &name_hash))
+    {
+        /* entries are in typeinfo order, a typeinfo may match more than once */
+        for (entry = name_index_next(index, name, name_hash, NULL); count < *found && entry;
+             entry = name_index_next(index, name, name_hash, entry))
+        {
+            if (entry->info == prev) continue;
+            prev = entry->info;
+            if (TLB_find_name_in_typeinfo(entry->info, name, len, &memid[count]))
+            {
+                ITypeInfo2_AddRef(&entry->info->ITypeInfo2_iface);
+                ppTInfo[count++] = (ITypeInfo *)&entry->info->ITypeInfo2_iface;
             }
         }
+    }
+    else
+    {
+        for(tic = 0; count < *found && tic < This->TypeInfoCount; ++tic) {
+            ITypeInfoImpl *pTInfo = This->typeinfos[tic];
 
-        var = TLB_get_vardesc_by_name(pTInfo, name);
-        if (var) {
-            memid[count] = var->vardesc.memid;
-            goto ITypeLib2_fnFindName_exit;
+            if (TLB_find_name_in_typeinfo(pTInfo, name, len, &memid[count]))
+            {
+                ITypeInfo2_AddRef(&pTInfo->ITypeInfo2_iface);
+                ppTInfo[count++] = (ITypeInfo *)&pTInfo->ITypeInfo2_iface;
+            }
         }
-
-        continue;
-ITypeLib2_fnFindName_exit:
-        ITypeInfo2_AddRef(&pTInfo->ITypeInfo2_iface);
-        ppTInfo[count] = (ITypeInfo *)&pTInfo->ITypeInfo2_iface;
-        count++;
     }
     TRACE("found %d typeinfos\n", count);
 
@@ -5703,6 +5994,7 @@ static void ITypeInfoImpl_Destroy(ITypeInfoImpl *This)
 
     TLB_FreeCustData(&This->custdata_list);
 
+    name_index_free(This->name_index);
     free(This);
 }
 
@@ -6332,9 +6624,12 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
         LPOLESTR  *rgszNames, UINT cNames, MEMBERID  *pMemId)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    const TLBVarDesc *pVDesc;
+    const struct name_index_entry *entry;
+    const struct name_index *index;
+    const TLBFuncDesc *pFDesc = NULL;
+    const TLBVarDesc *pVDesc = NULL;
     HRESULT ret=S_OK;
-    UINT i, fdc;
+    UINT i, fdc, hash;
 
     TRACE("%p, %s, %d.\n", iface, debugstr_w(*rgszNames), cNames);
 
@@ -6342,25 +6637,40 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     for (i = 0; i < cNames; i++)
         pMemId[i] = MEMBERID_NIL;
 
-    for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc) {
-        int j;
-        const TLBFuncDesc *pFDesc = &This->funcdescs[fdc];
-        if(!lstrcmpiW(*rgszNames, TLB_get_bstr(pFDesc->Name))) {
-            if(cNames) *pMemId=pFDesc->funcdesc.memid;
-            for(i=1; i < cNames; i++){
-                for(j=0; j<pFDesc->funcdesc.cParams; j++)
-                    if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
-                            break;
-                if( j<pFDesc->funcdesc.cParams)
-                    pMemId[i]=j;
-                else
-                   ret=DISP_E_UNKNOWNNAME;
-            };
-            TRACE("-- %#lx.\n", ret);
-            return ret;
+    if ((index = TLB_get_member_index(This)) && name_index_hash(*rgszNames, &hash))
+    {
+        if ((entry = name_index_next(index, *rgszNames, hash, NULL)))
+        {
+            if (entry->member < This->typeattr.cFuncs)
+                pFDesc = &This->funcdescs[entry->member];
+            else
+                pVDesc = &This->vardescs[entry->member - This->typeattr.cFuncs];
         }
     }
-    pVDesc = TLB_get_vardesc_by_name(This, *rgszNames);
+    else
+    {
+        for (fdc = 0; fdc < This->typeattr.cFuncs && !pFDesc; ++fdc)
+            if (!lstrcmpiW(*rgszNames, TLB_get_bstr(This->funcdescs[fdc].Name)))
+                pFDesc = &This->funcdescs[fdc];
+        if (!pFDesc)
+            pVDesc = TLB_get_vardesc_by_name(This, *rgszNames);
+    }
+
+    if (pFDesc) {
+        int j;
+        if(cNames) *pMemId=pFDesc->funcdesc.memid;
+        for(i=1; i < cNames; i++){
+            for(j=0; j<pFDesc->funcdesc.cParams; j++)
+                if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
+                        break;
+            if( j<pFDesc->funcdesc.cParams)
+                pMemId[i]=j;
+            else
+               ret=DISP_E_UNKNOWNNAME;
+        };
+        TRACE("-- %#lx.\n", ret);
+        return ret;
+    }
     if(pVDesc){
         if(cNames)
             *pMemId = pVDesc->vardesc.memid;
@@ -8947,6 +9257,7 @@ static HRESULT WINAPI ICreateTypeLib2_fnCreateTypeInfo(ICreateTypeLib2 *iface,
     info->pTypeLib = This;
     info->Name = TLB_append_str(&This->name_list, name);
     info->index = This->TypeInfoCount;
+    TLB_invalidate_name_index(info);
     info->typeattr.typekind = kind;
     info->typeattr.cbAlignment = 4;
 
@@ -10728,6 +11039,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddFuncDesc(ICreateTypeInfo2 *iface,
     list_init(&func_desc->custdata_list);
 
     ++This->typeattr.cFuncs;
+    TLB_invalidate_name_index(This);
 
     This->needs_layout = TRUE;
 
@@ -10887,6 +11199,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddVarDesc(ICreateTypeInfo2 *iface,
     var_desc->vardesc = *var_desc->vardesc_create;
 
     ++This->typeattr.cVars;
+    TLB_invalidate_name_index(This);
 
     This->needs_layout = TRUE;
 
@@ -10932,6 +11245,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetFuncAndParamNames(ICreateTypeInfo2 *
         TLBParDesc *par_desc = func_desc->pParamDesc + i - 1;
         par_desc->Name = TLB_append_str(&This->pTypeLib->name_list, *(names + i));
     }
+    TLB_invalidate_name_index(This);
 
     return S_OK;
 }
@@ -10950,6 +11264,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetVarName(ICreateTypeInfo2 *iface,
         return TYPE_E_ELEMENTNOTFOUND;
 
     This->vardescs[index].Name = TLB_append_str(&This->pTypeLib->name_list, name);
+    TLB_invalidate_name_index(This);
     return S_OK;
 }
 
@@ -11234,6 +11549,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnDeleteFuncDesc(ICreateTypeInfo2 *iface,
         for (i = index; i < This->typeattr.cFuncs; ++i)
             TLB_relink_custdata(&This->funcdescs[i].custdata_list);
     }
+    TLB_invalidate_name_index(This);
 
     This->needs_layout = TRUE;
 
@@ -11378,6 +11694,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetName(ICreateTypeInfo2 *iface,
         return E_INVALIDARG;
 
     This->Name = TLB_append_str(&This->pTypeLib->name_list, name);
+    TLB_invalidate_name_index(This);
 
     return S_OK;
 }
@@ -52,11 +52,70 @@ static inline BOOL is_oicf_stubdesc(const PMIDL_STUB_DESC pStubDesc)
     return pStubDesc->Version >= 0x20000;
 }
 
+/* Parameters whose wire representation is an exact copy of their memory
+ * representation, that is fixed-size base types and structures without
+ * pointers, are copied directly instead of going through the type format
+ * interpreter. Returns the format character of such parameters, 0 otherwise. */
+static inline unsigned char get_flat_param_layout(const MIDL_STUB_MESSAGE *pStubMsg, const NDR_PARAM_OIF *param,
+                                                  ULONG *size, ULONG *align)
+{
+    PFORMAT_STRING pFormat;
+
+    if (param->attr.IsBasetype)
+    {
+        switch (param->u.type_format_char)
+        {
+        case FC_BYTE:
+        case FC_CHAR:
+        case FC_SMALL:
+        case FC_USMALL:
+            *size = sizeof(UCHAR);
+            break;
+        case FC_WCHAR:
+        case FC_SHORT:
+        case FC_USHORT:
+            *size = sizeof(USHORT);
+            break;
+        case FC_LONG:
+        case FC_ULONG:
+        case FC_ENUM32:
+        case FC_ERROR_STATUS_T:
+        case FC_FLOAT:
+            *size = sizeof(ULONG);
+            break;
+        case FC_HYPER:
+        case FC_DOUBLE:
+            *size = sizeof(ULONGLONG);
+            break;
+        default:
+            return 0;
+        }
+        *align = *size;
+        return param->u.type_format_char;
+    }
+
+    pFormat = &pStubMsg->StubDesc->pFormatTypes[param->u.type_offset];
+    if (pFormat[0] != FC_STRUCT) return 0;
+    *size = *(const WORD *)(pFormat + 2);
+    *align = pFormat[1] + 1;
+    return FC_STRUCT;
+}
+
 static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char *pMemory,
                                      const NDR_PARAM_OIF *param)
 {
     PFORMAT_STRING pFormat;
     NDR_BUFFERSIZE m;
+    ULONG size, align;
+
+    if (get_flat_param_layout(pStubMsg, param, &size, &align))
+    {
+        pStubMsg->BufferLength = (pStubMsg->BufferLength + align - 1) & ~(align - 1);
+        if (pStubMsg->BufferLength + size < pStubMsg->BufferLength)
+            RpcRaiseException(RPC_X_BAD_STUB_DATA);
+        pStubMsg->BufferLength += size;
+        return;
+    }
 
     if (param->attr.IsBasetype)
     {
@@ -83,6 +142,8 @@ static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsign
 {
     PFORMAT_STRING pFormat;
     NDR_MARSHALL m;
+    ULONG size, align;
+    unsigned char fc;
 
     if (param->attr.IsBasetype)
     {
@@ -95,6 +156,21 @@ static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsign
         if (!param->attr.IsByValue) pMemory = *(unsigned char **)pMemory;
     }
 
+    if ((fc = get_flat_param_layout(pStubMsg, param, &size, &align)))
+    {
+        unsigned char *end = (unsigned char *)pStubMsg->RpcMsg->Buffer + pStubMsg->BufferLength;
+        ULONG_PTR mask = align - 1;
+
+        memset(pStubMsg->Buffer, 0, (align - (ULONG_PTR)pStubMsg->Buffer) & mask);
+        pStubMsg->Buffer = (unsigned char *)(((ULONG_PTR)pStubMsg->Buffer + mask) & ~mask);
+        if (pStubMsg->Buffer + size < pStubMsg->Buffer || pStubMsg->Buffer + size > end)
+            RpcRaiseException(RPC_X_BAD_STUB_DATA);
+        if (fc == FC_STRUCT) pStubMsg->BufferMark = pStubMsg->Buffer;
+        memcpy(pStubMsg->Buffer, pMemory, size);
+        pStubMsg->Buffer += size;
+        return NULL;
+    }
+
     m = NdrMarshaller[pFormat[0] & NDR_TABLE_MASK];
     if (m) return m(pStubMsg, pMemory, pFormat);
     else
@@ -110,6 +186,8 @@ static inline unsigned char *call_unmarshaller(PMIDL_STUB_MESSAGE pStubMsg, unsi
 {
     PFORMAT_STRING pFormat;
     NDR_UNMARSHALL m;
+    ULONG size, align;
+    unsigned char fc;
 
     if (param->attr.IsBasetype)
     {
@@ -122,6 +200,20 @@ static inline unsigned char *call_unmarshaller(PMIDL_STUB_MESSAGE pStubMsg, unsi
         if (!param->attr.IsByValue) ppMemory = (unsigned char **)*ppMemory;
     }
 
+    /* servers may point straight into the buffer, leave that to the interpreter */
+    if (pStubMsg->IsClient && !fMustAlloc && (fc = get_flat_param_layout(pStubMsg, param, &size, &align)))
+    {
+        ULONG_PTR mask = align - 1;
+
+        pStubMsg->Buffer = (unsigned char *)(((ULONG_PTR)pStubMsg->Buffer + mask) & ~mask);
+        if (pStubMsg->Buffer + size < pStubMsg->Buffer || pStubMsg->Buffer + size > pStubMsg->BufferEnd)
+            RpcRaiseException(RPC_X_BAD_STUB_DATA);
+        if (fc == FC_STRUCT) pStubMsg->BufferMark = pStubMsg->Buffer;
+        memcpy(*ppMemory, pStubMsg->Buffer, size);
+        pStubMsg->Buffer += size;
+        return NULL;
+    }
+
     m = NdrUnmarshaller[pFormat[0] & NDR_TABLE_MASK];
     if (m) return m(pStubMsg, ppMemory, pFormat, fMustAlloc);
     else
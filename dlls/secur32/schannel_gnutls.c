@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <dlfcn.h>
 #ifdef SONAME_LIBGNUTLS
@@ -80,6 +81,9 @@ static int (*pgnutls_privkey_import_rsa_raw)(gnutls_privkey_t, const gnutls_datu
 /* Not present in gnutls version < 3.4.0. */
 static int (*pgnutls_privkey_export_x509)(gnutls_privkey_t, gnutls_x509_privkey_t *);
 
+/* Not present in gnutls version < 3.5.1. */
+static unsigned int (*pgnutls_session_get_flags)(gnutls_session_t);
+
 static void *libgnutls_handle;
 #define MAKE_FUNCPTR(f) static typeof(f) * p##f
 MAKE_FUNCPTR(gnutls_alert_get);
@@ -112,6 +116,9 @@ MAKE_FUNCPTR(gnutls_record_recv);
 MAKE_FUNCPTR(gnutls_record_send);
 MAKE_FUNCPTR(gnutls_server_name_set);
 MAKE_FUNCPTR(gnutls_session_channel_binding);
+MAKE_FUNCPTR(gnutls_session_get_data);
+MAKE_FUNCPTR(gnutls_session_is_resumed);
+MAKE_FUNCPTR(gnutls_session_set_data);
 MAKE_FUNCPTR(gnutls_set_default_priority);
 MAKE_FUNCPTR(gnutls_transport_get_ptr);
 MAKE_FUNCPTR(gnutls_transport_set_errno);
@@ -146,6 +153,11 @@ MAKE_FUNCPTR(gnutls_x509_privkey_deinit);
 #define GNUTLS_ALPN_SERVER_PRECEDENCE (1<<1)
 #endif
 
+#if GNUTLS_VERSION_MAJOR < 3 || (GNUTLS_VERSION_MAJOR == 3 && GNUTLS_VERSION_MINOR < 6)
+#define GNUTLS_TLS1_3 5
+#define GNUTLS_SFLAGS_SESSION_TICKET (1<<7)
+#endif
+
 static inline gnutls_session_t session_from_handle(UINT64 handle)
 {
    return (gnutls_session_t)(ULONG_PTR)handle;
@@ -169,8 +181,138 @@ struct schan_transport
     gnutls_session_t session;
     struct schan_buffers in;
     struct schan_buffers out;
+    BOOL resumable;
+    BOOL handshake_done;
+    char *target;
+    UINT64 credentials;
+    DWORD enabled_protocols;
 };
 
+/* client session resumption data, keyed by target name and credentials */
+struct session_cache_entry
+{
+    char *target;
+    UINT64 credentials;
+    DWORD enabled_protocols;
+    void *data;
+    size_t size;
+};
+
+#define SESSION_CACHE_SIZE 32
+
+static pthread_mutex_t session_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct session_cache_entry session_cache[SESSION_CACHE_SIZE];
+static unsigned int session_cache_next;
+
+static void free_session_cache_entry( struct session_cache_entry *entry )
+{
+    free( entry->target );
+    free( entry->data );
+    memset( entry, 0, sizeof(*entry) );
+}
+
+/* caller must hold session_cache_mutex */
+static struct session_cache_entry *find_session_cache_entry( const struct schan_transport *t )
+{
+    unsigned int i;
+
+    for (i = 0; i < SESSION_CACHE_SIZE; i++)
+    {
+        struct session_cache_entry *entry = &session_cache[i];
+        if (entry->target && entry->credentials == t->credentials &&
+            entry->enabled_protocols == t->enabled_protocols && !strcmp( entry->target, t->target ))
+            return entry;
+    }
+    return NULL;
+}
+
+static void resume_cached_session( struct schan_transport *t )
+{
+    struct session_cache_entry *entry;
+    int err;
+
+    pthread_mutex_lock( &session_cache_mutex );
+    if ((entry = find_session_cache_entry( t )))
+    {
+        TRACE( "resuming session for %s\n", debugstr_a(t->target) );
+        if ((err = pgnutls_session_set_data( t->session, entry->data, entry->size )) != GNUTLS_E_SUCCESS)
+        {
+            pgnutls_perror( err );
+            free_session_cache_entry( entry );
+        }
+    }
+    pthread_mutex_unlock( &session_cache_mutex );
+}
+
+static void cache_session( struct schan_transport *t )
+{
+    struct session_cache_entry *entry;
+    size_t size = 0;
+    void *data;
+
+    if (!t->resumable || !t->target || !t->handshake_done) return;
+
+    /* TLS 1.3 tickets arrive after the handshake; asking for the session data before one has
+     * been received makes gnutls try to read it from the transport */
+    if (pgnutls_protocol_get_version( t->session ) == GNUTLS_TLS1_3 &&
+        !(pgnutls_session_get_flags( t->session ) & GNUTLS_SFLAGS_SESSION_TICKET))
+        return;
+
+    if (pgnutls_session_get_data( t->session, NULL, &size ) != GNUTLS_E_SUCCESS || !size) return;
+    if (!(data = malloc( size ))) return;
+    if (pgnutls_session_get_data( t->session, data, &size ) != GNUTLS_E_SUCCESS)
+    {
+        free( data );
+        return;
+    }
+
+    pthread_mutex_lock( &session_cache_mutex );
+    if ((entry = find_session_cache_entry( t ))) free( entry->data );
+    else
+    {
+        entry = &session_cache[session_cache_next++ % SESSION_CACHE_SIZE];
+        free_session_cache_entry( entry );
+        if (!(entry->target = strdup( t->target )))
+        {
+            pthread_mutex_unlock( &session_cache_mutex );
+            free( data );
+            return;
+        }
+        entry->credentials = t->credentials;
+        entry->enabled_protocols = t->enabled_protocols;
+    }
+    entry->data = data;
+    entry->size = size;
+    pthread_mutex_unlock( &session_cache_mutex );
+
+    t->resumable = FALSE;
+}
+
+static void purge_session_cache( UINT64 credentials )
+{
+    unsigned int i;
+
+    pthread_mutex_lock( &session_cache_mutex );
+    for (i = 0; i < SESSION_CACHE_SIZE; i++)
+        if (session_cache[i].target && session_cache[i].credentials == credentials)
+            free_session_cache_entry( &session_cache[i] );
+    pthread_mutex_unlock( &session_cache_mutex );
+}
+
+static void purge_session_cache_all(void)
+{
+    unsigned int i;
+
+    pthread_mutex_lock( &session_cache_mutex );
+    for (i = 0; i < SESSION_CACHE_SIZE; i++) free_session_cache_entry( &session_cache[i] );
+    pthread_mutex_unlock( &session_cache_mutex );
+}
+
+static unsigned int compat_gnutls_session_get_flags(gnutls_session_t session)
+{
+    return 0;
+}
+
 static int compat_cipher_get_block_size(gnutls_cipher_algorithm_t cipher)
 {
     switch(cipher) {
@@ -521,6 +663,12 @@ static NTSTATUS schan_create_session( void *args )
         return STATUS_INTERNAL_ERROR;
     }
     transport->session = s;
+    if (!(flags & (GNUTLS_SERVER | GNUTLS_DATAGRAM)))
+    {
+        transport->resumable = TRUE;
+        transport->credentials = cred->credentials;
+        transport->enabled_protocols = cred->enabled_protocols;
+    }
 
     if ((status = set_priority(cred, s)))
     {
@@ -552,8 +700,10 @@ static NTSTATUS schan_dispose_session( void *args )
     const struct session_params *params = args;
     gnutls_session_t s = session_from_handle(params->session);
     struct schan_transport *t = (struct schan_transport *)pgnutls_transport_get_ptr(s);
+    cache_session(t);
     pgnutls_transport_set_ptr(s, NULL);
     pgnutls_deinit(s);
+    free(t->target);
     free(t);
     return STATUS_SUCCESS;
 }
@@ -562,7 +712,12 @@ static NTSTATUS schan_set_session_target( void *args )
 {
     const struct set_session_target_params *params = args;
     gnutls_session_t s = session_from_handle(params->session);
+    struct schan_transport *t = (struct schan_transport *)pgnutls_transport_get_ptr(s);
+
     pgnutls_server_name_set( s, GNUTLS_NAME_DNS, params->target, strlen(params->target) );
+
+    if (t->resumable && !t->target && (t->target = strdup( params->target )))
+        resume_cached_session(t);
     return STATUS_SUCCESS;
 }
 
@@ -657,7 +812,9 @@ static NTSTATUS schan_handshake( void *args )
         err = pgnutls_handshake(s);
         if (err == GNUTLS_E_SUCCESS)
         {
-            TRACE("Handshake completed\n");
+            TRACE("Handshake completed%s\n", pgnutls_session_is_resumed(s) ? " (resumed)" : "");
+            t->handshake_done = TRUE;
+            cache_session(t);
             status = SEC_E_OK;
         }
         else if (err == GNUTLS_E_AGAIN)
@@ -1453,6 +1610,7 @@ static NTSTATUS schan_allocate_certificate_credentials( void *args )
 static NTSTATUS schan_free_certificate_credentials( void *args )
 {
     const struct free_certificate_credentials_params *params = args;
+    purge_session_cache(params->c->credentials);
     pgnutls_certificate_free_credentials(certificate_creds_from_handle(params->c->credentials));
     return STATUS_SUCCESS;
 }
@@ -1520,6 +1678,9 @@ static NTSTATUS process_attach( void *args )
     LOAD_FUNCPTR(gnutls_record_send);
     LOAD_FUNCPTR(gnutls_server_name_set)
     LOAD_FUNCPTR(gnutls_session_channel_binding)
+    LOAD_FUNCPTR(gnutls_session_get_data)
+    LOAD_FUNCPTR(gnutls_session_is_resumed)
+    LOAD_FUNCPTR(gnutls_session_set_data)
     LOAD_FUNCPTR(gnutls_set_default_priority)
     LOAD_FUNCPTR(gnutls_transport_get_ptr)
     LOAD_FUNCPTR(gnutls_transport_set_errno)
@@ -1572,6 +1733,11 @@ static NTSTATUS process_attach( void *args )
         WARN("gnutls_privkey_import_rsa_raw not found\n");
         pgnutls_privkey_import_rsa_raw = compat_gnutls_privkey_import_rsa_raw;
     }
+    if (!(pgnutls_session_get_flags = dlsym(libgnutls_handle, "gnutls_session_get_flags")))
+    {
+        WARN("gnutls_session_get_flags not found\n");
+        pgnutls_session_get_flags = compat_gnutls_session_get_flags;
+    }
 
     ret = pgnutls_global_init();
     if (ret != GNUTLS_E_SUCCESS)
@@ -1600,6 +1766,7 @@ fail:
 
 static NTSTATUS process_detach( void *args )
 {
+    purge_session_cache_all();
     pgnutls_global_deinit();
     dlclose(libgnutls_handle);
     libgnutls_handle = NULL;
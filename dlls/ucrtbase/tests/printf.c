@@ -864,6 +864,105 @@ static void test_printf_fp(void)
     }
 }
 
+/* rounds exact decimal string to prec fractional digits, returns TRUE on carry out */
+static BOOL round_decimal(char *str, int prec, BOOL standard_rounding)
+{
+    char *dot = strchr(str, '.'), *end = dot + 1 + prec, *p;
+    BOOL up = FALSE;
+
+    if (*end > '5')
+        up = TRUE;
+    else if (*end == '5')
+    {
+        if (!standard_rounding || end[1 + strspn(end + 1, "0")])
+            up = TRUE;
+        else
+            up = ((prec ? end[-1] : dot[-1]) - '0') & 1;
+    }
+    *(prec ? end : dot) = 0;
+
+    if (!up) return FALSE;
+    for (p = str + strlen(str) - 1; p >= str; p--)
+    {
+        if (*p == '.') continue;
+        if (*p != '9')
+        {
+            (*p)++;
+            return FALSE;
+        }
+        *p = '0';
+    }
+    return TRUE;
+}
+
+static void test_printf_fp_random(void)
+{
+    static const int flags[] = { 0, _CRT_INTERNAL_PRINTF_STANDARD_ROUNDING };
+    unsigned __int64 seed = 0x2545f4914f6cdd1d, m;
+    char exact[512], res[2][512], fmt[16], buf[512], *e;
+    int i, j, k, prec, exp, r;
+    double d;
+
+    for (i = 0; i < 1000; i++)
+    {
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+        m = seed >> 11;
+        /* short dyadic fractions end with 5 and test rounding ties */
+        if (i % 2)
+            d = ldexp(m, (int)(seed % 100) - 90);
+        else
+            d = ldexp(m % 1000000, -(int)(seed % 24));
+
+        for (prec = 0; prec < 18; prec++)
+        {
+            /* %e and %f results are compared against exact value rounded here */
+            for (k = 0; k < 2; k++)
+            {
+                vsprintf_wrapper(0, exact, sizeof(exact), "%.400e", d);
+                e = strchr(exact, 'e');
+                *e = 0;
+                exp = atoi(e + 1);
+                strcpy(res[k], exact);
+                if (round_decimal(res[k], prec, k))
+                {
+                    res[k][0] = '1';
+                    exp++;
+                }
+                sprintf(res[k] + strlen(res[k]), "e%+03d", exp);
+            }
+
+            sprintf(fmt, "%%.%de", prec);
+            for (j = 0; j < ARRAY_SIZE(flags); j++)
+            {
+                r = vsprintf_wrapper(flags[j], buf, sizeof(buf), fmt, d);
+                ok(r == strlen(buf), "r = %d\n", r);
+                ok(!strcmp(buf, res[j]) || broken(j && !strcmp(buf, res[0])),
+                        "%s %.17g: buf = %s, expected %s\n", fmt, d, buf, res[j]);
+            }
+
+            for (k = 0; k < 2; k++)
+            {
+                vsprintf_wrapper(0, exact, sizeof(exact), "%.400f", d);
+                res[k][0] = '0';
+                strcpy(res[k] + 1, exact);
+                if (!round_decimal(res[k] + 1, prec, k))
+                    memmove(res[k], res[k] + 1, strlen(res[k]));
+                else
+                    res[k][0] = '1';
+            }
+
+            sprintf(fmt, "%%.%df", prec);
+            for (j = 0; j < ARRAY_SIZE(flags); j++)
+            {
+                r = vsprintf_wrapper(flags[j], buf, sizeof(buf), fmt, d);
+                ok(r == strlen(buf), "r = %d\n", r);
+                ok(!strcmp(buf, res[j]) || broken(j && !strcmp(buf, res[0])),
+                        "%s %.17g: buf = %s, expected %s\n", fmt, d, buf, res[j]);
+            }
+        }
+    }
+}
+
 static void test_printf_width_specification(void)
 {
     int r;
@@ -899,5 +998,6 @@ START_TEST(printf)
     test_printf_c99();
     test_printf_natural_string();
     test_printf_fp();
+    test_printf_fp_random();
     test_printf_width_specification();
 }
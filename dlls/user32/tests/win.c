@@ -12875,6 +12875,9 @@ static void other_process_proc(HWND hwnd)
 {
     HANDLE window_ready_event, test_done_event;
     WINDOWPLACEMENT wp = {0};
+    char buffer[64];
+    LONG style;
+    RECT rect;
     DWORD ret;
 
     window_ready_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_opw_window");
@@ -12889,6 +12892,25 @@ static void other_process_proc(HWND hwnd)
     ok(ret, "Unexpected ret %#lx.\n", ret);
     ok(wp.showCmd == SW_SHOWNORMAL, "Unexpected showCmd %#x.\n", wp.showCmd);
     ok(!wp.flags, "Unexpected flags %#x.\n", wp.flags);
+    ok(IsWindow(hwnd), "IsWindow failed.\n");
+    ok(IsWindowVisible(hwnd), "IsWindowVisible failed.\n");
+    ok(!IsIconic(hwnd), "Unexpected iconic window.\n");
+    style = GetWindowLongA(hwnd, GWL_STYLE);
+    ok((style & (WS_POPUP | WS_VISIBLE)) == (WS_POPUP | WS_VISIBLE), "Unexpected style %#lx.\n", style);
+    ok(!GetParent(hwnd), "Unexpected parent %p.\n", GetParent(hwnd));
+    ok(GetAncestor(hwnd, GA_PARENT) == GetDesktopWindow(), "Unexpected ancestor %p.\n", GetAncestor(hwnd, GA_PARENT));
+    ok(GetAncestor(hwnd, GA_ROOT) == hwnd, "Unexpected root %p.\n", GetAncestor(hwnd, GA_ROOT));
+    ok(!GetWindow(hwnd, GW_OWNER), "Unexpected owner %p.\n", GetWindow(hwnd, GW_OWNER));
+    ret = GetWindowRect(hwnd, &rect);
+    ok(ret, "GetWindowRect failed.\n");
+    ok(rect.right > rect.left && rect.bottom > rect.top, "Unexpected rect %s.\n", wine_dbgstr_rect(&rect));
+    ret = GetClientRect(hwnd, &rect);
+    ok(ret, "GetClientRect failed.\n");
+    ok(!rect.left && !rect.top, "Unexpected rect %s.\n", wine_dbgstr_rect(&rect));
+    ret = GetClassNameA(hwnd, buffer, ARRAY_SIZE(buffer));
+    ok(ret && !lstrcmpiA(buffer, "static"), "Unexpected class name %s.\n", debugstr_a(buffer));
+    ret = GetClassLongA(hwnd, GCW_ATOM);
+    ok(ret, "Unexpected class atom %#lx.\n", ret);
     SetEvent(test_done_event);
 
     /* SW_SHOWMAXIMIZED */
@@ -12907,6 +12929,8 @@ static void other_process_proc(HWND hwnd)
     ok(ret, "Unexpected ret %#lx.\n", ret);
     ok(wp.showCmd == SW_SHOWMINIMIZED, "Unexpected showCmd %#x.\n", wp.showCmd);
     todo_wine ok(wp.flags == WPF_RESTORETOMAXIMIZED, "Unexpected flags %#x.\n", wp.flags);
+    ok(IsIconic(hwnd), "Expected iconic window.\n");
+    ok(!IsZoomed(hwnd), "Unexpected zoomed window.\n");
     SetEvent(test_done_event);
 
     /* SW_RESTORE */
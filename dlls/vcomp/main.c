@@ -60,6 +60,9 @@ static RTL_CRITICAL_SECTION vcomp_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 #define VCOMP_DYNAMIC_FLAGS_GUIDED      0x03
 #define VCOMP_DYNAMIC_FLAGS_INCREMENT   0x40
 
+/* number of pause iterations before a waiting thread goes to sleep */
+#define VCOMP_SPIN_COUNT                4000
+
 struct vcomp_thread_data
 {
     struct vcomp_team_data  *team;
@@ -97,22 +100,29 @@ struct vcomp_team_data
     va_list                 valist;
 
     /* barrier */
-    unsigned int            barrier;
-    int                     barrier_count;
+    LONG                    barrier;
+    LONG                    barrier_count;
 };
 
+/* Work sharing constructs are identified by a per-thread generation counter. The
+ * shared state of a construct is a 64-bit value holding its generation in the high
+ * part and the next section index or remaining iteration count in the low part, so
+ * that work can be handed out with a single compare-and-swap. The thread which
+ * moves the state to a new generation fills in the remaining fields and then
+ * publishes the generation in the corresponding "ready" field. */
 struct vcomp_task_data
 {
     /* single */
-    unsigned int            single;
+    LONG                    single;
 
     /* section */
-    unsigned int            section;
+    LONG64                  section_state;
+    LONG                    section_ready;
     int                     num_sections;
-    int                     section_index;
 
     /* dynamic */
-    unsigned int            dynamic;
+    LONG64                  dynamic_state;
+    LONG                    dynamic_ready;
     unsigned int            dynamic_first;
     unsigned int            dynamic_last;
     unsigned int            dynamic_iterations;
@@ -258,8 +268,10 @@ static struct vcomp_thread_data *vcomp_init_thread_data(void)
     }
 
     data->task.single           = 0;
-    data->task.section          = 0;
-    data->task.dynamic          = 0;
+    data->task.section_state    = 0;
+    data->task.section_ready    = 0;
+    data->task.dynamic_state    = 0;
+    data->task.dynamic_ready    = 0;
 
     thread_data = &data->thread;
     thread_data->team           = NULL;
@@ -903,29 +915,80 @@ void CDECL _vcomp_flush(void)
     TRACE("(): stub\n");
 }
 
+static inline LONG64 read_state(LONG64 *state)
+{
+    return InterlockedCompareExchange64(state, 0, 0);
+}
+
+static inline unsigned int state_generation(LONG64 state)
+{
+    return (ULONG64)state >> 32;
+}
+
+/* returns TRUE if the caller has to initialize the construct with generation gen */
+static BOOL claim_construct(LONG64 *state, unsigned int gen)
+{
+    LONG64 old;
+
+    for (;;)
+    {
+        old = read_state(state);
+        if ((int)(gen - state_generation(old)) <= 0)
+            return FALSE;
+        if (InterlockedCompareExchange64(state, (LONG64)gen << 32, old) == old)
+            return TRUE;
+    }
+}
+
+static void publish_construct(LONG64 *state, LONG *ready, unsigned int gen, unsigned int count)
+{
+    /* nobody else modifies a claimed state until it is published */
+    InterlockedCompareExchange64(state, ((LONG64)gen << 32) | count, (LONG64)gen << 32);
+    InterlockedExchange(ready, gen);
+}
+
+static void wait_construct(LONG *ready, unsigned int gen)
+{
+    unsigned int spin = 0;
+
+    while ((int)(gen - *(volatile LONG *)ready) > 0)
+    {
+        if (++spin < VCOMP_SPIN_COUNT)
+            YieldProcessor();
+        else
+            SwitchToThread();
+    }
+}
+
 void CDECL _vcomp_barrier(void)
 {
     struct vcomp_team_data *team_data = vcomp_init_thread_data()->team;
+    LONG barrier;
+    int spin;
 
     TRACE("()\n");
 
     if (!team_data)
         return;
 
-    EnterCriticalSection(&vcomp_section);
-    if (++team_data->barrier_count >= team_data->num_threads)
+    barrier = *(volatile LONG *)&team_data->barrier;
+    if (InterlockedIncrement(&team_data->barrier_count) >= team_data->num_threads)
     {
-        team_data->barrier++;
         team_data->barrier_count = 0;
-        WakeAllConditionVariable(&team_data->cond);
+        InterlockedIncrement(&team_data->barrier);
+        RtlWakeAddressAll(&team_data->barrier);
+        return;
     }
-    else
+
+    for (spin = 0; spin < VCOMP_SPIN_COUNT; spin++)
     {
-        unsigned int barrier = team_data->barrier;
-        while (team_data->barrier == barrier)
-            SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
+        if (*(volatile LONG *)&team_data->barrier != barrier)
+            return;
+        YieldProcessor();
     }
-    LeaveCriticalSection(&vcomp_section);
+
+    while (*(volatile LONG *)&team_data->barrier == barrier)
+        RtlWaitOnAddress(&team_data->barrier, &barrier, sizeof(barrier), NULL);
 }
 
 void CDECL _vcomp_set_num_threads(int num_threads)
@@ -951,20 +1014,19 @@ int CDECL _vcomp_single_begin(int flags)
 {
     struct vcomp_thread_data *thread_data = vcomp_init_thread_data();
     struct vcomp_task_data *task_data = thread_data->task;
-    int ret = FALSE;
+    LONG single;
 
     TRACE("(%x): semi-stub\n", flags);
 
-    EnterCriticalSection(&vcomp_section);
     thread_data->single++;
-    if ((int)(thread_data->single - task_data->single) > 0)
+    for (;;)
     {
-        task_data->single = thread_data->single;
-        ret = TRUE;
+        single = *(volatile LONG *)&task_data->single;
+        if ((int)(thread_data->single - single) <= 0)
+            return FALSE;
+        if (InterlockedCompareExchange(&task_data->single, thread_data->single, single) == single)
+            return TRUE;
     }
-    LeaveCriticalSection(&vcomp_section);
-
-    return ret;
 }
 
 void CDECL _vcomp_single_end(void)
@@ -980,33 +1042,35 @@ void CDECL _vcomp_sections_init(int n)
 
     TRACE("(%d)\n", n);
 
-    EnterCriticalSection(&vcomp_section);
     thread_data->section++;
-    if ((int)(thread_data->section - task_data->section) > 0)
+    if (claim_construct(&task_data->section_state, thread_data->section))
     {
-        task_data->section       = thread_data->section;
-        task_data->num_sections  = n;
-        task_data->section_index = 0;
+        task_data->num_sections = n;
+        publish_construct(&task_data->section_state, &task_data->section_ready, thread_data->section, 0);
     }
-    LeaveCriticalSection(&vcomp_section);
+    else wait_construct(&task_data->section_ready, thread_data->section);
 }
 
 int CDECL _vcomp_sections_next(void)
 {
     struct vcomp_thread_data *thread_data = vcomp_init_thread_data();
     struct vcomp_task_data *task_data = thread_data->task;
-    int i = -1;
+    LONG64 state;
+    int i;
 
     TRACE("()\n");
 
-    EnterCriticalSection(&vcomp_section);
-    if (thread_data->section == task_data->section &&
-        task_data->section_index != task_data->num_sections)
+    for (;;)
     {
-        i = task_data->section_index++;
+        state = read_state(&task_data->section_state);
+        if (state_generation(state) != thread_data->section)
+            return -1;
+        i = (unsigned int)state;
+        if (i == task_data->num_sections)
+            return -1;
+        if (InterlockedCompareExchange64(&task_data->section_state, state + 1, state) == state)
+            return i;
     }
-    LeaveCriticalSection(&vcomp_section);
-    return i;
 }
 
 void CDECL _vcomp_for_static_simple_init(unsigned int first, unsigned int last, int step,
@@ -1316,19 +1380,19 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
             type = VCOMP_DYNAMIC_FLAGS_GUIDED;
         }
 
-        EnterCriticalSection(&vcomp_section);
         thread_data->dynamic++;
         thread_data->dynamic_type = type;
-        if ((int)(thread_data->dynamic - task_data->dynamic) > 0)
+        if (claim_construct(&task_data->dynamic_state, thread_data->dynamic))
         {
-            task_data->dynamic              = thread_data->dynamic;
             task_data->dynamic_first        = first;
             task_data->dynamic_last         = last;
             task_data->dynamic_iterations   = iterations;
             task_data->dynamic_step         = step;
             task_data->dynamic_chunksize    = chunksize;
+            publish_construct(&task_data->dynamic_state, &task_data->dynamic_ready,
+                              thread_data->dynamic, iterations);
         }
-        LeaveCriticalSection(&vcomp_section);
+        else wait_construct(&task_data->dynamic_ready, thread_data->dynamic);
     }
 }
 
@@ -1351,26 +1415,34 @@ int CDECL _vcomp_for_dynamic_next(unsigned int *begin, unsigned int *end)
     else if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_CHUNKED ||
              thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED)
     {
-        unsigned int iterations = 0;
-        EnterCriticalSection(&vcomp_section);
-        if (thread_data->dynamic == task_data->dynamic &&
-            task_data->dynamic_iterations != 0)
+        unsigned int iterations, remaining, first;
+        LONG64 state;
+
+        /* the fields of the construct only change after its state moved to a new
+         * generation, in which case the compare-and-swap below fails */
+        for (;;)
         {
-            iterations = min(task_data->dynamic_iterations, task_data->dynamic_chunksize);
+            state = read_state(&task_data->dynamic_state);
+            remaining = (unsigned int)state;
+            if (state_generation(state) != thread_data->dynamic || !remaining)
+                return 0;
+
+            iterations = min(remaining, task_data->dynamic_chunksize);
             if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED &&
-                task_data->dynamic_iterations > num_threads * task_data->dynamic_chunksize)
+                remaining > num_threads * task_data->dynamic_chunksize)
             {
-                iterations = (task_data->dynamic_iterations + num_threads - 1) / num_threads;
+                iterations = (remaining + num_threads - 1) / num_threads;
             }
-            *begin = task_data->dynamic_first;
-            *end   = task_data->dynamic_first + (iterations - 1) * task_data->dynamic_step;
-            task_data->dynamic_iterations -= iterations;
-            task_data->dynamic_first      += iterations * task_data->dynamic_step;
-            if (!task_data->dynamic_iterations)
+            first = task_data->dynamic_first +
+                    (task_data->dynamic_iterations - remaining) * task_data->dynamic_step;
+            *begin = first;
+            *end   = first + (iterations - 1) * task_data->dynamic_step;
+            if (iterations == remaining)
                 *end = task_data->dynamic_last;
+
+            if (InterlockedCompareExchange64(&task_data->dynamic_state, state - iterations, state) == state)
+                return 1;
         }
-        LeaveCriticalSection(&vcomp_section);
-        return iterations != 0;
     }
 
     return 0;
@@ -1406,6 +1478,22 @@ static DWORD WINAPI _vcomp_fork_worker(void *param)
                 WakeAllConditionVariable(&team->cond);
         }
 
+        /* back to back parallel regions usually reuse the same threads, so keep
+         * polling for a new team for a short while before going to sleep */
+        if (!thread_data->team)
+        {
+            int spin;
+
+            LeaveCriticalSection(&vcomp_section);
+            for (spin = 0; spin < VCOMP_SPIN_COUNT; spin++)
+            {
+                if (*(struct vcomp_team_data * volatile *)&thread_data->team) break;
+                YieldProcessor();
+            }
+            EnterCriticalSection(&vcomp_section);
+            if (thread_data->team) continue;
+        }
+
         if (!SleepConditionVariableCS(&thread_data->cond, &vcomp_section, 5000) &&
             GetLastError() == ERROR_TIMEOUT && !thread_data->team)
         {
@@ -1453,8 +1541,10 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
     team_data.barrier_count     = 0;
 
     task_data.single            = 0;
-    task_data.section           = 0;
-    task_data.dynamic           = 0;
+    task_data.section_state     = 0;
+    task_data.section_ready     = 0;
+    task_data.dynamic_state     = 0;
+    task_data.dynamic_ready     = 0;
 
     thread_data.team            = &team_data;
     thread_data.task            = &task_data;
@@ -1536,6 +1626,14 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
 
     if (team_data.num_threads > 1)
     {
+        int spin;
+
+        for (spin = 0; spin < VCOMP_SPIN_COUNT; spin++)
+        {
+            if (*(volatile int *)&team_data.finished_threads >= team_data.num_threads - 1) break;
+            YieldProcessor();
+        }
+
         EnterCriticalSection(&vcomp_section);
 
         team_data.finished_threads++;
@@ -1718,6 +1718,62 @@ static void test_vcomp_for_dynamic_init(void)
     pomp_set_num_threads(max_threads);
 }
 
+static void CDECL for_dynamic_stress_cb(LONG *counts, LONG *sections, LONG *single)
+{
+    unsigned int begin, end, flags;
+    int i, j;
+
+    for (i = 0; i < 100; i++)
+    {
+        flags = (i & 1) ? VCOMP_DYNAMIC_FLAGS_GUIDED : VCOMP_DYNAMIC_FLAGS_CHUNKED;
+        p_vcomp_for_dynamic_init(flags | VCOMP_DYNAMIC_FLAGS_INCREMENT, 0, 255, 1, 1 + (i % 3));
+        while (p_vcomp_for_dynamic_next(&begin, &end))
+        {
+            ok(begin <= end && end <= 255, "got begin %u, end %u\n", begin, end);
+            for (j = begin; j <= end && j <= 255; j++)
+                InterlockedIncrement(&counts[j]);
+        }
+
+        p_vcomp_sections_init(3);
+        while ((j = p_vcomp_sections_next()) != -1)
+        {
+            ok(j >= 0 && j < 3, "got section %d\n", j);
+            if (j >= 0 && j < 3) InterlockedIncrement(&sections[j]);
+        }
+
+        if (p_vcomp_single_begin(0))
+            InterlockedIncrement(single);
+        p_vcomp_single_end();
+
+        if (i % 10 == 9) p_vcomp_barrier();
+    }
+}
+
+static void test_vcomp_for_dynamic_stress(void)
+{
+    int max_threads = pomp_get_max_threads();
+    LONG counts[256], sections[3], single;
+    int i, j;
+
+    for (i = 1; i <= 8; i *= 2)
+    {
+        memset(counts, 0, sizeof(counts));
+        memset(sections, 0, sizeof(sections));
+        single = 0;
+
+        pomp_set_num_threads(i);
+        p_vcomp_fork(TRUE, 3, for_dynamic_stress_cb, counts, sections, &single);
+
+        for (j = 0; j < ARRAY_SIZE(counts); j++)
+            ok(counts[j] == 100, "%d threads: iteration %d executed %ld times\n", i, j, counts[j]);
+        for (j = 0; j < ARRAY_SIZE(sections); j++)
+            ok(sections[j] == 100, "%d threads: section %d executed %ld times\n", i, j, sections[j]);
+        ok(single == 100, "%d threads: single executed %ld times\n", i, single);
+    }
+
+    pomp_set_num_threads(max_threads);
+}
+
 static void CDECL master_cb(HANDLE semaphore)
 {
     int num_threads = pomp_get_num_threads();
@@ -2637,6 +2693,7 @@ START_TEST(vcomp)
     test_vcomp_for_static_simple_init();
     test_vcomp_for_static_init();
     test_vcomp_for_dynamic_init();
+    test_vcomp_for_dynamic_stress();
     test_vcomp_master_begin();
     test_vcomp_single_begin();
     test_vcomp_enter_critsect();
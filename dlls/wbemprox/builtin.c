@@ -1213,6 +1213,25 @@ static BOOL match_row( const struct table *table, UINT row, const struct expr *c
     return val != 0;
 }
 
+/* check if condition references the given property, expensive columns can be computed after
+ * match_row() for rows that pass the filter when it doesn't */
+static BOOL cond_uses_property( const struct expr *cond, const WCHAR *name )
+{
+    if (!cond) return FALSE;
+
+    switch (cond->type)
+    {
+    case EXPR_COMPLEX:
+        return cond_uses_property( cond->u.expr.left, name ) || cond_uses_property( cond->u.expr.right, name );
+    case EXPR_UNARY:
+        return cond_uses_property( cond->u.expr.left, name );
+    case EXPR_PROPVAL:
+        return !wcsicmp( cond->u.propval->name, name );
+    default:
+        return FALSE;
+    }
+}
+
 static BOOL resize_table( struct table *table, UINT row_count, UINT row_size )
 {
     if (!table->num_rows_allocated)
@@ -2171,6 +2190,7 @@ static enum fill_status fill_datafile( struct table *table, const struct expr *c
     HANDLE handle;
     struct dirstack *dirstack;
     enum fill_status status = FILL_STATUS_UNFILTERED;
+    BOOL need_version = cond_uses_property( cond, L"Version" );
 
     if (!resize_table( table, 8, sizeof(*rec) )) return FILL_STATUS_FAILED;
 
@@ -2225,14 +2245,15 @@ static enum fill_status fill_datafile( struct table *table, const struct expr *c
                     }
                     rec = (struct record_datafile *)(table->data + offset);
                     rec->name    = build_name( root[0], new_path );
-                    rec->version = get_file_version( rec->name );
+                    rec->version = need_version ? get_file_version( rec->name ) : NULL;
                     free( new_path );
                     if (!match_row( table, row, cond, &status ))
                     {
                         free_row_values( table, row );
                         continue;
                     }
-                    else if (num_expected_rows && row == num_expected_rows - 1)
+                    if (!need_version) rec->version = get_file_version( rec->name );
+                    if (num_expected_rows && row == num_expected_rows - 1)
                     {
                         row++;
                         FindClose( handle );
@@ -3529,6 +3550,8 @@ static enum fill_status fill_process( struct table *table, const struct expr *co
     HANDLE snap;
     enum fill_status status = FILL_STATUS_FAILED;
     UINT row = 0, offset = 0;
+    BOOL need_cmdline = cond_uses_property( cond, L"CommandLine" );
+    BOOL need_path = cond_uses_property( cond, L"ExecutablePath" );
 
     snap = CreateToolhelp32Snapshot( TH32CS_SNAPPROCESS, 0 );
     if (snap == INVALID_HANDLE_VALUE) return FILL_STATUS_FAILED;
@@ -3547,9 +3570,9 @@ static enum fill_status fill_process( struct table *table, const struct expr *co
 
         rec = (struct record_process *)(table->data + offset);
         rec->caption        = wcsdup( entry.szExeFile );
-        rec->commandline    = get_cmdline( entry.th32ProcessID );
+        rec->commandline    = need_cmdline ? get_cmdline( entry.th32ProcessID ) : NULL;
         rec->description    = wcsdup( entry.szExeFile );
-        rec->executablepath = get_executablepath( entry.th32ProcessID  );
+        rec->executablepath = need_path ? get_executablepath( entry.th32ProcessID ) : NULL;
         swprintf( handle, ARRAY_SIZE( handle ), L"%u", entry.th32ProcessID );
         rec->handle         = wcsdup( handle );
         rec->name           = wcsdup( entry.szExeFile );
@@ -3564,6 +3587,9 @@ static enum fill_status fill_process( struct table *table, const struct expr *co
             free_row_values( table, row );
             continue;
         }
+        /* these need to open the process, only do it for rows that made it through the filter */
+        if (!need_cmdline) rec->commandline = get_cmdline( entry.th32ProcessID );
+        if (!need_path) rec->executablepath = get_executablepath( entry.th32ProcessID );
         offset += sizeof(*rec);
         row++;
     } while (Process32NextW( snap, &entry ));
@@ -4572,11 +4598,11 @@ static struct table cimv2_builtin_classes[] =
     { L"SoftwareLicensingProduct", C(col_softwarelicensingproduct), D(data_softwarelicensingproduct) },
     { L"StdRegProv", C(col_stdregprov), D(data_stdregprov) },
     { L"SystemRestore", C(col_sysrestore), D(data_sysrestore) },
-    { L"Win32_BIOS", C(col_bios), 0, 0, NULL, fill_bios },
-    { L"Win32_BaseBoard", C(col_baseboard), 0, 0, NULL, fill_baseboard },
+    { L"Win32_BIOS", C(col_bios), 0, 0, NULL, fill_bios, 10000 },
+    { L"Win32_BaseBoard", C(col_baseboard), 0, 0, NULL, fill_baseboard, 10000 },
     { L"Win32_CDROMDrive", C(col_cdromdrive), 0, 0, NULL, fill_cdromdrive },
     { L"Win32_ComputerSystem", C(col_compsys), 0, 0, NULL, fill_compsys },
-    { L"Win32_ComputerSystemProduct", C(col_compsysproduct), 0, 0, NULL, fill_compsysproduct },
+    { L"Win32_ComputerSystemProduct", C(col_compsysproduct), 0, 0, NULL, fill_compsysproduct, 10000 },
     { L"Win32_DesktopMonitor", C(col_desktopmonitor), 0, 0, NULL, fill_desktopmonitor },
     { L"Win32_Directory", C(col_directory), 0, 0, NULL, fill_directory },
     { L"Win32_DiskDrive", C(col_diskdrive), 0, 0, NULL, fill_diskdrive },
@@ -4591,17 +4617,17 @@ static struct table cimv2_builtin_classes[] =
     { L"Win32_OperatingSystem", C(col_operatingsystem), 0, 0, NULL, fill_operatingsystem },
     { L"Win32_PageFileUsage", C(col_pagefileusage), D(data_pagefileusage) },
     { L"Win32_PhysicalMedia", C(col_physicalmedia), D(data_physicalmedia) },
-    { L"Win32_PhysicalMemory", C(col_physicalmemory), 0, 0, NULL, fill_physicalmemory },
-    { L"Win32_PhysicalMemoryArray", C(col_physicalmemoryarray), 0, 0, NULL, fill_physicalmemoryarray },
+    { L"Win32_PhysicalMemory", C(col_physicalmemory), 0, 0, NULL, fill_physicalmemory, 10000 },
+    { L"Win32_PhysicalMemoryArray", C(col_physicalmemoryarray), 0, 0, NULL, fill_physicalmemoryarray, 10000 },
     { L"Win32_PnPEntity", C(col_pnpentity), 0, 0, NULL, fill_pnpentity },
     { L"Win32_Printer", C(col_printer), 0, 0, NULL, fill_printer },
-    { L"Win32_Process", C(col_process), 0, 0, NULL, fill_process },
+    { L"Win32_Process", C(col_process), 0, 0, NULL, fill_process, 1000 },
     { L"Win32_Processor", C(col_processor), 0, 0, NULL, fill_processor },
     { L"Win32_QuickFixEngineering", C(col_quickfixengineering), D(data_quickfixengineering) },
     { L"Win32_SID", C(col_sid), 0, 0, NULL, fill_sid },
     { L"Win32_Service", C(col_service), 0, 0, NULL, fill_service },
     { L"Win32_SoundDevice", C(col_sounddevice), 0, 0, NULL, fill_sounddevice },
-    { L"Win32_SystemEnclosure", C(col_systemenclosure), 0, 0, NULL, fill_systemenclosure },
+    { L"Win32_SystemEnclosure", C(col_systemenclosure), 0, 0, NULL, fill_systemenclosure, 10000 },
     { L"Win32_VideoController", C(col_videocontroller), 0, 0, NULL, fill_videocontroller },
     { L"Win32_Volume", C(col_volume), 0, 0, NULL, fill_volume },
     { L"Win32_WinSAT", C(col_winsat), D(data_winsat) },
@@ -702,10 +702,13 @@ static HRESULT exec_select_view( struct view *view )
     if (!view->table_count) return S_OK;
 
     table = view->table[0];
-    if (table->fill)
+    /* conditional queries are usually looking for a specific object that may have just been
+     * created, so only serve unconditional queries from the cache */
+    if (table->fill && (view->cond || !table_cache_valid( table )))
     {
         clear_table( table );
         status = table->fill( table, view->cond );
+        update_table_cache( table, status );
     }
     if (status == FILL_STATUS_FAILED) return WBEM_E_FAILED;
     if (!table->num_rows) return S_OK;
@@ -922,6 +922,8 @@ static HRESULT WINAPI wbem_services_ExecMethod(
     if (hr != S_OK) goto done;
 
     hr = func( obj, context ? context : services->context, pInParams, ppOutParams );
+    /* methods may change what the provider reports */
+    invalidate_table_cache( table );
 
 done:
     if (result) IEnumWbemClassObject_Release( result );
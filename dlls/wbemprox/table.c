@@ -315,6 +315,7 @@ void clear_table( struct table *table )
 {
     UINT i;
 
+    table->cache_expiry = 0;
     if (!table->data) return;
 
     for (i = 0; i < table->num_rows; i++) free_row_values( table, i );
@@ -327,6 +328,25 @@ void clear_table( struct table *table )
     }
 }
 
+BOOL table_cache_valid( const struct table *table )
+{
+    return table->cache_expiry && GetTickCount64() < table->cache_expiry;
+}
+
+void update_table_cache( struct table *table, enum fill_status status )
+{
+    /* only a complete result can answer later queries with different conditions */
+    if (table->cache_ttl && status == FILL_STATUS_UNFILTERED)
+        table->cache_expiry = GetTickCount64() + table->cache_ttl;
+    else
+        table->cache_expiry = 0;
+}
+
+void invalidate_table_cache( struct table *table )
+{
+    table->cache_expiry = 0;
+}
+
 void free_columns( struct column *columns, UINT num_cols )
 {
     UINT i;
@@ -356,7 +376,7 @@ void release_table( struct table *table )
 {
     if (!--table->refs)
     {
-        clear_table( table );
+        if (!table_cache_valid( table )) clear_table( table );
         if (table->flags & TABLE_FLAG_DYNAMIC)
         {
             EnterCriticalSection( &table_list_cs );
@@ -415,9 +435,11 @@ struct table *create_table( const WCHAR *name, UINT num_cols, const struct colum
     table->num_rows_allocated = num_allocated;
     table->data               = data;
     table->fill               = fill;
+    table->cache_ttl          = 0;
     table->flags              = TABLE_FLAG_DYNAMIC;
     table->refs               = 0;
     table->removed            = FALSE;
+    table->cache_expiry       = 0;
     list_init( &table->entry );
     InitializeCriticalSectionEx( &table->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
     table->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": table.cs");
@@ -539,6 +539,45 @@ static void test_Win32_Process_created_process(void)
 {
 }
 
+/* returns the number of objects for the current process, checking that ExecutablePath is set */
+static unsigned int query_current_process( IWbemServices *services, const WCHAR *str, const WCHAR *executable_path )
+{
+    BSTR wql = SysAllocString( L"wql" ), query = SysAllocString( str );
+    LONG flags = WBEM_FLAG_RETURN_IMMEDIATELY | WBEM_FLAG_FORWARD_ONLY;
+    IEnumWbemClassObject *result;
+    IWbemClassObject *obj;
+    unsigned int found = 0;
+    VARIANT val;
+    ULONG count;
+    HRESULT hr;
+
+    hr = IWbemServices_ExecQuery( services, wql, query, flags, NULL, &result );
+    ok( hr == S_OK, "got %#lx\n", hr );
+    for (;;)
+    {
+        IEnumWbemClassObject_Next( result, 10000, 1, &obj, &count );
+        if (!count) break;
+
+        hr = IWbemClassObject_Get( obj, L"ProcessId", 0, &val, NULL, NULL );
+        ok( hr == S_OK, "got %#lx\n", hr );
+        if (V_UI4( &val ) == GetCurrentProcessId())
+        {
+            hr = IWbemClassObject_Get( obj, L"ExecutablePath", 0, &val, NULL, NULL );
+            ok( hr == S_OK, "got %#lx\n", hr );
+            ok( V_VT( &val ) == VT_BSTR, "unexpected variant type 0x%x\n", V_VT( &val ) );
+            if (V_VT( &val ) == VT_BSTR)
+                ok( !lstrcmpiW( V_BSTR( &val ), executable_path ), "got %s\n", wine_dbgstr_w(V_BSTR( &val )) );
+            VariantClear( &val );
+            found++;
+        }
+        IWbemClassObject_Release( obj );
+    }
+    IEnumWbemClassObject_Release( result );
+    SysFreeString( query );
+    SysFreeString( wql );
+    return found;
+}
+
 static void test_Win32_Process( IWbemServices *services, BOOL use_full_path )
 {
     static const LONG expected_flavor = WBEM_FLAVOR_FLAG_PROPAGATE_TO_INSTANCE |
@@ -781,6 +820,23 @@ static void test_Win32_Process( IWbemServices *services, BOOL use_full_path )
     VariantClear( &val );
     IWbemClassObject_Release( process );
 
+    if (!use_full_path)
+    {
+        WCHAR query[128];
+
+        wsprintfW( query, L"SELECT * FROM Win32_Process WHERE Handle = '%u'", GetCurrentProcessId() );
+        ret = query_current_process( services, query, executable_path );
+        ok( ret == 1, "got %lu\n", ret );
+        wsprintfW( query, L"SELECT * FROM Win32_Process WHERE ProcessId = %u AND ExecutablePath IS NOT NULL",
+                   GetCurrentProcessId() );
+        ret = query_current_process( services, query, executable_path );
+        ok( ret == 1, "got %lu\n", ret );
+        ret = query_current_process( services, L"SELECT * FROM Win32_Process", executable_path );
+        ok( ret == 1, "got %lu\n", ret );
+        ret = query_current_process( services, L"SELECT * FROM Win32_Process", executable_path );
+        ok( ret == 1, "got %lu\n", ret );
+    }
+
     IWbemQualifierSet_Release( qualifiers );
     IWbemClassObject_Release( out );
     SysFreeString( class );
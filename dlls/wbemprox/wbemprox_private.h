@@ -118,11 +118,13 @@ struct table
     UINT num_rows_allocated;
     BYTE *data;
     enum fill_status (*fill)(struct table *, const struct expr *cond);
+    UINT cache_ttl; /* milliseconds an unfiltered fill stays valid, 0 to refill on every query */
     UINT flags;
     struct list entry;
     LONG refs;
     CRITICAL_SECTION cs;
     BOOL removed;
+    ULONGLONG cache_expiry;
 };
 
 struct property
@@ -227,6 +229,9 @@ void free_columns( struct column *, UINT );
 void free_row_values( const struct table *, UINT );
 void clear_table( struct table * );
 void free_table( struct table * );
+BOOL table_cache_valid( const struct table * );
+void update_table_cache( struct table *, enum fill_status );
+void invalidate_table_cache( struct table * );
 UINT get_type_size( CIMTYPE );
 HRESULT eval_cond( const struct table *, UINT, const struct expr *, LONGLONG *, UINT * );
 HRESULT get_column_index( const struct table *, const WCHAR *, UINT * );
@@ -297,6 +297,27 @@ ATOM get_int_atom_value( UNICODE_STRING *name )
     return ret;
 }
 
+static BOOL get_shared_class_long( HWND hwnd, INT offset, ULONG_PTR *ret )
+{
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const class_shm_t *class_shm;
+    NTSTATUS status;
+
+    while ((status = get_shared_window_class( hwnd, &lock, &class_shm )) == STATUS_PENDING)
+    {
+        switch (offset)
+        {
+        case GCL_STYLE:      *ret = class_shm->style; break;
+        case GCL_CBWNDEXTRA: *ret = class_shm->win_extra; break;
+        case GCL_CBCLSEXTRA: *ret = class_shm->cls_extra; break;
+        case GCLP_HMODULE:   *ret = (ULONG_PTR)wine_server_get_ptr( class_shm->instance ); break;
+        case GCW_ATOM:       *ret = class_shm->atom; break;
+        default: return FALSE;
+        }
+    }
+    return !status;
+}
+
 /***********************************************************************
  *           get_class_ptr
  */
@@ -610,9 +631,15 @@ INT WINAPI NtUserGetClassName( HWND hwnd, BOOL real, UNICODE_STRING *name )
 
     if (class == OBJ_OTHER_PROCESS)
     {
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const class_shm_t *class_shm;
+        NTSTATUS status;
         ATOM atom = 0;
 
-        SERVER_START_REQ( set_class_info )
+        while ((status = get_shared_window_class( hwnd, &lock, &class_shm )) == STATUS_PENDING)
+            atom = class_shm->base_atom;
+
+        if (status) SERVER_START_REQ( set_class_info )
         {
             req->window = wine_server_user_handle( hwnd );
             req->flags = 0;
@@ -883,6 +910,8 @@ static ULONG_PTR get_class_long_size( HWND hwnd, INT offset, UINT size, BOOL ans
 
     if (class == OBJ_OTHER_PROCESS)
     {
+        if (offset < 0 && get_shared_class_long( hwnd, offset, &retvalue )) return retvalue;
+
         SERVER_START_REQ( set_class_info )
         {
             req->window = wine_server_user_handle( hwnd );
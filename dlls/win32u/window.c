@@ -253,6 +253,73 @@ WND *get_win_ptr( HWND hwnd )
     return win;
 }
 
+/* position information of a window read from session shared memory */
+struct shared_window_pos
+{
+    HWND parent;
+    UINT ex_style;
+    UINT dpi_context;
+    UINT monitor_dpi;
+    RECT window;
+    RECT client;
+};
+
+static BOOL get_shared_window_pos( HWND hwnd, struct shared_window_pos *pos )
+{
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm;
+    NTSTATUS status;
+
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+    {
+        pos->parent        = wine_server_ptr_handle( window_shm->parent );
+        pos->ex_style      = window_shm->ex_style;
+        pos->dpi_context   = window_shm->dpi_context;
+        pos->monitor_dpi   = window_shm->monitor_dpi;
+        pos->window.left   = window_shm->window_rect.left;
+        pos->window.top    = window_shm->window_rect.top;
+        pos->window.right  = window_shm->window_rect.right;
+        pos->window.bottom = window_shm->window_rect.bottom;
+        pos->client.left   = window_shm->client_rect.left;
+        pos->client.top    = window_shm->client_rect.top;
+        pos->client.right  = window_shm->client_rect.right;
+        pos->client.bottom = window_shm->client_rect.bottom;
+    }
+    return !status;
+}
+
+static BOOL get_shared_window_parent( HWND hwnd, HWND *parent )
+{
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm;
+    NTSTATUS status;
+
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+        *parent = wine_server_ptr_handle( window_shm->parent );
+    return !status;
+}
+
+static BOOL get_shared_window_long( HWND hwnd, INT offset, LONG_PTR *ret )
+{
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm;
+    NTSTATUS status;
+
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+    {
+        switch (offset)
+        {
+        case GWL_STYLE:      *ret = window_shm->style; break;
+        case GWL_EXSTYLE:    *ret = window_shm->ex_style; break;
+        case GWLP_ID:        *ret = window_shm->id; break;
+        case GWLP_HINSTANCE: *ret = (ULONG_PTR)wine_server_get_ptr( window_shm->instance ); break;
+        case GWLP_USERDATA:  *ret = window_shm->user_data; break;
+        default: return FALSE;
+        }
+    }
+    return !status;
+}
+
 /***********************************************************************
  *           is_current_thread_window
  *
@@ -289,8 +356,11 @@ HWND is_current_process_window( HWND hwnd )
 /* see IsWindow */
 BOOL is_window( HWND hwnd )
 {
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm;
+    NTSTATUS status;
     WND *win;
-    BOOL ret;
+    BOOL ret = FALSE;
 
     if (!(win = get_win_ptr( hwnd ))) return FALSE;
     if (win == WND_DESKTOP) return TRUE;
@@ -302,6 +372,10 @@ BOOL is_window( HWND hwnd )
     }
 
     /* check other processes */
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+        ret = !!window_shm->handle;
+    if (!status) return ret;
+
     SERVER_START_REQ( get_window_info )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -314,8 +388,11 @@ BOOL is_window( HWND hwnd )
 /* see GetWindowThreadProcessId */
 DWORD get_window_thread( HWND hwnd, DWORD *process )
 {
+    struct object_lock lock = OBJECT_LOCK_INIT;
+    const window_shm_t *window_shm;
+    NTSTATUS status;
+    DWORD tid = 0, pid = 0;
     WND *ptr;
-    DWORD tid = 0;
 
     if (!(ptr = get_win_ptr( hwnd )))
     {
@@ -333,6 +410,17 @@ DWORD get_window_thread( HWND hwnd, DWORD *process )
     }
 
     /* check other processes */
+    while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+    {
+        tid = window_shm->tid;
+        pid = window_shm->pid;
+    }
+    if (!status)
+    {
+        if (tid && process) *process = pid;
+        return tid;
+    }
+
     SERVER_START_REQ( get_window_info )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -360,7 +448,26 @@ HWND get_parent( HWND hwnd )
     if (win == WND_DESKTOP) return 0;
     if (win == WND_OTHER_PROCESS)
     {
-        LONG style = get_window_long( hwnd, GWL_STYLE );
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        HWND owner = 0, parent = 0;
+        NTSTATUS status;
+        LONG style = 0;
+
+        while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+        {
+            style  = window_shm->style;
+            owner  = wine_server_ptr_handle( window_shm->owner );
+            parent = wine_server_ptr_handle( window_shm->parent );
+        }
+        if (!status)
+        {
+            if (style & WS_POPUP) retval = owner;
+            else if (style & WS_CHILD) retval = parent;
+            return retval;
+        }
+
+        style = get_window_long( hwnd, GWL_STYLE );
         if (style & (WS_POPUP | WS_CHILD))
         {
             SERVER_START_REQ( get_window_tree )
@@ -500,6 +607,16 @@ HWND get_window_relative( HWND hwnd, UINT rel )
             release_win_ptr( win );
             return retval;
         }
+        else
+        {
+            struct object_lock lock = OBJECT_LOCK_INIT;
+            const window_shm_t *window_shm;
+            NTSTATUS status;
+
+            while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+                retval = wine_server_ptr_handle( window_shm->owner );
+            if (!status) return retval;
+        }
         /* else fall through to server call */
     }
 
@@ -553,16 +670,25 @@ static HWND *list_window_parents( HWND hwnd )
     for (;;)
     {
         if (!(win = get_win_ptr( current ))) goto empty;
-        if (win == WND_OTHER_PROCESS) break;  /* need to do it the hard way */
-        if (win == WND_DESKTOP)
+        if (win == WND_OTHER_PROCESS)
+        {
+            if (!get_shared_window_parent( current, &current )) break;  /* need to do it the hard way */
+            if (!current && !pos) goto empty;  /* desktop window */
+            list[pos] = current;
+            if (!current) return list;
+        }
+        else if (win == WND_DESKTOP)
         {
             if (!pos) goto empty;
             list[pos] = 0;
             return list;
         }
-        list[pos] = current = win->parent;
-        release_win_ptr( win );
-        if (!current) return list;
+        else
+        {
+            list[pos] = current = win->parent;
+            release_win_ptr( win );
+            if (!current) return list;
+        }
         if (++pos == size - 1)
         {
             /* need to grow the list */
@@ -573,7 +699,7 @@ static HWND *list_window_parents( HWND hwnd )
         }
     }
 
-    /* at least one parent belongs to another process, have to query the server */
+    /* the shared memory couldn't be used, have to query the server */
 
     for (;;)
     {
@@ -652,7 +778,7 @@ HWND WINAPI NtUserGetAncestor( HWND hwnd, UINT type )
             ret = win->parent;
             release_win_ptr( win );
         }
-        else /* need to query the server */
+        else if (!get_shared_window_parent( hwnd, &ret )) /* need to query the server */
         {
             SERVER_START_REQ( get_window_tree )
             {
@@ -778,6 +904,14 @@ BOOL is_window_unicode( HWND hwnd )
     }
     else
     {
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        NTSTATUS status;
+
+        while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+            ret = !!window_shm->is_unicode;
+        if (!status) return ret;
+
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -876,6 +1010,14 @@ UINT get_window_dpi_awareness_context( HWND hwnd )
     }
     else
     {
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        NTSTATUS status;
+
+        while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+            ret = window_shm->dpi_context;
+        if (!status) return ret;
+
         SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -909,7 +1051,14 @@ UINT get_dpi_for_window( HWND hwnd )
     }
     else
     {
-        SERVER_START_REQ( get_window_info )
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        NTSTATUS status;
+
+        while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+            context = window_shm->dpi_context;
+
+        if (status) SERVER_START_REQ( get_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
             if (!wine_server_call_err( req )) context = reply->dpi_context;
@@ -1034,6 +1183,8 @@ static LONG_PTR get_window_long_size( HWND hwnd, INT offset, UINT size, BOOL ans
             RtlSetLastWin32Error( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if (offset < 0 && get_shared_window_long( hwnd, offset, &retval )) return retval;
+
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -1616,6 +1767,82 @@ static void mirror_rect( const RECT *window_rect, RECT *rect )
     rect->right = width - tmp;
 }
 
+/* DPI of the monitor of the top-level window, see get_monitor_dpi in the server */
+static UINT get_shared_monitor_dpi( HWND hwnd )
+{
+    struct shared_window_pos pos, parent_pos;
+
+    if (!get_shared_window_pos( hwnd, &pos )) return 0;
+    while (pos.parent)
+    {
+        if (!get_shared_window_pos( pos.parent, &parent_pos )) return 0;
+        if (!parent_pos.parent) break;
+        pos = parent_pos;
+    }
+    return pos.monitor_dpi;
+}
+
+/* get the rectangles of a window from session shared memory, same as the get_window_rectangles request */
+static BOOL get_shared_window_rects( HWND hwnd, enum coords_relative relative, struct window_rects *rects, UINT dpi )
+{
+    struct shared_window_pos pos, parent_pos;
+    UINT window_dpi, monitor_dpi;
+    HWND parent;
+
+    if (!get_shared_window_pos( hwnd, &pos )) return FALSE;
+
+    rects->window = pos.window;
+    rects->client = pos.client;
+
+    switch (relative)
+    {
+    case COORDS_CLIENT:
+        OffsetRect( &rects->window, -pos.client.left, -pos.client.top );
+        OffsetRect( &rects->client, -pos.client.left, -pos.client.top );
+        if (pos.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &pos.client, &rects->window );
+        break;
+    case COORDS_WINDOW:
+        OffsetRect( &rects->window, -pos.window.left, -pos.window.top );
+        OffsetRect( &rects->client, -pos.window.left, -pos.window.top );
+        if (pos.ex_style & WS_EX_LAYOUTRTL) mirror_rect( &pos.window, &rects->client );
+        break;
+    case COORDS_PARENT:
+        if (!pos.parent) break;
+        if (!get_shared_window_pos( pos.parent, &parent_pos )) return FALSE;
+        if (parent_pos.ex_style & WS_EX_LAYOUTRTL)
+        {
+            mirror_rect( &parent_pos.client, &rects->window );
+            mirror_rect( &parent_pos.client, &rects->client );
+        }
+        break;
+    case COORDS_SCREEN:
+        for (parent = pos.parent; parent; parent = parent_pos.parent)
+        {
+            if (!get_shared_window_pos( parent, &parent_pos )) return FALSE;
+            if (!parent_pos.parent) break;  /* desktop window */
+            OffsetRect( &rects->window, parent_pos.client.left, parent_pos.client.top );
+            OffsetRect( &rects->client, parent_pos.client.left, parent_pos.client.top );
+        }
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (NTUSER_DPI_CONTEXT_IS_MONITOR_AWARE( pos.dpi_context )) window_dpi = 0;
+    else window_dpi = NTUSER_DPI_CONTEXT_GET_DPI( pos.dpi_context );
+    if (!window_dpi || !dpi)
+    {
+        if (!(monitor_dpi = get_shared_monitor_dpi( hwnd ))) return FALSE;
+        if (!window_dpi) window_dpi = monitor_dpi;
+        if (!dpi) dpi = monitor_dpi;
+    }
+
+    rects->window = map_dpi_rect( rects->window, window_dpi, dpi );
+    rects->client = map_dpi_rect( rects->client, window_dpi, dpi );
+    rects->visible = rects->window;
+    return TRUE;
+}
+
 /***********************************************************************
  *           get_window_rects
  *
@@ -1736,6 +1963,8 @@ BOOL get_window_rects( HWND hwnd, enum coords_relative relative, struct window_r
     }
 
 other_process:
+    if (get_shared_window_rects( hwnd, relative, rects, dpi )) return TRUE;
+
     SERVER_START_REQ( get_window_rectangles )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -52,6 +52,17 @@ struct shared_input_cache
     DWORD tid;
 };
 
+struct shared_window_cache
+{
+    const shared_object_t *object;
+    UINT64 id;
+    HWND handle;
+    const shared_object_t *class_object;
+    UINT64 class_id;
+};
+
+#define SHARED_WINDOW_CACHE_SIZE 64
+
 struct session_thread_data
 {
     const shared_object_t *shared_desktop;         /* thread desktop shared session cached object */
@@ -59,6 +70,7 @@ struct session_thread_data
     struct shared_input_cache shared_input;        /* current thread input shared session cached object */
     struct shared_input_cache shared_foreground;   /* foreground thread input shared session cached object */
     struct shared_input_cache other_thread_input;  /* other thread input shared session cached object */
+    struct shared_window_cache shared_windows[SHARED_WINDOW_CACHE_SIZE]; /* window shared session cached objects */
 };
 
 struct session_block
@@ -328,6 +340,134 @@ NTSTATUS get_shared_input( UINT tid, struct object_lock *lock, const input_shm_t
     return status;
 }
 
+static struct shared_window_cache *get_shared_window_cache( HWND hwnd )
+{
+    struct session_thread_data *data = get_session_thread_data();
+    struct shared_window_cache *cache = &data->shared_windows[(LOWORD(hwnd) >> 1) % SHARED_WINDOW_CACHE_SIZE];
+
+    if (cache->handle == hwnd) return cache;
+    /* handles without a generation match any window with the same index */
+    if ((!HIWORD(hwnd) || HIWORD(hwnd) == 0xffff) && LOWORD(cache->handle) == LOWORD(hwnd)) return cache;
+    memset( cache, 0, sizeof(*cache) );
+    return cache;
+}
+
+static NTSTATUS try_get_shared_window( HWND hwnd, struct object_lock *lock, const window_shm_t **window_shm,
+                                       struct shared_window_cache *cache )
+{
+    const shared_object_t *object;
+    BOOL valid = TRUE;
+
+    if (!(object = cache->object))
+    {
+        struct obj_locator locator = {0};
+        HWND handle = 0;
+
+        SERVER_START_REQ( get_window_info )
+        {
+            req->handle = wine_server_user_handle( hwnd );
+            if (!wine_server_call( req ))
+            {
+                handle = wine_server_ptr_handle( reply->full_handle );
+                locator = reply->locator;
+            }
+        }
+        SERVER_END_REQ;
+
+        if (!(object = find_shared_session_object( locator ))) return STATUS_INVALID_HANDLE;
+        memset( cache, 0, sizeof(*cache) );
+        cache->object = object;
+        cache->id = locator.id;
+        cache->handle = handle;
+        memset( lock, 0, sizeof(*lock) );
+    }
+
+    /* check object validity by comparing ids, within the object seqlock */
+    valid = cache->id == object->id;
+
+    if (!lock->id || !shared_object_release_seqlock( object, lock->seq ))
+    {
+        shared_object_acquire_seqlock( object, &lock->seq );
+        if (!(lock->id = object->id)) lock->id = -1;
+        *window_shm = &object->shm.window;
+        return STATUS_PENDING;
+    }
+
+    if (!valid) memset( cache, 0, sizeof(*cache) ); /* window has been destroyed, clear the cache and start over */
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS get_shared_window( HWND hwnd, struct object_lock *lock, const window_shm_t **window_shm )
+{
+    struct shared_window_cache *cache = get_shared_window_cache( hwnd );
+    UINT status;
+
+    TRACE( "hwnd %p, lock %p, window_shm %p\n", hwnd, lock, window_shm );
+
+    do { status = try_get_shared_window( hwnd, lock, window_shm, cache ); }
+    while (!status && !cache->id);
+
+    return status;
+}
+
+static NTSTATUS try_get_shared_window_class( HWND hwnd, struct object_lock *lock, const class_shm_t **class_shm,
+                                             struct shared_window_cache *cache )
+{
+    const shared_object_t *object;
+    BOOL valid = TRUE;
+
+    if (!(object = cache->class_object))
+    {
+        struct object_lock window_lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        struct obj_locator locator = {0};
+        UINT status;
+
+        while ((status = get_shared_window( hwnd, &window_lock, &window_shm )) == STATUS_PENDING)
+        {
+            locator.id = window_shm->class_locator.id;
+            locator.offset = window_shm->class_locator.offset;
+        }
+        if (status) return status;
+
+        if (!(object = find_shared_session_object( locator ))) return STATUS_INVALID_HANDLE;
+        cache->class_object = object;
+        cache->class_id = locator.id;
+        memset( lock, 0, sizeof(*lock) );
+    }
+
+    /* check object validity by comparing ids, within the object seqlock */
+    valid = cache->class_id == object->id;
+
+    if (!lock->id || !shared_object_release_seqlock( object, lock->seq ))
+    {
+        shared_object_acquire_seqlock( object, &lock->seq );
+        if (!(lock->id = object->id)) lock->id = -1;
+        *class_shm = &object->shm.class;
+        return STATUS_PENDING;
+    }
+
+    if (!valid) /* class has been destroyed, clear the cache and start over */
+    {
+        cache->class_object = NULL;
+        cache->class_id = 0;
+    }
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS get_shared_window_class( HWND hwnd, struct object_lock *lock, const class_shm_t **class_shm )
+{
+    struct shared_window_cache *cache = get_shared_window_cache( hwnd );
+    UINT status;
+
+    TRACE( "hwnd %p, lock %p, class_shm %p\n", hwnd, lock, class_shm );
+
+    do { status = try_get_shared_window_class( hwnd, lock, class_shm, cache ); }
+    while (!status && !cache->class_id);
+
+    return status;
+}
+
 BOOL is_virtual_desktop(void)
 {
     struct object_lock lock = OBJECT_LOCK_INIT;
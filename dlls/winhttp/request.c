@@ -1670,6 +1670,7 @@ static DWORD open_connection( struct request *request )
 
         if ((ret = netconn_create( host, &connect->sockaddr, request->connect_timeout, &netconn )))
         {
+            request->stats[WinHttpConnectFailureCount]++;
             free( addressW );
             release_host( host );
             return ret;
@@ -1725,6 +1726,11 @@ static DWORD open_connection( struct request *request )
     }
 
 done:
+    /* a redirect or authentication retry may send again over the same connection */
+    request->stats_flags = 0;
+    request->stats_index = request->netconn->request_count++;
+    if (!request->stats_index) request->stats_flags |= WINHTTP_REQUEST_STAT_FLAG_FIRST_REQUEST;
+
     request->read_pos = request->read_size = 0;
     request->read_chunked = FALSE;
     request->read_chunked_size = ~0u;
@@ -2006,6 +2012,7 @@ static DWORD read_data( struct request *request, void *buffer, DWORD size, DWORD
         size -= count;
         bytes_read += count;
         request->content_read += count;
+        request->stats[WinHttpResponseBodySize] += count;
         if (end_of_read_data( request )) goto done;
     }
     if (request->read_chunked && !request->read_chunked_size) ret = refill_buffer( request, async );
@@ -2251,6 +2258,7 @@ static DWORD send_request( struct request *request, const WCHAR *headers, DWORD
     request->read_reply_status = ERROR_WINHTTP_INCORRECT_HANDLE_STATE;
     request->read_reply_len = 0;
     request->state = REQUEST_RESPONSE_STATE_NONE;
+    memset( request->stats, 0, sizeof(request->stats) );
 
     if (request->flags & REQUEST_FLAG_WEBSOCKET_UPGRADE
         && request->websocket_set_send_buffer_size < MIN_WEBSOCKET_SEND_BUFFER_SIZE)
@@ -2327,6 +2335,7 @@ static DWORD send_request( struct request *request, const WCHAR *headers, DWORD
     ret = netconn_send( request->netconn, wire_req, len, &bytes_sent, NULL );
     free( wire_req );
     if (ret) goto end;
+    request->stats[WinHttpRequestHeadersSize] = len;
 
     if (optional_len)
     {
@@ -2732,6 +2741,7 @@ static DWORD read_reply( struct request *request )
         free_header( header );
     }
 
+    request->stats[WinHttpResponseHeadersSize] = offset + crlf_len;
     TRACE("raw headers: %s\n", debugstr_w(raw_headers));
     return ret;
 }
@@ -924,11 +924,31 @@ static BOOL request_query_option( struct object_header *hdr, DWORD option, void
     case WINHTTP_OPTION_HTTP_PROTOCOL_USED:
         if (!validate_buffer( buffer, buflen, sizeof(DWORD) )) return FALSE;
 
-        FIXME("WINHTTP_OPTION_HTTP_PROTOCOL_USED\n");
+        /* we never negotiate anything beyond HTTP/1.1 */
         *(DWORD *)buffer = 0;
         *buflen = sizeof(DWORD);
         return TRUE;
 
+    case WINHTTP_OPTION_REQUEST_STATS:
+    {
+        WINHTTP_REQUEST_STATS *stats = buffer;
+
+        if (!validate_buffer( buffer, buflen, sizeof(*stats) )) return FALSE;
+
+        if (request->state < REQUEST_RESPONSE_STATE_REQUEST_SENT)
+        {
+            SetLastError( ERROR_WINHTTP_INCORRECT_HANDLE_STATE );
+            return FALSE;
+        }
+        memset( stats, 0, sizeof(*stats) );
+        stats->ullFlags = request->stats_flags;
+        stats->ulIndex  = request->stats_index;
+        stats->cStats   = WinHttpRequestStatLast;
+        memcpy( stats->rgullStats, request->stats, sizeof(request->stats) );
+        *buflen = sizeof(*stats);
+        return TRUE;
+    }
+
     case WINHTTP_OPTION_WEB_SOCKET_RECEIVE_BUFFER_SIZE:
         if (!validate_buffer( buffer, buflen, sizeof(DWORD) )) return FALSE;
 
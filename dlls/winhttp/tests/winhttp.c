@@ -2240,6 +2240,14 @@ static const char noauthmsg[] =
 "Content-Type: text/plain\r\n"
 "\r\n";
 
+static const char noauthmsg_keepalive[] =
+"HTTP/1.1 401 Unauthorized\r\n"
+"Server: winetest\r\n"
+"WWW-Authenticate: Basic realm=\"placebo\"\r\n"
+"Content-Length: 12\r\n"
+"Content-Type: text/plain\r\n"
+"\r\n";
+
 static const char okauthmsg[] =
 "HTTP/1.1 200 OK\r\n"
 "Server: winetest\r\n"
@@ -2402,6 +2410,18 @@ static DWORD CALLBACK server_thread(LPVOID param)
             send(c, okmsg, sizeof okmsg - 1, 0);
             send(c, page1, sizeof page1 - 1, 0);
         }
+        if (strstr(buffer, "GET /keepalive_auth"))
+        {
+            send(c, noauthmsg_keepalive, sizeof noauthmsg_keepalive - 1, 0);
+            send(c, unauthorized, sizeof unauthorized - 1, 0);
+            r = server_receive_request(c, buffer, sizeof(buffer));
+            ok(r > 0, "got %d.\n", r);
+            ok(!!strstr(buffer, "Authorization: Basic dXNlcjpwd2Q="), "authorization not found.\n");
+            send(c, okauthmsg, sizeof okauthmsg - 1, 0);
+            send(c, hello_world, sizeof hello_world - 1, 0);
+            r = server_receive_request(c, buffer, sizeof(buffer));
+            ok(!r, "got %d, buffer[0] %d.\n", r, buffer[0]);
+        }
         if (strstr(buffer, "/auth_with_creds"))
         {
             send(c, okauthmsg, sizeof okauthmsg - 1, 0);
@@ -6203,11 +6223,32 @@ done:
     WinHttpCloseHandle( ses );
 }
 
+static BOOL get_request_stats(HINTERNET req, WINHTTP_REQUEST_STATS *stats)
+{
+    DWORD size = sizeof(*stats);
+    BOOL ret;
+
+    memset(stats, 0xcc, sizeof(*stats));
+    SetLastError(0xdeadbeef);
+    ret = WinHttpQueryOption(req, WINHTTP_OPTION_REQUEST_STATS, stats, &size);
+    if (!ret)
+    {
+        ok(GetLastError() == ERROR_INVALID_PARAMETER || GetLastError() == ERROR_WINHTTP_INVALID_OPTION,
+           "got %lu\n", GetLastError());
+        return FALSE;
+    }
+    ok(size == sizeof(*stats), "got size %lu\n", size);
+    ok(stats->cStats >= WinHttpResponseBodySize, "got %lu stats\n", stats->cStats);
+    return TRUE;
+}
+
 static void test_connection_cache(int port)
 {
+    WINHTTP_REQUEST_STATS stats;
     HINTERNET ses, con, req;
     DWORD status, size;
     char buffer[256];
+    ULONG index = 0;
     BOOL ret;
 
     ses = WinHttpOpen(L"winetest", WINHTTP_ACCESS_TYPE_NO_PROXY, NULL, NULL, 0);
@@ -6229,10 +6270,24 @@ static void test_connection_cache(int port)
     ret = WinHttpReadData(req, buffer, sizeof buffer, &size);
     ok(ret, "failed to read data %lu\n", GetLastError());
     ok(!size, "got size %lu.\n", size);
+    if (get_request_stats(req, &stats))
+    {
+        ok(stats.ullFlags & WINHTTP_REQUEST_STAT_FLAG_FIRST_REQUEST, "got flags %#I64x\n", stats.ullFlags);
+        ok(stats.rgullStats[WinHttpRequestHeadersSize] > 0, "got request headers size %I64u\n",
+           stats.rgullStats[WinHttpRequestHeadersSize]);
+        ok(stats.rgullStats[WinHttpResponseHeadersSize] > 0, "got response headers size %I64u\n",
+           stats.rgullStats[WinHttpResponseHeadersSize]);
+        ok(!stats.rgullStats[WinHttpResponseBodySize], "got response body size %I64u\n",
+           stats.rgullStats[WinHttpResponseBodySize]);
+        index = stats.ulIndex;
+    }
     WinHttpCloseHandle(req);
 
     req = WinHttpOpenRequest(con, L"GET", L"/cached", NULL, NULL, NULL, 0);
     ok(req != NULL, "failed to open a request %lu\n", GetLastError());
+    size = sizeof(stats);
+    ret = WinHttpQueryOption(req, WINHTTP_OPTION_REQUEST_STATS, &stats, &size);
+    ok(!ret, "unexpected success\n");
     ret = WinHttpSendRequest(req, L"Connection: close", ~0u, NULL, 0, 0, 0);
     ok(ret, "failed to send request %lu\n", GetLastError());
     ret = WinHttpReceiveResponse(req, NULL);
@@ -6244,6 +6299,11 @@ static void test_connection_cache(int port)
     ret = WinHttpReadData(req, buffer, sizeof buffer, &size);
     ok(ret, "failed to read data %lu\n", GetLastError());
     ok(!size, "got size %lu.\n", size);
+    if (get_request_stats(req, &stats))
+    {
+        ok(!(stats.ullFlags & WINHTTP_REQUEST_STAT_FLAG_FIRST_REQUEST), "got flags %#I64x\n", stats.ullFlags);
+        ok(stats.ulIndex == index + 1, "got index %lu, expected %lu\n", stats.ulIndex, index + 1);
+    }
     WinHttpCloseHandle(req);
 
     req = WinHttpOpenRequest(con, L"GET", L"/notcached", NULL, NULL, NULL, 0);
@@ -6256,6 +6316,33 @@ static void test_connection_cache(int port)
     ret = WinHttpQueryHeaders(req, WINHTTP_QUERY_STATUS_CODE|WINHTTP_QUERY_FLAG_NUMBER, NULL, &status, &size, NULL);
     ok(ret, "failed to query status code %lu\n", GetLastError());
     ok(status == HTTP_STATUS_OK, "request failed unexpectedly %lu\n", status);
+    if (get_request_stats(req, &stats))
+        ok(stats.ullFlags & WINHTTP_REQUEST_STAT_FLAG_FIRST_REQUEST, "got flags %#I64x\n", stats.ullFlags);
+    WinHttpCloseHandle(req);
+
+    /* the authentication retry is sent over the same connection */
+    req = WinHttpOpenRequest(con, L"GET", L"/keepalive_auth", NULL, NULL, NULL, 0);
+    ok(req != NULL, "failed to open a request %lu\n", GetLastError());
+    ret = WinHttpSetOption(req, WINHTTP_OPTION_USERNAME, (void *)L"user", lstrlenW(L"user"));
+    ok(ret, "failed to set username %lu\n", GetLastError());
+    ret = WinHttpSetOption(req, WINHTTP_OPTION_PASSWORD, (void *)L"pwd", lstrlenW(L"pwd"));
+    ok(ret, "failed to set password %lu\n", GetLastError());
+    ret = WinHttpSendRequest(req, NULL, 0, NULL, 0, 0, 0);
+    ok(ret, "failed to send request %lu\n", GetLastError());
+    ret = WinHttpReceiveResponse(req, NULL);
+    ok(ret, "failed to receive response %lu\n", GetLastError());
+    size = sizeof(status);
+    ret = WinHttpQueryHeaders(req, WINHTTP_QUERY_STATUS_CODE|WINHTTP_QUERY_FLAG_NUMBER, NULL, &status, &size, NULL);
+    ok(ret, "failed to query status code %lu\n", GetLastError());
+    ok(status == HTTP_STATUS_OK, "request failed unexpectedly %lu\n", status);
+    if (get_request_stats(req, &stats))
+    {
+        ok(!(stats.ullFlags & WINHTTP_REQUEST_STAT_FLAG_FIRST_REQUEST), "got flags %#I64x\n", stats.ullFlags);
+        ok(stats.ulIndex == 1, "got index %lu\n", stats.ulIndex);
+    }
+    ret = WinHttpReadData(req, buffer, sizeof buffer, &size);
+    ok(ret, "failed to read data %lu\n", GetLastError());
+    ok(size == 11, "got size %lu.\n", size);
     WinHttpCloseHandle(req);
 
     WinHttpCloseHandle(con);
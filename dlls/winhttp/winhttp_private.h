@@ -112,6 +112,7 @@ struct netconn
     BOOL secure; /* SSL active on connection? */
     struct hostdata *host;
     ULONGLONG keep_until;
+    ULONG request_count; /* number of requests sent over this connection */
     CtxtHandle ssl_ctx;
     SecPkgContext_StreamSizes ssl_sizes;
     char *ssl_read_buf, *ssl_write_buf;
@@ -236,6 +237,9 @@ struct request
     int read_reply_len;
     DWORD read_reply_status;
     enum request_response_state state;
+    ULONGLONG stats_flags;    /* WINHTTP_REQUEST_STAT_FLAG_* */
+    ULONG stats_index;        /* number of prior requests on the connection */
+    ULONGLONG stats[WinHttpRequestStatLast];
 };
 
 enum socket_state
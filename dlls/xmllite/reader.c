@@ -1088,10 +1088,10 @@ static HRESULT reader_more(xmlreader *reader)
     }
     else
     {
-        dest_len = MultiByteToWideChar(cp, 0, src->data + src->cur, len, NULL, 0);
-        readerinput_grow(readerinput, dest_len);
+        /* converted data never takes more characters than there are input bytes */
+        readerinput_grow(readerinput, len);
         ptr = (WCHAR*)(dest->data + dest->written);
-        MultiByteToWideChar(cp, 0, src->data + src->cur, len, ptr, dest_len);
+        dest_len = MultiByteToWideChar(cp, 0, src->data + src->cur, len, ptr, len);
         ptr[dest_len] = 0;
         dest->written += dest_len*sizeof(WCHAR);
         /* get rid of processed data */
@@ -1159,15 +1159,24 @@ static void reader_skipn(xmlreader *reader, int n)
     }
 }
 
+/* moves cursor over n already examined WCHARs, that must not contain line breaks */
+static inline void reader_skip_chars(xmlreader *reader, UINT n)
+{
+    reader->input->buffer->utf16.cur += n;
+    reader->position.line_position += n;
+}
+
 /* [3] S ::= (#x20 | #x9 | #xD | #xA)+ */
 static int reader_skipspaces(xmlreader *reader)
 {
-    const WCHAR *ptr = reader_get_ptr(reader);
+    const WCHAR *ptr = reader_get_ptr(reader), *end;
     UINT start = reader_get_cur(reader);
 
     while (is_wchar_space(*ptr))
     {
-        reader_skipn(reader, 1);
+        for (end = ptr; is_wchar_space(*end); end++)
+            reader_update_position(reader, *end);
+        reader->input->buffer->utf16.cur += end - ptr;
         ptr = reader_get_ptr(reader);
     }
 
@@ -1561,7 +1570,9 @@ static HRESULT reader_parse_name(xmlreader *reader, strval *name)
 
     while (is_namechar(*ptr))
     {
-        reader_skipn(reader, 1);
+        const WCHAR *end = ptr;
+        while (is_namechar(*end)) end++;
+        reader_skip_chars(reader, end - ptr);
         ptr = reader_get_ptr(reader);
     }
 
@@ -1918,7 +1929,9 @@ static HRESULT reader_parse_local(xmlreader *reader, strval *local, BOOL check_f
 
     while (is_ncnamechar(*ptr))
     {
-        reader_skipn(reader, 1);
+        const WCHAR *end = ptr;
+        while (is_ncnamechar(*end)) end++;
+        reader_skip_chars(reader, end - ptr);
         ptr = reader_get_ptr(reader);
     }
 
@@ -1975,7 +1988,9 @@ static HRESULT reader_parse_qname(xmlreader *reader, strval *prefix, strval *loc
         /* skip prefix part */
         while (is_ncnamechar(*ptr))
         {
-            reader_skipn(reader, 1);
+            const WCHAR *end = ptr;
+            while (is_ncnamechar(*end)) end++;
+            reader_skip_chars(reader, end - ptr);
             ptr = reader_get_ptr(reader);
         }
 
@@ -2186,9 +2201,12 @@ static HRESULT reader_parse_attvalue(xmlreader *reader, strval *value)
         }
         else
         {
+            WCHAR *end = ptr;
+
             /* replace all whitespace chars with ' ' */
-            if (is_wchar_space(*ptr)) *ptr = ' ';
-            reader_skipn(reader, 1);
+            for (; *end && *end != quote && *end != '<' && *end != '&'; end++)
+                if (is_wchar_space(*end)) *end = ' ';
+            reader_skip_chars(reader, end - ptr);
         }
         ptr = reader_get_ptr(reader);
     }
@@ -2464,8 +2482,20 @@ static HRESULT reader_parse_chardata(xmlreader *reader)
 
         if (!reader_cmp(reader, L"&"))
             reader_parse_reference(reader);
-        else
+        else if (*ptr == '\n')
             reader_skipn(reader, 1);
+        else
+        {
+            const WCHAR *end = ptr + 1;
+
+            /* skip plain text up to the next character that needs attention */
+            while (*end && *end != '<' && *end != '&' && *end != ']' && *end != '\n')
+            {
+                if (!is_wchar_space(*end)) reader->nodetype = XmlNodeType_Text;
+                end++;
+            }
+            reader_skip_chars(reader, end - ptr);
+        }
 
         ptr = reader_get_ptr(reader);
     }
@@ -991,11 +991,49 @@ typedef volatile struct
     int                  keystate_lock;
 } input_shm_t;
 
+struct obj_locator
+{
+    object_id_t          id;
+    mem_size_t           offset;
+};
+
+typedef volatile struct
+{
+    struct obj_locator   class_locator;
+    lparam_t             id;
+    lparam_t             user_data;
+    mod_handle_t         instance;
+    user_handle_t        handle;
+    user_handle_t        parent;
+    user_handle_t        owner;
+    process_id_t         pid;
+    thread_id_t          tid;
+    unsigned int         style;
+    unsigned int         ex_style;
+    int                  is_unicode;
+    unsigned int         dpi_context;
+    unsigned int         monitor_dpi;
+    struct rectangle     window_rect;
+    struct rectangle     client_rect;
+} window_shm_t;
+
+typedef volatile struct
+{
+    mod_handle_t         instance;
+    atom_t               atom;
+    atom_t               base_atom;
+    unsigned int         style;
+    int                  win_extra;
+    int                  cls_extra;
+} class_shm_t;
+
 typedef volatile union
 {
     desktop_shm_t        desktop;
     queue_shm_t          queue;
     input_shm_t          input;
+    window_shm_t         window;
+    class_shm_t          class;
 } object_shm_t;
 
 typedef volatile struct
@@ -1005,12 +1043,6 @@ typedef volatile struct
     object_shm_t         shm;
 } shared_object_t;
 
-struct obj_locator
-{
-    object_id_t          id;
-    mem_size_t           offset;
-};
-
 
 
 
@@ -3464,6 +3496,7 @@ struct get_window_info_reply
     int            is_unicode;
     unsigned int   dpi_context;
     char __pad_36[4];
+    struct obj_locator locator;
 };
 
 
@@ -6794,6 +6827,6 @@ union generic_reply
     struct set_keyboard_repeat_reply set_keyboard_repeat_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 856
+#define SERVER_PROTOCOL_VERSION 857
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
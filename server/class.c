@@ -33,6 +33,7 @@
 
 #include "request.h"
 #include "object.h"
+#include "file.h"
 #include "process.h"
 #include "user.h"
 #include "winuser.h"
@@ -50,6 +51,7 @@ struct window_class
     unsigned int    style;           /* class style */
     int             win_extra;       /* number of window extra bytes */
     client_ptr_t    client_ptr;      /* pointer to class in client address space */
+    const class_shm_t *shared;       /* class in session shared memory */
     int             nb_extra_bytes;  /* number of extra bytes */
     char            extra_bytes[1];  /* extra bytes storage */
 };
@@ -59,6 +61,11 @@ static struct window_class *create_class( struct process *process, int extra_byt
     struct window_class *class;
 
     if (!(class = mem_alloc( sizeof(*class) + extra_bytes - 1 ))) return NULL;
+    if (!(class->shared = alloc_shared_object()))
+    {
+        free( class );
+        return NULL;
+    }
 
     class->process = (struct process *)grab_object( process );
     class->count = 0;
@@ -79,9 +86,25 @@ static void destroy_class( struct window_class *class )
     release_global_atom( NULL, class->base_atom );
     list_remove( &class->entry );
     release_object( class->process );
+    free_shared_object( class->shared );
     free( class );
 }
 
+/* update the class information in session shared memory */
+static void update_class_shm( struct window_class *class )
+{
+    SHARED_WRITE_BEGIN( class->shared, class_shm_t )
+    {
+        shared->instance  = class->instance;
+        shared->atom      = class->atom;
+        shared->base_atom = class->base_atom;
+        shared->style     = class->style;
+        shared->win_extra = class->win_extra;
+        shared->cls_extra = class->nb_extra_bytes;
+    }
+    SHARED_WRITE_END;
+}
+
 void destroy_process_classes( struct process *process )
 {
     struct list *ptr;
@@ -156,6 +179,11 @@ client_ptr_t get_class_client_ptr( struct window_class *class )
     return class->client_ptr;
 }
 
+struct obj_locator get_class_locator( struct window_class *class )
+{
+    return get_shared_object_locator( class->shared );
+}
+
 /* create a window class */
 DECL_HANDLER(create_class)
 {
@@ -221,6 +249,7 @@ DECL_HANDLER(create_class)
     class->style      = req->style;
     class->win_extra  = req->win_extra;
     class->client_ptr = req->client_ptr;
+    update_class_shm( class );
     reply->atom = atom;
 }
 
@@ -298,4 +327,6 @@ DECL_HANDLER(set_class_info)
     if (req->flags & SET_CLASS_INSTANCE) class->instance = req->instance;
     if (req->flags & SET_CLASS_EXTRA) memcpy( class->extra_bytes + req->extra_offset,
                                               &req->extra_value, req->extra_size );
+    if (req->flags & (SET_CLASS_ATOM | SET_CLASS_STYLE | SET_CLASS_WINEXTRA | SET_CLASS_INSTANCE))
+        update_class_shm( class );
 }
@@ -1470,7 +1470,8 @@ C_ASSERT( offsetof(struct get_window_info_reply, tid) == 20 );
 C_ASSERT( offsetof(struct get_window_info_reply, atom) == 24 );
 C_ASSERT( offsetof(struct get_window_info_reply, is_unicode) == 28 );
 C_ASSERT( offsetof(struct get_window_info_reply, dpi_context) == 32 );
-C_ASSERT( sizeof(struct get_window_info_reply) == 40 );
+C_ASSERT( offsetof(struct get_window_info_reply, locator) == 40 );
+C_ASSERT( sizeof(struct get_window_info_reply) == 56 );
 C_ASSERT( offsetof(struct set_window_info_request, flags) == 12 );
 C_ASSERT( offsetof(struct set_window_info_request, is_unicode) == 14 );
 C_ASSERT( offsetof(struct set_window_info_request, handle) == 16 );
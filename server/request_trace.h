@@ -1712,6 +1712,7 @@ static void dump_get_window_info_reply( const struct get_window_info_reply *req
     fprintf( stderr, ", atom=%04x", req->atom );
     fprintf( stderr, ", is_unicode=%d", req->is_unicode );
     fprintf( stderr, ", dpi_context=%08x", req->dpi_context );
+    dump_obj_locator( ", locator=", &req->locator );
 }
 
 static void dump_set_window_info_request( const struct set_window_info_request *req )
@@ -204,6 +204,7 @@ extern int is_desktop_class( struct window_class *class );
 extern int is_hwnd_message_class( struct window_class *class );
 extern int get_class_style( struct window_class *class );
 extern atom_t get_class_atom( struct window_class *class );
+extern struct obj_locator get_class_locator( struct window_class *class );
 extern client_ptr_t get_class_client_ptr( struct window_class *class );
 
 /* windows station functions */
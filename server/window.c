@@ -30,6 +30,7 @@
 #include "ntuser.h"
 
 #include "object.h"
+#include "file.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -64,6 +65,7 @@ struct window
     struct thread   *thread;          /* thread owning the window */
     struct desktop  *desktop;         /* desktop that the window belongs to */
     struct window_class *class;       /* window class */
+    const window_shm_t *shared;       /* window in session shared memory */
     atom_t           atom;            /* class atom */
     user_handle_t    last_active;     /* last active popup */
     struct rectangle window_rect;     /* window rectangle (relative to parent client area) */
@@ -337,6 +339,35 @@ static unsigned int get_window_dpi( struct window *win )
     return NTUSER_DPI_CONTEXT_GET_DPI( win->dpi_context );
 }
 
+/* update the window information in session shared memory */
+static void update_window_shm( struct window *win )
+{
+    static const struct obj_locator no_class;
+
+    if (!win->shared) return;
+
+    SHARED_WRITE_BEGIN( win->shared, window_shm_t )
+    {
+        shared->class_locator = win->class ? get_class_locator( win->class ) : no_class;
+        shared->id            = win->id;
+        shared->user_data     = win->user_data;
+        shared->instance      = win->instance;
+        shared->handle        = win->handle;
+        shared->parent        = win->parent ? win->parent->handle : 0;
+        shared->owner         = win->owner;
+        shared->pid           = win->thread ? get_process_id( win->thread->process ) : 0;
+        shared->tid           = win->thread ? get_thread_id( win->thread ) : 0;
+        shared->style         = win->style;
+        shared->ex_style      = win->ex_style;
+        shared->is_unicode    = win->is_unicode;
+        shared->dpi_context   = win->dpi_context;
+        shared->monitor_dpi   = win->monitor_dpi;
+        shared->window_rect   = win->window_rect;
+        shared->client_rect   = win->client_rect;
+    }
+    SHARED_WRITE_END;
+}
+
 /* link a window at the right place in the siblings list */
 static int link_window( struct window *win, struct window *previous )
 {
@@ -434,6 +465,7 @@ static int set_parent_window( struct window *win, struct window *parent )
         win->is_linked = 0;
         win->is_orphan = 1;
     }
+    update_window_shm( win );
     return 1;
 }
 
@@ -572,6 +604,7 @@ static void detach_window_thread( struct window *win )
     /* destroyed when the desktop ref count reaches zero */
     release_object( win->desktop );
     win->thread = NULL;
+    update_window_shm( win );
 }
 
 /* get the process owning the top window of a given desktop */
@@ -640,6 +673,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     win->thread         = current;
     win->desktop        = desktop;
     win->class          = class;
+    win->shared         = NULL;
     win->atom           = atom;
     win->win_region     = NULL;
     win->update_region  = NULL;
@@ -674,6 +708,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
     if (!(win->handle = alloc_user_handle( win, USER_WINDOW ))) goto failed;
     win->last_active = win->handle;
+    if (!(win->shared = alloc_shared_object())) goto failed;
 
     /* if parent belongs to a different thread and the window isn't */
     /* top-level, attach the two threads */
@@ -710,6 +745,7 @@ static struct window *create_window( struct window *parent, struct window *owner
 failed:
     if (win)
     {
+        if (win->shared) free_shared_object( win->shared );
         if (win->handle)
         {
             free_user_handle( win->handle );
@@ -1936,6 +1972,7 @@ static void set_window_pos( struct window *win, struct window *previous,
             offset_rect( &child->visible_rect, new_size - old_size, 0 );
             offset_rect( &child->surface_rect, new_size - old_size, 0 );
             offset_rect( &child->client_rect, new_size - old_size, 0 );
+            update_window_shm( child );
         }
     }
 
@@ -2153,6 +2190,8 @@ void free_window_handle( struct window *win )
     detach_window_thread( win );
 
     if (win->parent) set_parent_window( win, NULL );
+    free_shared_object( win->shared );
+    win->shared = NULL;
     free_user_handle( win->handle );
     win->handle = 0;
     release_object( win );
@@ -2203,6 +2242,7 @@ DECL_HANDLER(create_window)
 
     win->style = req->style;
     win->ex_style = req->ex_style;
+    update_window_shm( win );
 
     reply->handle      = win->handle;
     reply->parent      = win->parent ? win->parent->handle : 0;
@@ -2264,6 +2304,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->top_window );
         }
     }
 
@@ -2276,6 +2317,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_window_shm( desktop->msg_window );
         }
     }
 
@@ -2311,6 +2353,7 @@ DECL_HANDLER(set_window_owner)
 
     reply->prev_owner = win->owner;
     reply->full_owner = win->owner = owner ? owner->handle : 0;
+    update_window_shm( win );
 }
 
 
@@ -2325,6 +2368,7 @@ DECL_HANDLER(get_window_info)
     reply->last_active = win->handle;
     reply->is_unicode  = win->is_unicode;
     reply->dpi_context = win->dpi_context;
+    reply->locator     = get_shared_object_locator( win->shared );
 
     if (get_user_object( win->last_active, USER_WINDOW )) reply->last_active = win->last_active;
     if (win->thread)
@@ -2382,6 +2426,7 @@ DECL_HANDLER(set_window_info)
     if (req->flags & SET_WIN_USERDATA) win->user_data = req->user_data;
     if (req->flags & SET_WIN_EXTRA) memcpy( win->extra_bytes + req->extra_offset,
                                             &req->extra_value, req->extra_size );
+    if (req->flags & ~SET_WIN_EXTRA) update_window_shm( win );
 
     /* changing window style triggers a non-client paint */
     if (req->flags & SET_WIN_STYLE) win->paint_flags |= PAINT_NONCLIENT;
@@ -2637,6 +2682,7 @@ DECL_HANDLER(set_window_pos)
     old_client = win->client_rect;
     set_window_pos( win, previous, flags, &window_rect, &client_rect,
                     &visible_rect, &surface_rect, &valid_rect );
+    update_window_shm( win );
     if ((win->style & old_style & WS_VISIBLE) && (memcmp( &old_client, &win->client_rect, sizeof(old_client) )
         || memcmp( &old_window, &win->window_rect, sizeof(old_window) )))
         update_cursor_pos( win->desktop );
@@ -118,11 +118,36 @@ static const struct
     { FLAG_IDL_REGISTER,   "_r.res" },
 };
 
-#define HASH_SIZE 197
+#define HASH_SIZE 4093
+#define MAKE_HASH_SIZE 64
 
 static struct list files[HASH_SIZE];
 static struct list global_includes[HASH_SIZE];
 
+/* parsed dependencies are cached across runs, keyed by file name, size and modification time */
+struct cached_file
+{
+    struct list        entry;
+    char              *name;
+    long long          mtime;
+    long long          size;
+    unsigned int       flags;
+    unsigned int       deps_count;
+    unsigned int       deps_size;
+    struct dependency *deps;
+    int                used;          /* entry is still valid and should be saved */
+};
+
+static const char cache_file_name[] = ".makedep.cache";
+static const char *cache_signature;
+static struct list cached_files[HASH_SIZE];
+static unsigned int cache_entries;
+static unsigned int cache_hits;
+static unsigned int cache_misses;
+static unsigned int files_parsed;
+static clock_t parse_time;
+static time_t start_time;
+
 enum install_rules { INSTALL_LIB, INSTALL_DEV, INSTALL_TEST, NB_INSTALL_RULES };
 static const char *install_targets[NB_INSTALL_RULES] = { "install-lib", "install-dev", "install-test" };
 static const char *install_variables[NB_INSTALL_RULES] = { "INSTALL_LIB", "INSTALL_DEV", "INSTALL_TEST" };
@@ -196,6 +221,8 @@ struct makefile
     struct strarray extra_imports;
     struct list     sources;
     struct list     includes;
+    struct list     sources_hash[MAKE_HASH_SIZE];
+    struct list     includes_hash[MAKE_HASH_SIZE];
     const char     *src_dir;
     const char     *obj_dir;
     const char     *parent_dir;
@@ -245,6 +272,7 @@ static const char *temp_file_name;
 static char cwd[PATH_MAX];
 static int compile_commands_mode;
 static int silent_rules;
+static int timing_mode;
 static int input_line;
 static int output_column;
 static FILE *output_file;
@@ -265,6 +293,7 @@ static const char Usage[] =
     "Options:\n"
     "   -C          Generate compile_commands.json along with the makefile\n"
     "   -S          Generate Automake-style silent rules\n"
+    "   -t          Report the time spent in each phase\n"
     "   -fxxx       Store output in file 'xxx' (default: Makefile)\n";
 
 
@@ -410,7 +439,8 @@ static void output_filename( const char *name )
         output( "  " );
     }
     else if (output_column) output( " " );
-    output( "%s", name );
+    if (fputs( name, output_file ) < 0) fatal_perror( "output" );
+    output_column += strlen( name );
 }
 
 
@@ -785,6 +815,88 @@ static char *get_line( FILE *file )
 }
 
 
+/*******************************************************************
+ *         get_file_data
+ *
+ * Read the remaining contents of a file into a null-terminated buffer.
+ */
+static char *get_file_data( FILE *file, size_t *size )
+{
+    size_t len = 0, alloc = 65536, ret;
+    char *data = xmalloc( alloc );
+
+    while ((ret = fread( data + len, 1, alloc - len - 1, file )))
+    {
+        len += ret;
+        if (len == alloc - 1) data = xrealloc( data, alloc *= 2 );
+    }
+    data[len] = 0;
+    *size = len;
+    return data;
+}
+
+
+/*******************************************************************
+ *         get_data_line
+ *
+ * Return the next line of a file buffer, with continuation lines joined in place.
+ */
+static char *get_data_line( char **pos, char *end )
+{
+    char *line = *pos, *out = *pos, *p = *pos, *eol, *next;
+
+    for (;;)
+    {
+        input_line++;
+        if (!(eol = memchr( p, '\n', end - p ))) eol = end;
+        next = (eol < end) ? eol + 1 : end;
+        if (eol < end && eol > p && eol[-1] == '\r') eol--;
+        if (next > eol && eol > p && eol[-1] == '\\')
+        {
+            /* line ends in backslash, append continuation line */
+            memmove( out, p, eol - 1 - p );
+            out += eol - 1 - p;
+            p = next;
+            if (p == end) break;
+            continue;
+        }
+        memmove( out, p, eol - p );
+        out += eol - p;
+        p = next;
+        break;
+    }
+    *out = 0;
+    *pos = p;
+    return line;
+}
+
+
+/*******************************************************************
+ *         skip_data_line
+ *
+ * Skip the next line of a file buffer, including continuation lines.
+ */
+static void skip_data_line( char **pos, char *end )
+{
+    char *p = *pos, *line, *eol;
+
+    for (;;)
+    {
+        input_line++;
+        line = p;
+        if (!(eol = memchr( line, '\n', end - line )))
+        {
+            *pos = end;
+            return;
+        }
+        p = eol + 1;
+        if (eol > line && eol[-1] == '\r') eol--;
+        if (p == end || eol == line || eol[-1] != '\\') break;
+    }
+    *pos = p;
+}
+
+
 /*******************************************************************
  *         hash_filename
  */
@@ -833,21 +945,37 @@ static void add_dependency( struct file *file, const char *name, enum incl_type
 static struct incl_file *find_src_file( const struct makefile *make, const char *name )
 {
     struct incl_file *file;
+    unsigned int hash = hash_filename( name );
 
     if (make == include_makefile)
     {
-        unsigned int hash = hash_filename( name );
-
         LIST_FOR_EACH_ENTRY( file, &global_includes[hash], struct incl_file, hash_entry )
             if (!strcmp( name, file->name )) return file;
         return NULL;
     }
 
-    LIST_FOR_EACH_ENTRY( file, &make->sources, struct incl_file, entry )
+    LIST_FOR_EACH_ENTRY( file, &make->sources_hash[hash % MAKE_HASH_SIZE], struct incl_file, hash_entry )
         if (!strcmp( name, file->name )) return file;
     return NULL;
 }
 
+/*******************************************************************
+ *         add_source_to_list
+ *
+ * Add a file to the list of sources of a makefile.
+ */
+static void add_source_to_list( struct makefile *make, struct incl_file *file )
+{
+    unsigned int hash = hash_filename( file->name );
+
+    list_add_tail( &make->sources, &file->entry );
+    if (make == include_makefile)
+        list_add_tail( &global_includes[hash], &file->hash_entry );
+    else
+        list_add_tail( &make->sources_hash[hash % MAKE_HASH_SIZE], &file->hash_entry );
+}
+
+
 /*******************************************************************
  *         find_include_file
  */
@@ -878,6 +1006,7 @@ static struct incl_file *add_include( struct makefile *make, struct incl_file *p
                                       const char *name, int line, enum incl_type type )
 {
     struct incl_file *include;
+    unsigned int hash = hash_filename( name ) % MAKE_HASH_SIZE;
 
     if (parent->files_count >= parent->files_size)
     {
@@ -886,7 +1015,7 @@ static struct incl_file *add_include( struct makefile *make, struct incl_file *p
         parent->files = xrealloc( parent->files, parent->files_size * sizeof(*parent->files) );
     }
 
-    LIST_FOR_EACH_ENTRY( include, &make->includes, struct incl_file, entry )
+    LIST_FOR_EACH_ENTRY( include, &make->includes_hash[hash], struct incl_file, hash_entry )
         if (!parent->use_msvcrt == !include->use_msvcrt && !strcmp( name, include->name ))
             goto found;
 
@@ -898,6 +1027,7 @@ static struct incl_file *add_include( struct makefile *make, struct incl_file *p
     include->type = type;
     include->use_msvcrt = parent->use_msvcrt;
     list_add_tail( &make->includes, &include->entry );
+    list_add_tail( &make->includes_hash[hash], &include->hash_entry );
 found:
     parent->files[parent->files_count++] = include;
     return include;
@@ -923,12 +1053,7 @@ static struct incl_file *add_generated_source( struct makefile *make, const char
     file->filename = obj_dir_path( make, file->basename );
     file->file->flags = FLAG_GENERATED;
     file->use_msvcrt = is_using_msvcrt( make );
-    list_add_tail( &make->sources, &file->entry );
-    if (make == include_makefile)
-    {
-        unsigned int hash = hash_filename( name );
-        list_add_tail( &global_includes[hash], &file->hash_entry );
-    }
+    add_source_to_list( make, file );
     return file;
 }
 
@@ -1122,13 +1247,17 @@ static void parse_idl_file( struct file *source, FILE *file )
  */
 static void parse_c_file( struct file *source, FILE *file )
 {
-    char *buffer;
+    size_t size;
+    char *data = get_file_data( file, &size ), *end = data + size, *pos = data;
 
+    /* only directives are of interest, so don't bother copying the other lines */
     input_line = 0;
-    while ((buffer = get_line( file )))
+    while (pos < end)
     {
-        parse_cpp_directive( source, buffer );
+        if (*skip_spaces( pos ) == '#') parse_cpp_directive( source, get_data_line( &pos, end ));
+        else skip_data_line( &pos, end );
     }
+    free( data );
 }
 
 
@@ -1256,24 +1385,101 @@ static const struct
     { ".sfd", parse_sfd_file }
 };
 
+/*******************************************************************
+ *         add_cached_file
+ */
+static struct cached_file *add_cached_file( const char *name, long long mtime, long long size,
+                                            unsigned int flags )
+{
+    struct cached_file *cached = xmalloc( sizeof(*cached) );
+
+    memset( cached, 0, sizeof(*cached) );
+    cached->name = xstrdup( name );
+    cached->mtime = mtime;
+    cached->size = size;
+    cached->flags = flags;
+    list_add_tail( &cached_files[hash_filename( name )], &cached->entry );
+    return cached;
+}
+
+
+/*******************************************************************
+ *         add_cached_dependency
+ */
+static void add_cached_dependency( struct cached_file *cached, int line, enum incl_type type,
+                                   const char *name )
+{
+    if (cached->deps_count >= cached->deps_size)
+    {
+        cached->deps_size *= 2;
+        if (cached->deps_size < 16) cached->deps_size = 16;
+        cached->deps = xrealloc( cached->deps, cached->deps_size * sizeof(*cached->deps) );
+    }
+    cached->deps[cached->deps_count].line = line;
+    cached->deps[cached->deps_count].type = type;
+    cached->deps[cached->deps_count].name = xstrdup( name );
+    cached->deps_count++;
+}
+
+
+/*******************************************************************
+ *         load_cached_file
+ *
+ * Create a file from the dependency cache if it hasn't changed since it was parsed.
+ */
+static struct file *load_cached_file( const char *name, const struct stat *st )
+{
+    struct cached_file *cached;
+    struct file *file;
+
+    LIST_FOR_EACH_ENTRY( cached, &cached_files[hash_filename( name )], struct cached_file, entry )
+    {
+        if (strcmp( name, cached->name )) continue;
+        if (cached->mtime != st->st_mtime || cached->size != st->st_size) return NULL;
+
+        /* dependencies are shared, they are never modified once parsed */
+        file = add_file( name );
+        file->flags = cached->flags;
+        file->deps = cached->deps;
+        file->deps_count = file->deps_size = cached->deps_count;
+        cached->used = 1;
+        cache_hits++;
+        return file;
+    }
+    return NULL;
+}
+
+
 /*******************************************************************
  *         load_file
  */
 static struct file *load_file( const char *name )
 {
+    struct cached_file *cached;
     struct file *file;
+    struct stat st;
+    clock_t start = 0;
+    int cacheable;
     FILE *f;
     unsigned int i, hash = hash_filename( name );
 
     LIST_FOR_EACH_ENTRY( file, &files[hash], struct file, entry )
         if (!strcmp( name, file->name )) return file;
 
+    cacheable = !stat( name, &st ) && S_ISREG( st.st_mode );
+    if (cacheable && (file = load_cached_file( name, &st )))
+    {
+        list_add_tail( &files[hash], &file->entry );
+        return file;
+    }
+
     if (!(f = fopen( name, "r" ))) return NULL;
 
     file = add_file( name );
     list_add_tail( &files[hash], &file->entry );
     input_file_name = file->name;
     input_line = 0;
+    if (timing_mode) start = clock();
 
     for (i = 0; i < ARRAY_SIZE(parse_functions); i++)
     {
@@ -1284,11 +1490,90 @@ static struct file *load_file( const char *name )
 
     fclose( f );
     input_file_name = NULL;
+    files_parsed++;
+    if (timing_mode) parse_time += clock() - start;
 
+    /* files with custom arguments are rare, they are simply parsed every time */
+    if (cacheable && !file->args)
+    {
+        cached = add_cached_file( name, st.st_mtime, st.st_size, file->flags );
+        cached->deps = file->deps;
+        cached->deps_count = cached->deps_size = file->deps_count;
+        cached->used = 1;
+        cache_misses++;
+    }
     return file;
 }
 
 
+/*******************************************************************
+ *         load_dependency_cache
+ */
+static void load_dependency_cache(void)
+{
+    struct cached_file *cached = NULL;
+    char *data, *end, *pos, *eol, *p;
+    unsigned int i, flags;
+    long long mtime, size;
+    int line, type;
+    size_t len;
+    FILE *f;
+
+    if (!(f = fopen( cache_file_name, "r" ))) return;
+    data = get_file_data( f, &len );
+    fclose( f );
+
+    end = data + len;
+    if (!(eol = memchr( data, '\n', len ))) return;
+    *eol = 0;
+    if (strcmp( data, cache_signature )) return;  /* makedep has changed */
+
+    for (pos = eol + 1; pos < end; pos = eol + 1)
+    {
+        if (!(eol = memchr( pos, '\n', end - pos ))) goto error;
+        *eol = 0;
+        if (!strncmp( pos, "F ", 2 ))
+        {
+            mtime = strtoll( pos + 2, &p, 10 );
+            size = strtoll( p, &p, 10 );
+            flags = strtoul( p, &p, 10 );
+            if (*p++ != ' ' || !*p) goto error;
+            cached = add_cached_file( p, mtime, size, flags );
+            cache_entries++;
+        }
+        else if (!strncmp( pos, "D ", 2 ) && cached)
+        {
+            line = strtol( pos + 2, &p, 10 );
+            type = strtol( p, &p, 10 );
+            if (*p++ != ' ' || !*p || type < INCL_NORMAL || type > INCL_CPP_QUOTE_SYSTEM) goto error;
+            add_cached_dependency( cached, line, type, p );
+        }
+        else goto error;
+    }
+    return;
+
+error:
+    fprintf( stderr, "makedep: warning: ignoring invalid dependency cache\n" );
+    for (i = 0; i < HASH_SIZE; i++) list_init( &cached_files[i] );
+    cache_entries = 0;
+}
+
+
+/*******************************************************************
+ *         report_time
+ */
+static void report_time( const char *phase )
+{
+    static clock_t last;
+    clock_t now;
+
+    if (!timing_mode) return;
+    now = clock();
+    fprintf( stderr, "makedep: %-20s %8.3fs\n", phase, (double)(now - last) / CLOCKS_PER_SEC );
+    last = now;
+}
+
+
 /*******************************************************************
  *         open_include_path_file
  *
@@ -1676,12 +1961,7 @@ static struct incl_file *add_src_file( struct makefile *make, const char *name )
     file->name = xstrdup(name);
     file->use_msvcrt = is_using_msvcrt( make );
     file->is_external = !!make->extlib;
-    list_add_tail( &make->sources, &file->entry );
-    if (make == include_makefile)
-    {
-        unsigned int hash = hash_filename( name );
-        list_add_tail( &global_includes[hash], &file->hash_entry );
-    }
+    add_source_to_list( make, file );
     parse_file( make, file, 1 );
     return file;
 }
@@ -4230,6 +4510,35 @@ static void output_testlist( const struct makefile *make )
 }
 
 
+/*******************************************************************
+ *         output_dependency_cache
+ */
+static void output_dependency_cache(void)
+{
+    struct cached_file *cached;
+    unsigned int i, j;
+
+    if (!cache_misses && cache_hits == cache_entries) return;  /* nothing changed */
+
+    output_file = create_temp_file( cache_file_name );
+    output( "%s\n", cache_signature );
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        LIST_FOR_EACH_ENTRY( cached, &cached_files[i], struct cached_file, entry )
+        {
+            /* a recent file could be modified again without changing its time stamp */
+            if (!cached->used || cached->mtime >= start_time - 1) continue;
+            output( "F %lld %lld %u %s\n", cached->mtime, cached->size, cached->flags, cached->name );
+            for (j = 0; j < cached->deps_count; j++)
+                output( "D %d %d %s\n", cached->deps[j].line, cached->deps[j].type, cached->deps[j].name );
+        }
+    }
+    if (fclose( output_file )) fatal_perror( "write" );
+    output_file = NULL;
+    rename_temp_file( cache_file_name );
+}
+
+
 /*******************************************************************
  *         output_gitignore
  */
@@ -4407,6 +4716,7 @@ static void output_top_makefile( struct makefile *make )
     else strarray_add( &make->clean_files, "loader-wow64" );
 
     if (compile_commands_mode) strarray_add( &make->distclean_files, "compile_commands.json" );
+    strarray_add( &make->distclean_files, cache_file_name );
     strarray_addall( &make->distclean_files, get_expanded_make_var_array( make, "CONFIGURE_TARGETS" ));
     if (!make->src_dir)
     {
@@ -4538,6 +4848,8 @@ static void load_sources( struct makefile *make )
 
     list_init( &make->sources );
     list_init( &make->includes );
+    for (i = 0; i < MAKE_HASH_SIZE; i++) list_init( &make->sources_hash[i] );
+    for (i = 0; i < MAKE_HASH_SIZE; i++) list_init( &make->includes_hash[i] );
 
     value = get_expanded_make_var_array( make, "SOURCES" );
     for (i = 0; i < value.count; i++) add_src_file( make, value.str[i] );
@@ -4596,6 +4908,9 @@ static int parse_option( const char *opt )
     case 'S':
         silent_rules = 1;
         break;
+    case 't':
+        timing_mode = 1;
+        break;
     default:
         fprintf( stderr, "Unknown option '%s'\n%s", opt, Usage );
         exit(1);
@@ -4623,6 +4938,7 @@ int main( int argc, char *argv[] )
     const char *makeflags = getenv( "MAKEFLAGS" );
     const char *target;
     unsigned int i, j, arch, ec_arch;
+    struct stat st;
 
     if (makeflags) parse_makeflags( makeflags );
 
@@ -4646,9 +4962,11 @@ int main( int argc, char *argv[] )
     atexit( cleanup_files );
     init_signals( exit_on_signal );
     getcwd( cwd, sizeof(cwd) );
+    start_time = time( NULL );
 
     for (i = 0; i < HASH_SIZE; i++) list_init( &files[i] );
     for (i = 0; i < HASH_SIZE; i++) list_init( &global_includes[i] );
+    for (i = 0; i < HASH_SIZE; i++) list_init( &cached_files[i] );
 
     top_makefile = parse_makefile( NULL );
 
@@ -4740,16 +5058,31 @@ int main( int argc, char *argv[] )
     submakes = xmalloc( subdirs.count * sizeof(*submakes) );
 
     for (i = 0; i < subdirs.count; i++) submakes[i] = parse_makefile( subdirs.str[i] );
+    report_time( "parsing makefiles" );
+
+    /* the cache is only valid for the makedep that created it */
+    if (stat( root_src_dir_path( "tools/makedep.c" ), &st )) memset( &st, 0, sizeof(st) );
+    cache_signature = strmake( "makedep cache 1 %lld %lld", (long long)st.st_mtime, (long long)st.st_size );
+    load_dependency_cache();
+    report_time( "loading cache" );
 
     load_sources( top_makefile );
     load_sources( include_makefile );
     for (i = 0; i < subdirs.count; i++)
         if (submakes[i] != include_makefile) load_sources( submakes[i] );
+    report_time( "loading sources" );
+    if (timing_mode)
+        fprintf( stderr, "makedep: %u files parsed in %.3fs, %u loaded from cache\n",
+                 files_parsed, (double)parse_time / CLOCKS_PER_SEC, cache_hits );
 
     output_dependencies( top_makefile );
     for (i = 0; i < subdirs.count; i++) output_dependencies( submakes[i] );
 
     if (compile_commands_mode) output_compile_commands( "compile_commands.json" );
+    report_time( "writing makefiles" );
+
+    output_dependency_cache();
+    report_time( "writing cache" );
 
     return 0;
 }